@@ -23,15 +23,40 @@ private:
   // UI elements
   lv_obj_t *title_label;
   lv_obj_t *source_dropdown;
+  lv_obj_t *backup_source_dropdown;
+  lv_obj_t *stale_input;
+  lv_obj_t *redraw_input;
   lv_obj_t *units_dropdown;
   lv_obj_t *wifi_ssid_input;
   lv_obj_t *wifi_pass_input;
   lv_obj_t *signalk_host_input;
   lv_obj_t *signalk_port_input;
+  lv_obj_t *backup_host_input;
+  lv_obj_t *backup_port_input;
+  lv_obj_t *sk_path_dropdown;
+  lv_obj_t *sk_policy_dropdown;
+  lv_obj_t *sk_min_period_input;
+  lv_obj_t *sk_period_input;
+  lv_obj_t *nmea_talkers_input;
+  lv_obj_t *nmea_echo_input;
+  lv_obj_t *nmea_out_dropdown;
+  lv_obj_t *nmea_tx_input;
+  lv_obj_t *nmea_rate_input;
+  lv_obj_t *nmea_sentence_checks[4];   // Bit i is NMEA_OUT_* 1 << i
+  lv_obj_t *demo_rate_input;
+  lv_obj_t *demo_seed_input;
   lv_obj_t *save_btn;
   lv_obj_t *cancel_btn;
   lv_obj_t *keyboard;  // On-screen keyboard
   
+  // Subscription settings being edited. The path dropdown lists each
+  // distinct Signal K path once; sk_path_index maps it to the first
+  // SIGNALK_DEFAULT_PATHS entry with that path.
+  SignalKSubscription edit_subs[SIGNALK_DEFAULT_PATH_COUNT];
+  uint8_t sk_path_index[SIGNALK_DEFAULT_PATH_COUNT];
+  uint8_t sk_path_count;
+  uint16_t sk_path_selected;
+  
   static void textarea_focused(lv_event_t *e) {
     ConfigScreen *self = (ConfigScreen*)lv_event_get_user_data(e);
     lv_obj_t *ta = (lv_obj_t*)lv_event_get_target(e);
@@ -49,6 +74,13 @@ private:
     }
   }
   
+  static void sk_path_changed(lv_event_t *e) {
+    ConfigScreen *self = (ConfigScreen*)lv_event_get_user_data(e);
+    self->storeSubscriptionFields();
+    self->sk_path_selected = lv_dropdown_get_selected(self->sk_path_dropdown);
+    self->loadSubscriptionFields();
+  }
+  
   static void save_clicked(lv_event_t *e) {
     ConfigScreen *self = (ConfigScreen*)lv_event_get_user_data(e);
     self->saveAndClose();
@@ -59,12 +91,53 @@ private:
     self->hide();
   }
   
+  void loadSubscriptionFields() {
+    const SignalKSubscription &sub = edit_subs[sk_path_index[sk_path_selected]];
+    lv_dropdown_set_selected(sk_policy_dropdown, sub.policy);
+    
+    char buf[8];
+    snprintf(buf, sizeof(buf), "%u", sub.minPeriod);
+    lv_textarea_set_text(sk_min_period_input, buf);
+    snprintf(buf, sizeof(buf), "%u", sub.period);
+    lv_textarea_set_text(sk_period_input, buf);
+  }
+  
+  // Fields take 5 digits; clamp before narrowing to 16 bits
+  void storeSubscriptionFields() {
+    SignalKSubscription &sub = edit_subs[sk_path_index[sk_path_selected]];
+    sub.policy = lv_dropdown_get_selected(sk_policy_dropdown);
+    long min_period = atol(lv_textarea_get_text(sk_min_period_input));
+    long period = atol(lv_textarea_get_text(sk_period_input));
+    if (period <= 0) period = 1000;
+    if (period > SK_PERIOD_MAX) period = SK_PERIOD_MAX;
+    if (min_period > SK_PERIOD_MAX) min_period = SK_PERIOD_MAX;
+    sub.period = period;
+    if (min_period > period) {
+      // Rejected: keep the previous minimum unless the new period rules it out too
+      if (sub.minPeriod > sub.period) sub.minPeriod = sub.period;
+    } else {
+      sub.minPeriod = min_period;
+    }
+  }
+  
   void saveAndClose() {
     // Get selected data source
     uint16_t source_idx = lv_dropdown_get_selected(source_dropdown);
     DataSourceType sources[] = {SOURCE_DEMO, SOURCE_WIFI_SIGNALK, SOURCE_NMEA};
     config->setDataSource(sources[source_idx]);
     
+    // Backup source and when to switch to it
+    uint16_t backup_idx = lv_dropdown_get_selected(backup_source_dropdown);
+    DataSourceType backups[] = {SOURCE_NONE, SOURCE_DEMO, SOURCE_WIFI_SIGNALK, SOURCE_NMEA};
+    config->setBackupSource(backups[backup_idx]);
+    long stale_ms = atol(lv_textarea_get_text(stale_input));
+    if (stale_ms > 65535) stale_ms = 65535;   // Field takes 5 digits, setting is 16-bit
+    config->setSourceStaleMs(stale_ms > 0 ? stale_ms : WIND_DEFAULT_STALE_MS);
+    
+    // Minimum time between redraws, 0 = every sample
+    long redraw_ms = atol(lv_textarea_get_text(redraw_input));
+    config->setDisplayCoalesceMs(redraw_ms < 0 ? 0 : redraw_ms > 1000 ? 1000 : redraw_ms);
+    
     // Get selected units
     uint16_t units_idx = lv_dropdown_get_selected(units_dropdown);
     config->setUnits((WindUnits)units_idx);
@@ -79,6 +152,40 @@ private:
     config->setSignalKHost(lv_textarea_get_text(signalk_host_input));
     const char *port_str = lv_textarea_get_text(signalk_port_input);
     config->setSignalKPort(atoi(port_str));
+    const char *backup_port_str = lv_textarea_get_text(backup_port_input);
+    config->setSignalKBackup(0, lv_textarea_get_text(backup_host_input),
+                             backup_port_str[0] ? atoi(backup_port_str) : 3000);
+    
+    // NMEA input talker filter and output; applied by the restart below
+    config->setNMEATalkerPriority(lv_textarea_get_text(nmea_talkers_input));
+    const char *echo_str = lv_textarea_get_text(nmea_echo_input);
+    if (echo_str[0]) config->setNMEAEchoMs(atoi(echo_str));
+    config->setNMEAOutputMode((NMEAOutputMode)lv_dropdown_get_selected(nmea_out_dropdown));
+    const char *tx_str = lv_textarea_get_text(nmea_tx_input);
+    if (tx_str[0]) config->setNMEATxPin(atoi(tx_str));
+    int rate = atoi(lv_textarea_get_text(nmea_rate_input));
+    config->setNMEAOutputRateHz(rate < 1 ? 1 : rate > NMEA_OUTPUT_MAX_RATE_HZ ? NMEA_OUTPUT_MAX_RATE_HZ : rate);
+    uint8_t sentences = 0;
+    for (uint8_t i = 0; i < 4; i++) {
+      if (lv_obj_has_state(nmea_sentence_checks[i], LV_STATE_CHECKED)) sentences |= 1 << i;
+    }
+    config->setNMEAOutputSentences(sentences);
+    
+    // Demo simulator; an empty field keeps the current value
+    const char *demo_rate_str = lv_textarea_get_text(demo_rate_input);
+    if (demo_rate_str[0]) config->setDemoRateHz(atoi(demo_rate_str));
+    const char *demo_seed_str = lv_textarea_get_text(demo_seed_input);
+    if (demo_seed_str[0]) config->setDemoSeed(strtoul(demo_seed_str, nullptr, 10));
+    
+    // Get subscription settings; entries sharing a path share settings
+    storeSubscriptionFields();
+    for (size_t i = 0; i < SIGNALK_DEFAULT_PATH_COUNT; i++) {
+      size_t first = i;
+      while (first > 0 && strcmp(SIGNALK_DEFAULT_PATHS[first - 1].path, SIGNALK_DEFAULT_PATHS[i].path) == 0) {
+        first--;
+      }
+      config->setSignalKSubscription(i, edit_subs[first]);
+    }
     
     hide();
     
@@ -92,7 +199,8 @@ private:
   
 public:
   ConfigScreen(lv_obj_t *main_scr, WindConfig *cfg, WindDataSourceManager *mgr, void (*restart)() = nullptr) 
-    : main_screen(main_scr), config(cfg), sourceManager(mgr), restartCallback(restart), isVisible(false), screen(nullptr), keyboard(nullptr) {}
+    : main_screen(main_scr), config(cfg), sourceManager(mgr), restartCallback(restart), isVisible(false), screen(nullptr), keyboard(nullptr),
+      sk_path_count(0), sk_path_selected(0) {}
   
   void create() {
     // Create config screen
@@ -126,26 +234,63 @@ public:
     lv_obj_set_width(source_dropdown, 200);
     lv_obj_set_pos(source_dropdown, 0, 25);
     
-    // Units dropdown
+    // Backup source dropdown and staleness budget
+    lv_obj_t *backup_source_label = lv_label_create(scroll_container);
+    lv_label_set_text(backup_source_label, "Backup:");
+    lv_obj_set_style_text_color(backup_source_label, lv_color_black(), 0);
+    lv_obj_set_pos(backup_source_label, 0, 65);
+    
+    backup_source_dropdown = lv_dropdown_create(scroll_container);
+    lv_dropdown_set_options(backup_source_dropdown, "None\nDemo\nWiFi/Signal K\nNMEA 0183");
+    lv_obj_set_width(backup_source_dropdown, 120);
+    lv_obj_set_pos(backup_source_dropdown, 0, 90);
+    
+    lv_obj_t *stale_label = lv_label_create(scroll_container);
+    lv_label_set_text(stale_label, "Stale ms:");
+    lv_obj_set_style_text_color(stale_label, lv_color_black(), 0);
+    lv_obj_set_pos(stale_label, 130, 65);
+    
+    stale_input = lv_textarea_create(scroll_container);
+    lv_obj_set_size(stale_input, 70, 30);
+    lv_obj_set_pos(stale_input, 130, 90);
+    lv_textarea_set_one_line(stale_input, true);
+    lv_textarea_set_max_length(stale_input, 5);
+    lv_textarea_set_accepted_chars(stale_input, "0123456789");
+    lv_obj_add_event_cb(stale_input, textarea_focused, LV_EVENT_FOCUSED, this);
+    
+    // Units dropdown and redraw interval
     lv_obj_t *units_label = lv_label_create(scroll_container);
     lv_label_set_text(units_label, "Speed Units:");
     lv_obj_set_style_text_color(units_label, lv_color_black(), 0);
-    lv_obj_set_pos(units_label, 0, 65);
+    lv_obj_set_pos(units_label, 0, 130);
     
     units_dropdown = lv_dropdown_create(scroll_container);
     lv_dropdown_set_options(units_dropdown, "Knots\nm/s\nMPH\nkm/h");
-    lv_obj_set_width(units_dropdown, 200);
-    lv_obj_set_pos(units_dropdown, 0, 90);
+    lv_obj_set_width(units_dropdown, 120);
+    lv_obj_set_pos(units_dropdown, 0, 155);
+    
+    lv_obj_t *redraw_label = lv_label_create(scroll_container);
+    lv_label_set_text(redraw_label, "Redraw ms:");
+    lv_obj_set_style_text_color(redraw_label, lv_color_black(), 0);
+    lv_obj_set_pos(redraw_label, 130, 130);
+    
+    redraw_input = lv_textarea_create(scroll_container);
+    lv_obj_set_size(redraw_input, 70, 30);
+    lv_obj_set_pos(redraw_input, 130, 155);
+    lv_textarea_set_one_line(redraw_input, true);
+    lv_textarea_set_max_length(redraw_input, 4);
+    lv_textarea_set_accepted_chars(redraw_input, "0123456789");
+    lv_obj_add_event_cb(redraw_input, textarea_focused, LV_EVENT_FOCUSED, this);
     
     // WiFi SSID
     lv_obj_t *ssid_label = lv_label_create(scroll_container);
     lv_label_set_text(ssid_label, "WiFi SSID:");
     lv_obj_set_style_text_color(ssid_label, lv_color_black(), 0);
-    lv_obj_set_pos(ssid_label, 0, 130);
+    lv_obj_set_pos(ssid_label, 0, 195);
     
     wifi_ssid_input = lv_textarea_create(scroll_container);
     lv_obj_set_size(wifi_ssid_input, 200, 30);
-    lv_obj_set_pos(wifi_ssid_input, 0, 150);
+    lv_obj_set_pos(wifi_ssid_input, 0, 215);
     lv_textarea_set_one_line(wifi_ssid_input, true);
     lv_textarea_set_max_length(wifi_ssid_input, 31);
     lv_textarea_set_placeholder_text(wifi_ssid_input, "WiFi Network");
@@ -155,11 +300,11 @@ public:
     lv_obj_t *pass_label = lv_label_create(scroll_container);
     lv_label_set_text(pass_label, "WiFi Password:");
     lv_obj_set_style_text_color(pass_label, lv_color_black(), 0);
-    lv_obj_set_pos(pass_label, 0, 185);
+    lv_obj_set_pos(pass_label, 0, 250);
     
     wifi_pass_input = lv_textarea_create(scroll_container);
     lv_obj_set_size(wifi_pass_input, 200, 30);
-    lv_obj_set_pos(wifi_pass_input, 0, 205);
+    lv_obj_set_pos(wifi_pass_input, 0, 270);
     lv_textarea_set_one_line(wifi_pass_input, true);
     lv_textarea_set_max_length(wifi_pass_input, 63);
     lv_textarea_set_placeholder_text(wifi_pass_input, "Password");
@@ -170,11 +315,11 @@ public:
     lv_obj_t *host_label = lv_label_create(scroll_container);
     lv_label_set_text(host_label, "Signal K Host:");
     lv_obj_set_style_text_color(host_label, lv_color_black(), 0);
-    lv_obj_set_pos(host_label, 0, 240);
+    lv_obj_set_pos(host_label, 0, 305);
     
     signalk_host_input = lv_textarea_create(scroll_container);
     lv_obj_set_size(signalk_host_input, 200, 30);
-    lv_obj_set_pos(signalk_host_input, 0, 260);
+    lv_obj_set_pos(signalk_host_input, 0, 325);
     lv_textarea_set_one_line(signalk_host_input, true);
     lv_textarea_set_placeholder_text(signalk_host_input, "192.168.1.100");
     lv_obj_add_event_cb(signalk_host_input, textarea_focused, LV_EVENT_FOCUSED, this);
@@ -183,16 +328,198 @@ public:
     lv_obj_t *port_label = lv_label_create(scroll_container);
     lv_label_set_text(port_label, "Port:");
     lv_obj_set_style_text_color(port_label, lv_color_black(), 0);
-    lv_obj_set_pos(port_label, 0, 295);
+    lv_obj_set_pos(port_label, 0, 360);
     
     signalk_port_input = lv_textarea_create(scroll_container);
     lv_obj_set_size(signalk_port_input, 80, 30);
-    lv_obj_set_pos(signalk_port_input, 0, 315);
+    lv_obj_set_pos(signalk_port_input, 0, 380);
     lv_textarea_set_one_line(signalk_port_input, true);
     lv_textarea_set_max_length(signalk_port_input, 5);
     lv_textarea_set_placeholder_text(signalk_port_input, "3000");
     lv_obj_add_event_cb(signalk_port_input, textarea_focused, LV_EVENT_FOCUSED, this);
     
+    // Backup Signal K server (kept connected, used when the primary stops)
+    lv_obj_t *backup_host_label = lv_label_create(scroll_container);
+    lv_label_set_text(backup_host_label, "Backup Host:");
+    lv_obj_set_style_text_color(backup_host_label, lv_color_black(), 0);
+    lv_obj_set_pos(backup_host_label, 0, 420);
+    
+    backup_host_input = lv_textarea_create(scroll_container);
+    lv_obj_set_size(backup_host_input, 200, 30);
+    lv_obj_set_pos(backup_host_input, 0, 440);
+    lv_textarea_set_one_line(backup_host_input, true);
+    lv_textarea_set_placeholder_text(backup_host_input, "none");
+    lv_obj_add_event_cb(backup_host_input, textarea_focused, LV_EVENT_FOCUSED, this);
+    
+    lv_obj_t *backup_port_label = lv_label_create(scroll_container);
+    lv_label_set_text(backup_port_label, "Backup Port:");
+    lv_obj_set_style_text_color(backup_port_label, lv_color_black(), 0);
+    lv_obj_set_pos(backup_port_label, 0, 475);
+    
+    backup_port_input = lv_textarea_create(scroll_container);
+    lv_obj_set_size(backup_port_input, 80, 30);
+    lv_obj_set_pos(backup_port_input, 0, 495);
+    lv_textarea_set_one_line(backup_port_input, true);
+    lv_textarea_set_max_length(backup_port_input, 5);
+    lv_textarea_set_placeholder_text(backup_port_input, "3000");
+    lv_obj_add_event_cb(backup_port_input, textarea_focused, LV_EVENT_FOCUSED, this);
+    
+    // Signal K subscription policy, edited one path at a time
+    lv_obj_t *sk_path_label = lv_label_create(scroll_container);
+    lv_label_set_text(sk_path_label, "Signal K Path:");
+    lv_obj_set_style_text_color(sk_path_label, lv_color_black(), 0);
+    lv_obj_set_pos(sk_path_label, 0, 535);
+    
+    static char path_options[SIGNALK_DEFAULT_PATH_COUNT * 20];
+    path_options[0] = '\0';
+    sk_path_count = 0;
+    for (size_t i = 0; i < SIGNALK_DEFAULT_PATH_COUNT; i++) {
+      if (i > 0 && strcmp(SIGNALK_DEFAULT_PATHS[i - 1].path, SIGNALK_DEFAULT_PATHS[i].path) == 0) continue;
+      if (sk_path_count > 0) strncat(path_options, "\n", sizeof(path_options) - strlen(path_options) - 1);
+      strncat(path_options, SIGNALK_DEFAULT_PATHS[i].label, sizeof(path_options) - strlen(path_options) - 1);
+      sk_path_index[sk_path_count++] = i;
+    }
+    
+    sk_path_dropdown = lv_dropdown_create(scroll_container);
+    lv_dropdown_set_options(sk_path_dropdown, path_options);
+    lv_obj_set_width(sk_path_dropdown, 200);
+    lv_obj_set_pos(sk_path_dropdown, 0, 555);
+    lv_obj_add_event_cb(sk_path_dropdown, sk_path_changed, LV_EVENT_VALUE_CHANGED, this);
+    
+    lv_obj_t *policy_label = lv_label_create(scroll_container);
+    lv_label_set_text(policy_label, "Policy:");
+    lv_obj_set_style_text_color(policy_label, lv_color_black(), 0);
+    lv_obj_set_pos(policy_label, 0, 595);
+    
+    sk_policy_dropdown = lv_dropdown_create(scroll_container);
+    lv_dropdown_set_options(sk_policy_dropdown, "Instant\nIdeal\nFixed");
+    lv_obj_set_width(sk_policy_dropdown, 200);
+    lv_obj_set_pos(sk_policy_dropdown, 0, 615);
+    
+    lv_obj_t *min_period_label = lv_label_create(scroll_container);
+    lv_label_set_text(min_period_label, "Min ms:");
+    lv_obj_set_style_text_color(min_period_label, lv_color_black(), 0);
+    lv_obj_set_pos(min_period_label, 0, 655);
+    
+    sk_min_period_input = lv_textarea_create(scroll_container);
+    lv_obj_set_size(sk_min_period_input, 80, 30);
+    lv_obj_set_pos(sk_min_period_input, 0, 675);
+    lv_textarea_set_one_line(sk_min_period_input, true);
+    lv_textarea_set_max_length(sk_min_period_input, 5);
+    lv_textarea_set_accepted_chars(sk_min_period_input, "0123456789");
+    lv_obj_add_event_cb(sk_min_period_input, textarea_focused, LV_EVENT_FOCUSED, this);
+    
+    lv_obj_t *period_label = lv_label_create(scroll_container);
+    lv_label_set_text(period_label, "Period ms:");
+    lv_obj_set_style_text_color(period_label, lv_color_black(), 0);
+    lv_obj_set_pos(period_label, 110, 655);
+    
+    sk_period_input = lv_textarea_create(scroll_container);
+    lv_obj_set_size(sk_period_input, 80, 30);
+    lv_obj_set_pos(sk_period_input, 110, 675);
+    lv_textarea_set_one_line(sk_period_input, true);
+    lv_textarea_set_max_length(sk_period_input, 5);
+    lv_textarea_set_accepted_chars(sk_period_input, "0123456789");
+    lv_obj_add_event_cb(sk_period_input, textarea_focused, LV_EVENT_FOCUSED, this);
+    
+    // NMEA 0183 talker priority (first wins) and echo window
+    lv_obj_t *nmea_talkers_label = lv_label_create(scroll_container);
+    lv_label_set_text(nmea_talkers_label, "NMEA Talkers:");
+    lv_obj_set_style_text_color(nmea_talkers_label, lv_color_black(), 0);
+    lv_obj_set_pos(nmea_talkers_label, 0, 715);
+    
+    nmea_talkers_input = lv_textarea_create(scroll_container);
+    lv_obj_set_size(nmea_talkers_input, 120, 30);
+    lv_obj_set_pos(nmea_talkers_input, 0, 735);
+    lv_textarea_set_one_line(nmea_talkers_input, true);
+    lv_textarea_set_max_length(nmea_talkers_input, 23);
+    lv_textarea_set_placeholder_text(nmea_talkers_input, "WI,II");
+    lv_obj_add_event_cb(nmea_talkers_input, textarea_focused, LV_EVENT_FOCUSED, this);
+    
+    lv_obj_t *nmea_echo_label = lv_label_create(scroll_container);
+    lv_label_set_text(nmea_echo_label, "Echo ms:");
+    lv_obj_set_style_text_color(nmea_echo_label, lv_color_black(), 0);
+    lv_obj_set_pos(nmea_echo_label, 130, 715);
+    
+    nmea_echo_input = lv_textarea_create(scroll_container);
+    lv_obj_set_size(nmea_echo_input, 70, 30);
+    lv_obj_set_pos(nmea_echo_input, 130, 735);
+    lv_textarea_set_one_line(nmea_echo_input, true);
+    lv_textarea_set_max_length(nmea_echo_input, 4);
+    lv_textarea_set_accepted_chars(nmea_echo_input, "0123456789");
+    lv_obj_add_event_cb(nmea_echo_input, textarea_focused, LV_EVENT_FOCUSED, this);
+    
+    // NMEA 0183 output on the UART TX pin
+    lv_obj_t *nmea_out_label = lv_label_create(scroll_container);
+    lv_label_set_text(nmea_out_label, "NMEA Out:");
+    lv_obj_set_style_text_color(nmea_out_label, lv_color_black(), 0);
+    lv_obj_set_pos(nmea_out_label, 0, 775);
+    
+    nmea_out_dropdown = lv_dropdown_create(scroll_container);
+    lv_dropdown_set_options(nmea_out_dropdown, "Off\nGenerate\nPassthrough");
+    lv_obj_set_width(nmea_out_dropdown, 120);
+    lv_obj_set_pos(nmea_out_dropdown, 0, 795);
+    
+    lv_obj_t *nmea_tx_label = lv_label_create(scroll_container);
+    lv_label_set_text(nmea_tx_label, "TX pin:");
+    lv_obj_set_style_text_color(nmea_tx_label, lv_color_black(), 0);
+    lv_obj_set_pos(nmea_tx_label, 130, 775);
+    
+    nmea_tx_input = lv_textarea_create(scroll_container);
+    lv_obj_set_size(nmea_tx_input, 70, 30);
+    lv_obj_set_pos(nmea_tx_input, 130, 795);
+    lv_textarea_set_one_line(nmea_tx_input, true);
+    lv_textarea_set_max_length(nmea_tx_input, 2);
+    lv_textarea_set_accepted_chars(nmea_tx_input, "0123456789");
+    lv_obj_add_event_cb(nmea_tx_input, textarea_focused, LV_EVENT_FOCUSED, this);
+    
+    lv_obj_t *nmea_rate_label = lv_label_create(scroll_container);
+    lv_label_set_text(nmea_rate_label, "Out Hz:");
+    lv_obj_set_style_text_color(nmea_rate_label, lv_color_black(), 0);
+    lv_obj_set_pos(nmea_rate_label, 0, 835);
+    
+    nmea_rate_input = lv_textarea_create(scroll_container);
+    lv_obj_set_size(nmea_rate_input, 70, 30);
+    lv_obj_set_pos(nmea_rate_input, 0, 855);
+    lv_textarea_set_one_line(nmea_rate_input, true);
+    lv_textarea_set_max_length(nmea_rate_input, 2);
+    lv_textarea_set_accepted_chars(nmea_rate_input, "0123456789");
+    lv_obj_add_event_cb(nmea_rate_input, textarea_focused, LV_EVENT_FOCUSED, this);
+    
+    static const char* const sentence_names[] = {"MWV R", "MWV T", "VWR", "MWD"};
+    for (uint8_t i = 0; i < 4; i++) {
+      nmea_sentence_checks[i] = lv_checkbox_create(scroll_container);
+      lv_checkbox_set_text(nmea_sentence_checks[i], sentence_names[i]);
+      lv_obj_set_pos(nmea_sentence_checks[i], 85 + (i / 2) * 70, 835 + (i % 2) * 25);
+    }
+    
+    // Demo simulator rate and seed
+    lv_obj_t *demo_rate_label = lv_label_create(scroll_container);
+    lv_label_set_text(demo_rate_label, "Demo Hz:");
+    lv_obj_set_style_text_color(demo_rate_label, lv_color_black(), 0);
+    lv_obj_set_pos(demo_rate_label, 0, 895);
+    
+    demo_rate_input = lv_textarea_create(scroll_container);
+    lv_obj_set_size(demo_rate_input, 70, 30);
+    lv_obj_set_pos(demo_rate_input, 0, 915);
+    lv_textarea_set_one_line(demo_rate_input, true);
+    lv_textarea_set_max_length(demo_rate_input, 2);
+    lv_textarea_set_accepted_chars(demo_rate_input, "0123456789");
+    lv_obj_add_event_cb(demo_rate_input, textarea_focused, LV_EVENT_FOCUSED, this);
+    
+    lv_obj_t *demo_seed_label = lv_label_create(scroll_container);
+    lv_label_set_text(demo_seed_label, "Demo seed:");
+    lv_obj_set_style_text_color(demo_seed_label, lv_color_black(), 0);
+    lv_obj_set_pos(demo_seed_label, 85, 895);
+    
+    demo_seed_input = lv_textarea_create(scroll_container);
+    lv_obj_set_size(demo_seed_input, 115, 30);
+    lv_obj_set_pos(demo_seed_input, 85, 915);
+    lv_textarea_set_one_line(demo_seed_input, true);
+    lv_textarea_set_max_length(demo_seed_input, 9);
+    lv_textarea_set_accepted_chars(demo_seed_input, "0123456789");
+    lv_obj_add_event_cb(demo_seed_input, textarea_focused, LV_EVENT_FOCUSED, this);
+    
     // Create keyboard (hidden by default)
     keyboard = lv_keyboard_create(screen);
     lv_obj_set_size(keyboard, 240, 120);
@@ -231,15 +558,52 @@ public:
     
     // Load current values
     lv_dropdown_set_selected(source_dropdown, config->getDataSource());
+    DataSourceType backup = config->getBackupSource();
+    lv_dropdown_set_selected(backup_source_dropdown, backup == SOURCE_NONE ? 0 : backup + 1);
     lv_dropdown_set_selected(units_dropdown, config->getUnits());
     lv_textarea_set_text(wifi_ssid_input, config->getWifiSSID());
     lv_textarea_set_text(wifi_pass_input, config->getWifiPassword());
     lv_textarea_set_text(signalk_host_input, config->getSignalKHost());
     
     char port_str[8];
+    snprintf(port_str, sizeof(port_str), "%u", config->getSourceStaleMs());
+    lv_textarea_set_text(stale_input, port_str);
+    snprintf(port_str, sizeof(port_str), "%u", config->getDisplayCoalesceMs());
+    lv_textarea_set_text(redraw_input, port_str);
     snprintf(port_str, sizeof(port_str), "%d", config->getSignalKPort());
     lv_textarea_set_text(signalk_port_input, port_str);
     
+    lv_textarea_set_text(backup_host_input, config->getSignalKHost(1));
+    snprintf(port_str, sizeof(port_str), "%d", config->getSignalKPort(1));
+    lv_textarea_set_text(backup_port_input, port_str);
+    
+    memcpy(edit_subs, config->getSignalKSubscriptions(), sizeof(edit_subs));
+    sk_path_selected = 0;
+    lv_dropdown_set_selected(sk_path_dropdown, 0);
+    loadSubscriptionFields();
+    
+    lv_textarea_set_text(nmea_talkers_input, config->getNMEATalkerPriority());
+    snprintf(port_str, sizeof(port_str), "%u", config->getNMEAEchoMs());
+    lv_textarea_set_text(nmea_echo_input, port_str);
+    lv_dropdown_set_selected(nmea_out_dropdown, config->getNMEAOutputMode());
+    snprintf(port_str, sizeof(port_str), "%u", config->getNMEATxPin());
+    lv_textarea_set_text(nmea_tx_input, port_str);
+    snprintf(port_str, sizeof(port_str), "%u", config->getNMEAOutputRateHz());
+    lv_textarea_set_text(nmea_rate_input, port_str);
+    for (uint8_t i = 0; i < 4; i++) {
+      if (config->getNMEAOutputSentences() & (1 << i)) {
+        lv_obj_add_state(nmea_sentence_checks[i], LV_STATE_CHECKED);
+      } else {
+        lv_obj_remove_state(nmea_sentence_checks[i], LV_STATE_CHECKED);
+      }
+    }
+    
+    snprintf(port_str, sizeof(port_str), "%u", config->getDemoRateHz());
+    lv_textarea_set_text(demo_rate_input, port_str);
+    char seed_str[12];
+    snprintf(seed_str, sizeof(seed_str), "%lu", (unsigned long)config->getDemoSeed());
+    lv_textarea_set_text(demo_seed_input, seed_str);
+    
     lv_screen_load(screen);
     isVisible = true;
   }
@@ -1,62 +1,81 @@
 /*
   DemoWindDataSource.h - Demo/simulation wind data source
-  
-  Generates simulated wind data for testing and demo purposes.
+
+  Publishes WindSimulator output (a boat beating to windward through
+  gusts, shifts and tacks) at the simulator's sample rate, up to 50 Hz.
+  Samples carry both apparent and true wind. The simulator steps in
+  fixed increments, so a given seed and rate always produce the same
+  samples in the same order; if update() is called late the missed
+  steps are published back to back (at most WIND_DEMO_MAX_CATCHUP).
 */
 
 #ifndef DEMO_WIND_DATA_SOURCE_H
 #define DEMO_WIND_DATA_SOURCE_H
 
 #include "WindDataSource.h"
+#include "WindSimulator.h"
+
+#define WIND_DEMO_MAX_CATCHUP 10   // Steps published per update() after a stall
 
-class DemoWindDataSource : public WindDataSource {
+class DemoWindDataSource final : public WindDataSource {
 private:
-  float wind_speed;      // m/s
-  float wind_angle;      // degrees
-  unsigned long last_update;
-  
+  WindSimulator simulator;
+  unsigned long next_step;   // millis() of the next step
+  unsigned long step_ms;
+
 public:
-  DemoWindDataSource() : wind_speed(6.43), wind_angle(45.0), last_update(0) {}
-  
+  DemoWindDataSource(const WindSimulatorConfig& config = WindSimulatorConfig())
+    : simulator(config), next_step(0), step_ms(1000 / simulator.getRateHz()) {}
+
   ~DemoWindDataSource() {}
-  
+
   bool begin() override {
-    Serial.println("[Demo] Started");
-    wind_speed = 6.43;  // ~12.5 knots
-    wind_angle = 45.0;
-    last_update = millis();
+    Serial.printf("[Demo] Started, %u Hz, seed %lu\n", simulator.getRateHz(),
+                  (unsigned long)simulator.getConfig().seed);
+    simulator.reset();
+    next_step = millis() + step_ms;
     return true;
   }
-  
+
   void update() override {
-    // Update every 200ms for smooth animation
-    if (millis() - last_update > 200) {
-      // Rotate angle
-      wind_angle = fmod(wind_angle + 1.0, 360.0);
-      
-      // Vary speed slightly (10-15 knots range)
-      wind_speed = 5.14 + (random(0, 50) / 100.0);
-      
-      last_update = millis();
+    unsigned long now = millis();
+    uint8_t published = 0;
+    while ((long)(now - next_step) >= 0) {
+      if (published == WIND_DEMO_MAX_CATCHUP) {
+        next_step = now + step_ms;  // Too far behind: drop the backlog
+        break;
+      }
+      simulator.step();
+      next_step += step_ms;
+      published++;
+
+      WindSample sample = simulator.sample();
+      sample.receivedMs = now;
+      publishSample(sample);
     }
   }
-  
+
   bool isConnected() override {
     return true;  // Demo is always "connected"
   }
-  
+
   float getWindSpeed() override {
-    return wind_speed;  // m/s
+    return simulator.getApparentSpeed();  // m/s
   }
-  
+
   float getWindAngle() override {
-    return wind_angle;  // degrees
+    return simulator.getApparentAngle();  // degrees
   }
-  
+
   const char* getSourceName() override {
     return "Demo";
   }
-  
+
+  // Model state (true wind, heading, boat speed) for tests and tools
+  const WindSimulator& getSimulator() {
+    return simulator;
+  }
+
   void stop() override {
     Serial.println("[Demo] Stopped");
   }
@@ -0,0 +1,60 @@
+/*
+  InstrumentState.h - Latest value and update time of each instrument quantity
+
+  Shared by data sources that receive more than apparent wind (Signal K
+  paths, NMEA sentences). Internal units: speeds in m/s, angles in degrees.
+*/
+
+#ifndef INSTRUMENT_STATE_H
+#define INSTRUMENT_STATE_H
+
+#include <stdint.h>
+
+enum InstrumentQuantity {
+  IQ_APPARENT_WIND_SPEED,   // m/s
+  IQ_APPARENT_WIND_ANGLE,   // degrees 0-360, relative to bow
+  IQ_TRUE_WIND_SPEED,       // m/s
+  IQ_TRUE_WIND_ANGLE,       // degrees 0-360, relative to bow
+  IQ_TRUE_WIND_DIRECTION,   // degrees 0-360, true
+  IQ_SPEED_THROUGH_WATER,   // m/s
+  IQ_HEADING_TRUE,          // degrees 0-360
+  IQ_HEADING_MAGNETIC,      // degrees 0-360
+  IQ_SPEED_OVER_GROUND,     // m/s
+  IQ_COURSE_OVER_GROUND,    // degrees 0-360, true
+  IQ_ROLL,                  // degrees -180..180
+  IQ_PITCH,                 // degrees -180..180
+  IQ_YAW,                   // degrees 0-360
+  IQ_COUNT
+};
+
+struct InstrumentState {
+  float value[IQ_COUNT];
+  uint32_t updatedMs[IQ_COUNT];   // millis() of last update
+  uint32_t validMask;             // Bit per quantity, set once received
+
+  InstrumentState() { clear(); }
+
+  void clear() {
+    for (int i = 0; i < IQ_COUNT; i++) {
+      value[i] = 0;
+      updatedMs[i] = 0;
+    }
+    validMask = 0;
+  }
+
+  void set(InstrumentQuantity q, float v, uint32_t now) {
+    value[q] = v;
+    updatedMs[q] = now;
+    validMask |= (1UL << q);
+  }
+
+  bool has(InstrumentQuantity q) const { return validMask & (1UL << q); }
+  float get(InstrumentQuantity q) const { return value[q]; }
+
+  // Milliseconds since the quantity was last updated (UINT32_MAX if never)
+  uint32_t age(InstrumentQuantity q, uint32_t now) const {
+    return has(q) ? now - updatedMs[q] : UINT32_MAX;
+  }
+};
+
+#endif // INSTRUMENT_STATE_H
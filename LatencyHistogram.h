@@ -0,0 +1,96 @@
+/*
+  LatencyHistogram.h - Fixed-size latency histogram
+
+  Power-of-two millisecond buckets (<1, 1-2, 2-4 ... 2048+ ms) plus
+  count/min/max/sum. Percentiles are reported as the upper edge of the
+  bucket they fall in. No allocation; safe to keep one per stage.
+*/
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <stdint.h>
+
+#define LATENCY_BUCKETS 13
+
+class LatencyHistogram {
+private:
+  uint32_t buckets[LATENCY_BUCKETS];
+  uint32_t count;
+  uint32_t sum;
+  uint32_t minimum;
+  uint32_t maximum;
+
+public:
+  LatencyHistogram() { reset(); }
+
+  void reset() {
+    for (int i = 0; i < LATENCY_BUCKETS; i++) buckets[i] = 0;
+    count = 0;
+    sum = 0;
+    minimum = UINT32_MAX;
+    maximum = 0;
+  }
+
+  static int bucketFor(uint32_t ms) {
+    int b = 0;
+    while (ms && b < LATENCY_BUCKETS - 1) {
+      ms >>= 1;
+      b++;
+    }
+    return b;
+  }
+
+  // Upper edge of a bucket in ms (last bucket is open ended)
+  static uint32_t bucketLimit(int b) {
+    return b == 0 ? 1 : (1UL << b);
+  }
+
+  void record(uint32_t ms) {
+    buckets[bucketFor(ms)]++;
+    count++;
+    sum += ms;
+    if (ms < minimum) minimum = ms;
+    if (ms > maximum) maximum = ms;
+  }
+
+  // Upper bound of the p-th percentile (0-100)
+  uint32_t percentile(uint8_t p) const {
+    if (!count) return 0;
+    uint32_t target = (uint32_t)(((uint64_t)count * p + 99) / 100);
+    uint32_t seen = 0;
+    for (int b = 0; b < LATENCY_BUCKETS; b++) {
+      seen += buckets[b];
+      if (seen >= target) {
+        uint32_t limit = bucketLimit(b);
+        return limit < maximum ? limit : maximum;
+      }
+    }
+    return maximum;
+  }
+
+  uint32_t getCount() const { return count; }
+  uint32_t getMin() const { return count ? minimum : 0; }
+  uint32_t getMax() const { return maximum; }
+  uint32_t getMean() const { return count ? sum / count : 0; }
+  uint32_t getBucket(int b) const { return buckets[b]; }
+
+  // Print one summary line and the non-empty buckets
+  template <class Output>
+  void print(Output& out, const char* name) const {
+    out.printf("  %-14s n=%lu min=%lu avg=%lu p50<=%lu p95<=%lu p99<=%lu max=%lu ms\n", name,
+               (unsigned long)count, (unsigned long)getMin(), (unsigned long)getMean(),
+               (unsigned long)percentile(50), (unsigned long)percentile(95),
+               (unsigned long)percentile(99), (unsigned long)maximum);
+    for (int b = 0; b < LATENCY_BUCKETS; b++) {
+      if (!buckets[b]) continue;
+      if (b == LATENCY_BUCKETS - 1) {
+        out.printf("    >=%5lu ms: %lu\n", (unsigned long)bucketLimit(b - 1), (unsigned long)buckets[b]);
+      } else {
+        out.printf("    <%6lu ms: %lu\n", (unsigned long)bucketLimit(b), (unsigned long)buckets[b]);
+      }
+    }
+  }
+};
+
+#endif // LATENCY_HISTOGRAM_H
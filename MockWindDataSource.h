@@ -14,13 +14,14 @@ private:
   float wind_speed;      // m/s
   float wind_angle;      // degrees
   bool connected;
+  bool fail_begin;
   
 public:
-  MockWindDataSource() : wind_speed(0.0), wind_angle(0.0), connected(false) {}
+  MockWindDataSource() : wind_speed(0.0), wind_angle(0.0), connected(false), fail_begin(false) {}
   
   bool begin() override {
-    connected = true;
-    return true;
+    connected = !fail_begin;
+    return connected;
   }
   
   void update() override {
@@ -56,6 +57,29 @@ public:
     wind_angle = angle_deg;
   }
   
+  // Publish the current values as one sample
+  void publish(int64_t source_time = 0) {
+    WindSample sample = {};
+    sample.speed = wind_speed;
+    sample.angle = wind_angle;
+    sample.sourceTime = source_time;
+    sample.receivedMs = millis();
+    sample.valid = WIND_SAMPLE_SPEED_VALID | WIND_SAMPLE_ANGLE_VALID;
+    publishSample(sample);
+  }
+  
+  // Publish a sample with neither value valid (e.g. still connecting)
+  void publishEmpty() {
+    WindSample sample = {};
+    sample.receivedMs = millis();
+    publishSample(sample);
+  }
+  
+  // Make the next begin() fail
+  void setFailBegin(bool fail) {
+    fail_begin = fail;
+  }
+  
   void setConnected(bool state) {
     connected = state;
   }
@@ -0,0 +1,297 @@
+/*
+  NMEA0183Output.h - Repeat wind data as NMEA 0183 on the UART TX pin
+
+  Lets the display feed an autopilot or plotter that only takes NMEA
+  0183, whatever the source (Signal K, NMEA, demo). Two modes:
+
+    generate     update() writes the selected sentences from the latest
+                 wind sample at a fixed rate (NMEA_OUT_* bits):
+                   MWV R   $WIMWV,045.0,R,12.3,N,A  apparent wind
+                   MWV T   $WIMWV,060.0,T,10.1,N,A  true wind, if the sample has it
+                   VWR     $WIVWR,045.0,R,12.3,N,6.3,M,22.8,K
+                   MWD     $WIMWD,210.0,T,,M,10.1,N,5.2,M  needs a true
+                           wind direction (setTrueDirection)
+                 Nothing is sent once the sample is older than
+                 NMEA_OUTPUT_STALE_MS, so a lost source is not repeated
+                 as live wind.
+    passthrough  Sentences received by the NMEA source (after the talker
+                 filter) are repeated unchanged as they arrive, for the
+                 lowest latency. Runs wherever the source's update() runs.
+                 update() still writes what the UART could not take yet,
+                 so the last sentence of a burst does not wait for the
+                 next one; call it with the sources locked if they run
+                 in their own task. onSample() does nothing in this mode.
+
+  Sentences are formatted with integer arithmetic into a fixed buffer
+  and written no faster than the UART takes them (availableForWrite()),
+  so the caller never blocks. A sentence that does not fit in the buffer
+  is dropped whole and counted. The output must be a Print that reports
+  availableForWrite(), e.g. HardwareSerial with a TX buffer.
+*/
+
+#ifndef NMEA0183_OUTPUT_H
+#define NMEA0183_OUTPUT_H
+
+#include <stdint.h>
+#include <string.h>
+#include "WindSample.h"
+#include "NMEA0183Parser.h"
+
+#define NMEA_OUTPUT_BUFFER       256    // Pending bytes; all four sentences take under 200
+#define NMEA_OUTPUT_STALE_MS     2000   // Stop sending once the data is older than this
+#define NMEA_OUTPUT_MAX_RATE_HZ  10     // All four sentences at 3 Hz already fill 4800 baud
+#define NMEA_OUTPUT_TALKER       "WI"
+
+#define NMEA_OUT_MWV_R  0x01
+#define NMEA_OUT_MWV_T  0x02
+#define NMEA_OUT_VWR    0x04
+#define NMEA_OUT_MWD    0x08
+
+enum NMEAOutputMode {
+  NMEA_OUTPUT_OFF,
+  NMEA_OUTPUT_GENERATE,
+  NMEA_OUTPUT_PASSTHROUGH
+};
+
+class NMEA0183Output {
+private:
+  Print* out;
+  NMEAOutputMode mode;
+  uint8_t sentences_mask;
+  uint32_t interval_ms;
+  uint32_t last_sent;
+
+  WindSample sample;
+  float true_direction;
+  uint32_t true_direction_ms;
+  bool has_true_direction;
+
+  uint8_t tx[NMEA_OUTPUT_BUFFER];
+  uint16_t tx_head;
+  uint16_t tx_tail;
+
+  uint32_t generated;
+  uint32_t repeated;
+  uint32_t bytes;
+  uint32_t dropped;
+
+  // Append value/10 as digits, at least int_digits before the point
+  static char* appendTenths(char* p, int32_t tenths, uint8_t int_digits) {
+    if (tenths < 0) tenths = 0;
+    char digits[10];
+    uint8_t n = 0;
+    int32_t whole = tenths / 10;
+    do {
+      digits[n++] = '0' + whole % 10;
+      whole /= 10;
+    } while (whole && n < sizeof(digits));
+    while (n < int_digits) digits[n++] = '0';
+    while (n) *p++ = digits[--n];
+    *p++ = '.';
+    *p++ = '0' + tenths % 10;
+    return p;
+  }
+
+  static char* appendText(char* p, const char* text) {
+    while (*text) *p++ = *text++;
+    return p;
+  }
+
+  // Degrees to tenths in 0..3599
+  static int32_t angleTenths(float degrees) {
+    int32_t tenths = (int32_t)(degrees * 10.0f + (degrees < 0 ? -0.5f : 0.5f)) % 3600;
+    return tenths < 0 ? tenths + 3600 : tenths;
+  }
+
+  static int32_t speedTenths(float ms, float factor) {
+    return (int32_t)(ms * factor * 10.0f + 0.5f);
+  }
+
+  static char* appendSpeed(char* p, float ms) {
+    p = appendTenths(p, speedTenths(ms, 1.943844f), 1);
+    return appendText(p, ",N");
+  }
+
+  // Finish a sentence started with '$' at line: checksum and <CR><LF>
+  void finish(char* line, char* p) {
+    static const char hex[] = "0123456789ABCDEF";
+    uint8_t sum = 0;
+    for (const char* c = line + 1; c < p; c++) sum ^= (uint8_t)*c;
+    *p++ = '*';
+    *p++ = hex[sum >> 4];
+    *p++ = hex[sum & 0x0F];
+    *p++ = '\r';
+    *p++ = '\n';
+    uint8_t* slot = reserve(p - line);
+    if (!slot) return;
+    memcpy(slot, line, p - line);
+    generated++;
+  }
+
+  char* start(char* line, const char* type) {
+    char* p = line;
+    *p++ = '$';
+    p = appendText(p, NMEA_OUTPUT_TALKER);
+    p = appendText(p, type);
+    *p++ = ',';
+    return p;
+  }
+
+  void sendMWV(float angle, float speed, char reference) {
+    char line[NMEA_MAX_SENTENCE + 1];
+    char* p = start(line, "MWV");
+    p = appendTenths(p, angleTenths(angle), 3);
+    *p++ = ',';
+    *p++ = reference;
+    *p++ = ',';
+    p = appendSpeed(p, speed);
+    p = appendText(p, ",A");
+    finish(line, p);
+  }
+
+  void sendVWR() {
+    char line[NMEA_MAX_SENTENCE + 1];
+    char* p = start(line, "VWR");
+    int32_t angle = angleTenths(sample.angle);
+    bool port_side = angle > 1800;
+    p = appendTenths(p, port_side ? 3600 - angle : angle, 3);
+    p = appendText(p, port_side ? ",L," : ",R,");
+    p = appendSpeed(p, sample.speed);
+    *p++ = ',';
+    p = appendTenths(p, speedTenths(sample.speed, 1.0f), 1);
+    p = appendText(p, ",M,");
+    p = appendTenths(p, speedTenths(sample.speed, 3.6f), 1);
+    p = appendText(p, ",K");
+    finish(line, p);
+  }
+
+  void sendMWD() {
+    char line[NMEA_MAX_SENTENCE + 1];
+    char* p = start(line, "MWD");
+    p = appendTenths(p, angleTenths(true_direction), 3);
+    p = appendText(p, ",T,,M,");
+    p = appendSpeed(p, sample.trueSpeed);
+    *p++ = ',';
+    p = appendTenths(p, speedTenths(sample.trueSpeed, 1.0f), 1);
+    p = appendText(p, ",M");
+    finish(line, p);
+  }
+
+  // Room for length more bytes, nullptr (and counted) if there is none
+  uint8_t* reserve(size_t length) {
+    if (tx_tail + length > sizeof(tx) && tx_head > 0) {
+      memmove(tx, tx + tx_head, tx_tail - tx_head);
+      tx_tail -= tx_head;
+      tx_head = 0;
+    }
+    if (tx_tail + length > sizeof(tx)) {
+      dropped++;
+      return nullptr;
+    }
+    uint8_t* slot = tx + tx_tail;
+    tx_tail += length;
+    return slot;
+  }
+
+  // Write what the UART takes without blocking
+  void flush() {
+    if (!out || tx_head == tx_tail) return;
+    int room = out->availableForWrite();
+    if (room <= 0) return;
+    size_t n = tx_tail - tx_head;
+    if (n > (size_t)room) n = room;
+    n = out->write(tx + tx_head, n);
+    tx_head += n;
+    bytes += n;
+    if (tx_head == tx_tail) tx_head = tx_tail = 0;
+  }
+
+public:
+  NMEA0183Output()
+    : out(nullptr), mode(NMEA_OUTPUT_OFF), sentences_mask(NMEA_OUT_MWV_R | NMEA_OUT_MWV_T),
+      interval_ms(500), last_sent(0), true_direction(0), true_direction_ms(0),
+      has_true_direction(false), tx_head(0), tx_tail(0) {
+    resetCounters();
+  }
+
+  // Changing the mode or output drops anything not yet written
+  void begin(Print* output, NMEAOutputMode output_mode) {
+    out = output;
+    mode = output ? output_mode : NMEA_OUTPUT_OFF;
+    tx_head = tx_tail = 0;
+    sample = WindSample();
+    has_true_direction = false;
+  }
+
+  void setSentences(uint8_t mask) { sentences_mask = mask; }
+  void setRate(uint8_t hz) { interval_ms = hz ? 1000 / hz : 1000; }
+
+  NMEAOutputMode getMode() { return mode; }
+
+  // Latest wind; sent by the next update() that is due
+  void onSample(const WindSample& s) {
+    if (mode != NMEA_OUTPUT_GENERATE) return;
+    sample = s;
+  }
+
+  // True wind direction for MWD, when some source knows it
+  void setTrueDirection(float degrees, uint32_t updated_ms) {
+    true_direction = degrees;
+    true_direction_ms = updated_ms;
+    has_true_direction = true;
+  }
+
+  // Generate due sentences and write pending bytes; call from the loop
+  void update(uint32_t now) {
+    if (mode == NMEA_OUTPUT_GENERATE && now - last_sent >= interval_ms) {
+      last_sent = now;
+      if (sample.valid && now - sample.receivedMs < NMEA_OUTPUT_STALE_MS) {
+        bool apparent = sample.hasSpeed() && sample.hasAngle();
+        if ((sentences_mask & NMEA_OUT_MWV_R) && apparent) sendMWV(sample.angle, sample.speed, 'R');
+        if ((sentences_mask & NMEA_OUT_MWV_T) && sample.hasTrue()) {
+          sendMWV(sample.trueAngle, sample.trueSpeed, 'T');
+        }
+        if ((sentences_mask & NMEA_OUT_VWR) && apparent) sendVWR();
+        if ((sentences_mask & NMEA_OUT_MWD) && sample.hasTrue() && has_true_direction &&
+            now - true_direction_ms < NMEA_OUTPUT_STALE_MS) {
+          sendMWD();
+        }
+      }
+    }
+    flush();
+  }
+
+  // Repeat a received sentence as is; matches NMEASentenceHandler
+  static void passthrough(void* context, const NMEASentence& s) {
+    NMEA0183Output* self = (NMEA0183Output*)context;
+    if (self->mode != NMEA_OUTPUT_PASSTHROUGH) return;
+    self->flush();
+    uint8_t* slot = self->reserve(s.rawLength + 2);
+    if (slot) {
+      memcpy(slot, s.raw, s.rawLength);
+      slot[s.rawLength] = '\r';
+      slot[s.rawLength + 1] = '\n';
+      self->repeated++;
+    }
+    self->flush();
+  }
+
+  void resetCounters() {
+    generated = repeated = bytes = dropped = 0;
+  }
+
+  uint32_t getGenerated() { return generated; }
+  uint32_t getRepeated() { return repeated; }
+  uint32_t getBytes() { return bytes; }
+  uint32_t getDropped() { return dropped; }
+  size_t getPending() { return tx_tail - tx_head; }
+
+  void printStats(Print& p) {
+    static const char* const MODES[] = {"off", "generate", "passthrough"};
+    p.printf("[NMEA out] mode=%s generated=%lu repeated=%lu bytes=%lu dropped=%lu pending=%u\n",
+             MODES[mode], (unsigned long)generated, (unsigned long)repeated,
+             (unsigned long)bytes, (unsigned long)dropped, (unsigned)getPending());
+  }
+};
+
+#endif // NMEA0183_OUTPUT_H
@@ -0,0 +1,198 @@
+/*
+  NMEA0183Parser.h - Incremental NMEA 0183 sentence parser
+
+  Takes the UART stream one byte at a time and calls a handler for each
+  complete sentence with a valid checksum. Holds at most one sentence
+  (NMEA_MAX_SENTENCE bytes, the limit in the standard) and never
+  allocates. Sentences longer than that are dropped whole and counted
+  as overruns; a start character in the middle of a sentence starts
+  over, since the first one lost its end.
+
+  Fields are not copied or terminated: NMEASentence points into the
+  parser's buffer, which stays intact (with its checksum) until the
+  handler returns, so the raw sentence can be repeated as is. Each field
+  ends at the next ',' or '*'.
+
+  Sentences without a checksum are passed on and counted as unchecked;
+  older instruments still send them.
+
+  typeCode packs a three-letter sentence type into an integer
+  (NMEA_TYPE('M','W','V')), so handlers can dispatch on it with integer
+  compares instead of string compares.
+*/
+
+#ifndef NMEA0183_PARSER_H
+#define NMEA0183_PARSER_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NMEA_MAX_SENTENCE 82   // '$' through <CR><LF>
+#define NMEA_MAX_FIELDS   24   // Data fields after the address
+
+#define NMEA_TYPE(a, b, c) ((uint32_t)(uint8_t)(a) << 16 | (uint32_t)(uint8_t)(b) << 8 | (uint8_t)(c))
+
+struct NMEASentence {
+  char talker[3];            // "WI", "II"; "P" plus nothing for proprietary
+  char type[6];              // "MWV"; manufacturer and type for proprietary
+  uint32_t typeCode;         // NMEA_TYPE() of a three-letter type, 0 otherwise
+  uint8_t fieldCount;
+  const char* fields[NMEA_MAX_FIELDS];
+  const char* raw;           // Whole sentence from '$', without <CR><LF>
+  uint8_t rawLength;
+
+  bool isEmpty(uint8_t i) const {
+    return i >= fieldCount || fields[i][0] == ',' || fields[i][0] == '*' || fields[i][0] == '\0';
+  }
+
+  // First character of a field, 0 if empty
+  char getChar(uint8_t i) const {
+    return isEmpty(i) ? 0 : fields[i][0];
+  }
+
+  // Parse a numeric field; false if empty or not a number
+  bool getFloat(uint8_t i, float& value) const {
+    if (isEmpty(i)) return false;
+    char* end;
+    value = strtof(fields[i], &end);
+    return end != fields[i] && (*end == ',' || *end == '*' || *end == '\0');
+  }
+};
+
+typedef void (*NMEASentenceHandler)(void* context, const NMEASentence& sentence);
+
+class NMEA0183Parser {
+private:
+  char buffer[NMEA_MAX_SENTENCE + 1];
+  uint8_t length;
+  bool in_sentence;
+  NMEASentenceHandler handler;
+  void* handler_context;
+
+  uint32_t bytes;
+  uint32_t sentences;        // Passed to the handler
+  uint32_t checksum_errors;
+  uint32_t overruns;         // Longer than NMEA_MAX_SENTENCE
+  uint32_t restarts;         // Start character before the end of a sentence
+  uint32_t malformed;        // No address field
+  uint32_t unchecked;        // Passed on without a checksum
+
+  static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+  }
+
+  void finishSentence() {
+    buffer[length] = '\0';
+    uint8_t end = length;
+
+    // Checksum: XOR of everything between the start character and '*'
+    const char* star = (const char*)memchr(buffer, '*', length);
+    if (star) {
+      uint8_t sum = 0;
+      for (const char* p = buffer + 1; p < star; p++) sum ^= (uint8_t)*p;
+      int hi = star + 2 < buffer + length ? hexValue(star[1]) : -1;
+      int lo = star + 2 < buffer + length ? hexValue(star[2]) : -1;
+      if (hi < 0 || lo < 0 || sum != (uint8_t)(hi << 4 | lo)) {
+        checksum_errors++;
+        return;
+      }
+      end = star - buffer;
+    } else {
+      unchecked++;
+    }
+
+    // Address field: talker and sentence type, or P + manufacturer
+    NMEASentence s;
+    const char* comma = (const char*)memchr(buffer, ',', end);
+    uint8_t address = (comma ? comma : buffer + end) - buffer - 1;
+    if (address < 4 || address > 6) {
+      malformed++;
+      return;
+    }
+    if (buffer[1] == 'P') {
+      s.talker[0] = 'P';
+      s.talker[1] = '\0';
+      memcpy(s.type, buffer + 2, address - 1);
+      s.type[address - 1] = '\0';
+    } else {
+      memcpy(s.talker, buffer + 1, 2);
+      s.talker[2] = '\0';
+      memcpy(s.type, buffer + 3, address - 2);
+      s.type[address - 2] = '\0';
+    }
+    s.typeCode = s.talker[0] != 'P' && address == 5 ? NMEA_TYPE(s.type[0], s.type[1], s.type[2]) : 0;
+
+    s.fieldCount = 0;
+    for (const char* p = comma; p && p < buffer + end && s.fieldCount < NMEA_MAX_FIELDS; ) {
+      s.fields[s.fieldCount++] = p + 1;
+      p = (const char*)memchr(p + 1, ',', buffer + end - p - 1);
+    }
+    s.raw = buffer;
+    s.rawLength = length;
+    sentences++;
+    if (handler) handler(handler_context, s);
+  }
+
+public:
+  NMEA0183Parser() : handler(nullptr), handler_context(nullptr) {
+    reset();
+    resetCounters();
+  }
+
+  void setHandler(NMEASentenceHandler callback, void* context) {
+    handler = callback;
+    handler_context = context;
+  }
+
+  // Drop any partial sentence
+  void reset() {
+    length = 0;
+    in_sentence = false;
+  }
+
+  void resetCounters() {
+    bytes = sentences = checksum_errors = overruns = restarts = malformed = unchecked = 0;
+  }
+
+  void feed(uint8_t c) {
+    bytes++;
+    if (c == '$' || c == '!') {
+      if (in_sentence && length > 0) restarts++;
+      buffer[0] = (char)c;
+      length = 1;
+      in_sentence = true;
+      return;
+    }
+    if (!in_sentence) return;
+    if (c == '\r' || c == '\n') {
+      in_sentence = false;
+      finishSentence();
+      return;
+    }
+    // Room is left for <CR><LF> within the limit
+    if (length >= NMEA_MAX_SENTENCE - 2) {
+      overruns++;
+      in_sentence = false;
+      return;
+    }
+    buffer[length++] = (char)c;
+  }
+
+  void feed(const uint8_t* data, size_t n) {
+    for (size_t i = 0; i < n; i++) feed(data[i]);
+  }
+
+  uint32_t getBytes() { return bytes; }
+  uint32_t getSentences() { return sentences; }
+  uint32_t getChecksumErrors() { return checksum_errors; }
+  uint32_t getOverruns() { return overruns; }
+  uint32_t getRestarts() { return restarts; }
+  uint32_t getMalformed() { return malformed; }
+  uint32_t getUnchecked() { return unchecked; }
+};
+
+#endif // NMEA0183_PARSER_H
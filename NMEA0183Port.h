@@ -0,0 +1,95 @@
+/*
+  NMEA0183Port.h - One UART shared by NMEA input and output
+
+  The ESP32-C6 has a single free UART, so the NMEA source reading the
+  bus (RX) and the NMEA output stage (TX) share it. Each side attaches
+  and detaches on its own; the UART is restarted with the pins of
+  whichever sides are attached and ended when neither is. There is one
+  baud rate, set by the last side to attach.
+
+  A new reader replaces the current one (make-before-break: the new NMEA
+  source starts while the old one still runs); the old reader's detach
+  is then ignored. Receive callbacks are set by the reader before it
+  attaches and survive restarts.
+*/
+
+#ifndef NMEA0183_PORT_H
+#define NMEA0183_PORT_H
+
+#include <HardwareSerial.h>
+
+class NMEA0183Port {
+private:
+  static HardwareSerial* port;
+  static const void* reader;
+  static bool writer;
+  static bool started;
+  static int8_t rx_pin;
+  static int8_t tx_pin;
+  static uint32_t baud;
+  static size_t rx_buffer;
+  static size_t tx_buffer;
+
+  static void restart() {
+    if (started) port->end();
+    started = false;
+    if (!reader && !writer) return;
+    if (reader && rx_buffer) port->setRxBufferSize(rx_buffer);   // Only take effect before begin()
+    if (writer && tx_buffer) port->setTxBufferSize(tx_buffer);
+    port->begin(baud, SERIAL_8N1, reader ? rx_pin : -1, writer ? tx_pin : -1);
+    started = true;
+  }
+
+public:
+  // Take RX over for owner, replacing any previous reader
+  static void attachReader(HardwareSerial* serial, const void* owner, int8_t rx, uint32_t baud_rate,
+                           size_t buffer_size) {
+    port = serial;
+    reader = owner;
+    rx_pin = rx;
+    baud = baud_rate;
+    rx_buffer = buffer_size;
+    restart();
+  }
+
+  // Release RX if owner still has it; true if it did
+  static bool detachReader(const void* owner) {
+    if (!owner || reader != owner) return false;
+    port->onReceive(nullptr);
+    port->onReceiveError(nullptr);
+    reader = nullptr;
+    restart();
+    return true;
+  }
+
+  static bool isReader(const void* owner) { return owner && reader == owner; }
+
+  // Take TX; a TX buffer lets writes up to availableForWrite() return at once
+  static void attachWriter(HardwareSerial* serial, int8_t tx, uint32_t baud_rate, size_t buffer_size) {
+    if (writer && port == serial && tx_pin == tx && baud == baud_rate && tx_buffer == buffer_size) return;
+    port = serial;
+    writer = true;
+    tx_pin = tx;
+    baud = baud_rate;
+    tx_buffer = buffer_size;
+    restart();
+  }
+
+  static void detachWriter() {
+    if (!writer) return;
+    writer = false;
+    restart();
+  }
+};
+
+HardwareSerial* NMEA0183Port::port = nullptr;
+const void* NMEA0183Port::reader = nullptr;
+bool NMEA0183Port::writer = false;
+bool NMEA0183Port::started = false;
+int8_t NMEA0183Port::rx_pin = -1;
+int8_t NMEA0183Port::tx_pin = -1;
+uint32_t NMEA0183Port::baud = 4800;
+size_t NMEA0183Port::rx_buffer = 0;
+size_t NMEA0183Port::tx_buffer = 0;
+
+#endif // NMEA0183_PORT_H
@@ -0,0 +1,249 @@
+/*
+  NMEA0183TalkerFilter.h - Talker priority and duplicate/echo suppression
+
+  On a multiplexed bus the same sentence often arrives from several
+  talkers: MWV from the masthead unit (WI) and again from the
+  chartplotter repeating it (II), with slightly different values or
+  timing. The filter decides per sentence whether to use it:
+
+    priority   Each stream (sentence type; for MWV also the R/T
+               reference) follows one talker. A talker ranked lower in
+               the priority list (e.g. "WI,II") is dropped while a
+               higher one has sent that stream within the hold time;
+               when the higher one falls silent the next one takes over.
+               Talkers not in the list rank below all listed ones.
+    duplicate  The same content from the same talker within the
+               duplicate window (a multiplexer forwarding one input
+               twice).
+    echo       The same content from another talker that ranks no higher
+               within the echo window (a device repeating what it
+               heard). A higher-ranked talker sending what a repeater
+               sent first is not an echo; it takes the stream over.
+
+  Priority streams are kept only for the types set with
+  setPriorityTypes() (all types if none are set), so the busy sentences
+  a source ignores (GSV, GGA, VDM...) do not fill the stream table. A
+  stream that finds the table full skips the priority check and is
+  counted as unfiltered.
+
+  Content is compared by a hash of the fields after the address, so the
+  talker ID and checksum do not matter. Every decision is counted. Fixed
+  tables, no allocation; does not depend on Arduino.
+*/
+
+#ifndef NMEA0183_TALKER_FILTER_H
+#define NMEA0183_TALKER_FILTER_H
+
+#include <stdint.h>
+#include <string.h>
+#include "NMEA0183Parser.h"
+
+#define NMEA_FILTER_MAX_TALKERS   8
+#define NMEA_FILTER_MAX_STREAMS   16
+#define NMEA_FILTER_RECENT        16     // Sentences remembered for duplicate/echo checks
+#define NMEA_FILTER_HOLD_MS       2000   // A silent higher-priority talker is given up after this
+#define NMEA_FILTER_DUPLICATE_MS  50
+#define NMEA_FILTER_ECHO_MS       500
+
+enum NMEAFilterVerdict {
+  NMEA_FILTER_ACCEPT,
+  NMEA_FILTER_REJECT_PRIORITY,    // A higher-priority talker owns this stream
+  NMEA_FILTER_REJECT_DUPLICATE,   // Same talker, same content
+  NMEA_FILTER_REJECT_ECHO         // Other talker ranked no higher, same content
+};
+
+class NMEA0183TalkerFilter {
+private:
+  struct Stream {
+    uint32_t key;        // typeCode, plus the MWV reference in the top byte
+    uint16_t talker;
+    uint8_t rank;
+    uint32_t lastMs;
+  };
+
+  struct Recent {
+    uint32_t hash;
+    uint16_t talker;
+    uint32_t ms;
+  };
+
+  uint16_t talkers[NMEA_FILTER_MAX_TALKERS];   // Priority order
+  uint8_t talkerCount;
+  uint32_t priorityTypes[NMEA_FILTER_MAX_STREAMS];   // typeCodes with a stream, none = all
+  uint8_t priorityTypeCount;
+  Stream streams[NMEA_FILTER_MAX_STREAMS];
+  uint8_t streamCount;
+  Recent recent[NMEA_FILTER_RECENT];
+  uint8_t recentNext;
+
+  uint32_t hold_ms;
+  uint32_t duplicate_ms;
+  uint32_t echo_ms;
+
+  uint32_t accepted;
+  uint32_t rejectedPriority;
+  uint32_t rejectedDuplicate;
+  uint32_t rejectedEcho;
+  uint32_t takeovers;          // Stream moved to another talker
+  uint32_t unfiltered;         // Accepted without a priority check (stream table full)
+
+  static uint16_t talkerCode(const char* t) {
+    return (uint16_t)((uint8_t)t[0] << 8 | (uint8_t)t[1]);
+  }
+
+  uint8_t rankOf(uint16_t talker) {
+    for (uint8_t i = 0; i < talkerCount; i++) {
+      if (talkers[i] == talker) return i;
+    }
+    return talkerCount;
+  }
+
+  static uint32_t hash(const char* p, const char* end) {
+    uint32_t h = 2166136261u;   // FNV-1a
+    for (; p < end; p++) h = (h ^ (uint8_t)*p) * 16777619u;
+    return h;
+  }
+
+  // Sentence type and fields, without talker and checksum
+  static uint32_t contentHash(const NMEASentence& s) {
+    const char* p = s.raw + 1 + strlen(s.talker);
+    const char* end = (const char*)memchr(p, '*', s.raw + s.rawLength - p);
+    return hash(p, end ? end : s.raw + s.rawLength);
+  }
+
+  bool isPriorityType(uint32_t typeCode) {
+    if (!priorityTypeCount) return true;
+    for (uint8_t i = 0; i < priorityTypeCount; i++) {
+      if (priorityTypes[i] == typeCode) return true;
+    }
+    return false;
+  }
+
+  Stream* findStream(uint32_t key) {
+    for (uint8_t i = 0; i < streamCount; i++) {
+      if (streams[i].key == key) return &streams[i];
+    }
+    if (streamCount == NMEA_FILTER_MAX_STREAMS) return nullptr;
+    Stream* s = &streams[streamCount++];
+    s->key = key;
+    s->talker = 0;
+    s->rank = 0;
+    s->lastMs = 0;
+    return s;
+  }
+
+  NMEAFilterVerdict classify(const NMEASentence& s, uint32_t now) {
+    uint16_t talker = talkerCode(s.talker);
+
+    Stream* stream = nullptr;
+    if (isPriorityType(s.typeCode)) {
+      uint32_t key = s.typeCode ? s.typeCode : hash(s.type, s.type + strlen(s.type)) & 0xFFFFFF;
+      if (s.typeCode == NMEA_TYPE('M', 'W', 'V')) key |= (uint32_t)(uint8_t)s.getChar(1) << 24;
+      stream = findStream(key);
+      if (stream) {
+        uint8_t rank = rankOf(talker);
+        if (stream->talker && stream->talker != talker) {
+          if (rank > stream->rank && now - stream->lastMs < hold_ms) {
+            return NMEA_FILTER_REJECT_PRIORITY;
+          }
+        }
+      } else {
+        unfiltered++;
+      }
+    }
+
+    uint32_t content = contentHash(s);
+    for (uint8_t i = 0; i < NMEA_FILTER_RECENT; i++) {
+      const Recent& r = recent[i];
+      if (r.hash != content || !r.talker) continue;
+      if (r.talker == talker && now - r.ms < duplicate_ms) return NMEA_FILTER_REJECT_DUPLICATE;
+      if (r.talker != talker && now - r.ms < echo_ms && rankOf(talker) >= rankOf(r.talker)) {
+        return NMEA_FILTER_REJECT_ECHO;
+      }
+    }
+
+    if (stream) {
+      if (stream->talker && stream->talker != talker) takeovers++;
+      stream->talker = talker;
+      stream->rank = rankOf(talker);
+      stream->lastMs = now;
+    }
+    Recent& r = recent[recentNext];
+    r.hash = content;
+    r.talker = talker;
+    r.ms = now;
+    recentNext = (recentNext + 1) % NMEA_FILTER_RECENT;
+    return NMEA_FILTER_ACCEPT;
+  }
+
+public:
+  NMEA0183TalkerFilter()
+    : talkerCount(0), priorityTypeCount(0), hold_ms(NMEA_FILTER_HOLD_MS), duplicate_ms(NMEA_FILTER_DUPLICATE_MS),
+      echo_ms(NMEA_FILTER_ECHO_MS) {
+    reset();
+    resetCounters();
+  }
+
+  // Talker IDs in priority order, comma separated ("WI,II"); empty = all equal
+  void setPriority(const char* list) {
+    talkerCount = 0;
+    for (const char* p = list; p && p[0] && p[1] && talkerCount < NMEA_FILTER_MAX_TALKERS; ) {
+      talkers[talkerCount++] = talkerCode(p);
+      p += 2;
+      while (*p == ',' || *p == ' ') p++;
+    }
+    reset();
+  }
+
+  // Sentence types (NMEA_TYPE()) that follow the talker priority; the
+  // rest only get duplicate and echo checks. count 0 = every type.
+  void setPriorityTypes(const uint32_t* types, uint8_t count) {
+    priorityTypeCount = 0;
+    for (uint8_t i = 0; i < count && priorityTypeCount < NMEA_FILTER_MAX_STREAMS; i++) {
+      priorityTypes[priorityTypeCount++] = types[i];
+    }
+    reset();
+  }
+
+  void setHoldMs(uint32_t ms) { hold_ms = ms; }
+  void setDuplicateWindowMs(uint32_t ms) { duplicate_ms = ms; }
+  void setEchoWindowMs(uint32_t ms) { echo_ms = ms; }
+
+  // Forget stream owners and recent sentences
+  void reset() {
+    streamCount = 0;
+    recentNext = 0;
+    memset(recent, 0, sizeof(recent));
+  }
+
+  void resetCounters() {
+    accepted = rejectedPriority = rejectedDuplicate = rejectedEcho = takeovers = unfiltered = 0;
+  }
+
+  // Classify a sentence and update the counters
+  NMEAFilterVerdict check(const NMEASentence& s, uint32_t now) {
+    NMEAFilterVerdict verdict = classify(s, now);
+    switch (verdict) {
+      case NMEA_FILTER_ACCEPT: accepted++; break;
+      case NMEA_FILTER_REJECT_PRIORITY: rejectedPriority++; break;
+      case NMEA_FILTER_REJECT_DUPLICATE: rejectedDuplicate++; break;
+      case NMEA_FILTER_REJECT_ECHO: rejectedEcho++; break;
+    }
+    return verdict;
+  }
+
+  bool accept(const NMEASentence& s, uint32_t now) {
+    return check(s, now) == NMEA_FILTER_ACCEPT;
+  }
+
+  uint8_t getTalkerCount() { return talkerCount; }
+  uint32_t getAccepted() { return accepted; }
+  uint32_t getRejected() { return rejectedPriority + rejectedDuplicate + rejectedEcho; }
+  uint32_t getRejectedPriority() { return rejectedPriority; }
+  uint32_t getRejectedDuplicate() { return rejectedDuplicate; }
+  uint32_t getRejectedEcho() { return rejectedEcho; }
+  uint32_t getTakeovers() { return takeovers; }
+  uint32_t getUnfiltered() { return unfiltered; }
+};
+
+#endif // NMEA0183_TALKER_FILTER_H
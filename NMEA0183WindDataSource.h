@@ -0,0 +1,483 @@
+/*
+  NMEA0183WindDataSource.h - Wind from an NMEA 0183 instrument bus
+
+  Reads a UART (RX only) through NMEA0183Parser and decodes the
+  sentences a serial-only boat needs for wind into an InstrumentState:
+
+    MWV  apparent (R) or true (T) wind angle and speed
+    VWR  apparent wind angle 0-180 L/R and speed
+    MWD  true wind direction and speed
+    VHW  heading true/magnetic and speed through water
+    HDG  magnetic sensor heading with deviation and variation
+    HDT  true heading
+    HDM  magnetic heading
+    RMC  speed and course over ground (and magnetic variation)
+    VTG  speed and course over ground
+
+  Each sentence first passes the NMEA0183TalkerFilter (talker priority,
+  duplicate and echo suppression), then is dispatched through
+  NMEA_DECODERS by its packed type code and counted per type. Every quantity keeps its own update time in
+  the InstrumentState, so consumers can check its age.
+
+  Every apparent reading is published as a sample. True wind goes along
+  with it when the bus sent it within NMEA_TIMEOUT_DATA ms, as MWV T or
+  as MWD with a true heading. Without either it is computed from the
+  apparent wind and a fresh speed through water (leeway and current
+  ignored) and stored in the state too. The rest of the state is read
+  with getInstrumentState().
+
+  Reception is event-driven, not polled: the UART driver's interrupt
+  moves the hardware FIFO into its own buffer, and the driver's event
+  task calls back into this source on every FIFO-full or RX timeout to
+  copy the bytes into a lock-free ring of NMEA_RX_BUFFER_SIZE bytes.
+  update() (loop or source task) parses what has arrived. A busy display
+  only lets the ring fill; at 38400 baud (3840 bytes/s) the default 1 KB
+  ring plus the 1 KB driver buffer bridge a stall of about half a second.
+  The ring records its worst fill level and counts every byte it had to
+  drop; driver buffer overflows are counted per event (the driver does
+  not say how many bytes were lost).
+
+  The UART is shared with the NMEA output through NMEA0183Port. Only one
+  instance reads it at a time: begin() takes RX over and stop() releases
+  it only if it is still the reader, so a new instance can start (e.g.
+  at another baud rate) before the old one is stopped.
+
+  A sentence tap (setSentenceTap) sees every sentence that passed the
+  talker filter, unchanged, e.g. for passthrough to the NMEA output. It
+  runs wherever update() runs.
+
+  With no port (nullptr) bytes can be pushed into the ring with feed(),
+  which the tests and host tools use.
+*/
+
+#ifndef NMEA0183_WIND_DATA_SOURCE_H
+#define NMEA0183_WIND_DATA_SOURCE_H
+
+#include "WindDataSource.h"
+#include "NMEA0183Parser.h"
+#include "NMEA0183TalkerFilter.h"
+#include "NMEA0183Port.h"
+#include "InstrumentState.h"
+#include "SpscQueue.h"
+
+#ifndef NMEA_RX_BUFFER_SIZE
+#define NMEA_RX_BUFFER_SIZE 1024   // Receive ring and UART driver buffer, bytes, power of two
+#endif
+
+#define NMEA_TIMEOUT_DATA   5000   // ms a quantity stays fresh
+#define NMEA_KNOTS_TO_MS    0.514444f
+#define NMEA_KMH_TO_MS      (1.0f / 3.6f)
+#define NMEA_DECODER_COUNT  9
+
+class NMEA0183WindDataSource;
+
+struct NMEASentenceDecoder {
+  uint32_t type;          // NMEA_TYPE()
+  const char* name;
+  void (NMEA0183WindDataSource::*decode)(const NMEASentence& sentence);
+};
+
+class NMEA0183WindDataSource final : public WindDataSource {
+private:
+  HardwareSerial* port;
+  int8_t rx_pin;
+  uint32_t baud;
+  NMEA0183Parser parser;
+  NMEA0183TalkerFilter filter;
+  NMEASentenceHandler tap;
+  void* tap_context;
+  SpscQueue<uint8_t, NMEA_RX_BUFFER_SIZE> rx_ring;   // UART event task -> update()
+  volatile uint32_t uart_overflows;                  // Driver FIFO/buffer overflow events
+
+  InstrumentState instruments;
+  bool true_computed;             // True wind in the state came from computeTrueWind(), not the bus
+  float variation;                // Magnetic variation, degrees east, from HDG or RMC
+  uint32_t variation_time;        // millis() of the last variation, 0 = none
+  uint32_t decoded[NMEA_DECODER_COUNT];
+  uint32_t unhandled;             // Valid sentences of types not in NMEA_DECODERS
+  uint32_t invalid;               // Sentences with status V or unusable fields
+  uint32_t computed;              // Samples with true wind from apparent wind and boat speed
+  bool running;
+
+  static const NMEASentenceDecoder NMEA_DECODERS[NMEA_DECODER_COUNT];
+
+  static float wrap360(float angle) {
+    angle = fmodf(angle, 360.0f);
+    return angle < 0 ? angle + 360.0f : angle;
+  }
+
+  static bool toMetersPerSecond(float value, char unit, float& ms) {
+    switch (unit) {
+      case 'N': ms = value * NMEA_KNOTS_TO_MS; return true;
+      case 'K': ms = value * NMEA_KMH_TO_MS; return true;
+      case 'M': ms = value; return true;
+      default: return false;
+    }
+  }
+
+  // Speed from a value field followed by its unit field
+  static bool getSpeed(const NMEASentence& s, uint8_t i, float& ms) {
+    float value;
+    return s.getFloat(i, value) && toMetersPerSecond(value, s.getChar(i + 1), ms);
+  }
+
+  // East positive, from a value field followed by E/W
+  static bool getEast(const NMEASentence& s, uint8_t i, float& value) {
+    char side = s.getChar(i + 1);
+    if (!s.getFloat(i, value) || (side != 'E' && side != 'W')) return false;
+    if (side == 'W') value = -value;
+    return true;
+  }
+
+  // Store an angle field; with a reference, only if the next field matches it
+  bool setAngle(InstrumentQuantity q, const NMEASentence& s, uint8_t i, char reference, uint32_t now) {
+    float angle;
+    if (!s.getFloat(i, angle) || (reference && s.getChar(i + 1) != reference)) return false;
+    instruments.set(q, wrap360(angle), now);
+    return true;
+  }
+
+  bool isFresh(InstrumentQuantity q, uint32_t now) {
+    return instruments.age(q, now) < NMEA_TIMEOUT_DATA;
+  }
+
+  void setVariation(float east, uint32_t now) {
+    variation = east;
+    variation_time = now ? now : 1;
+  }
+
+  static void onSentence(void* context, const NMEASentence& s) {
+    NMEA0183WindDataSource* self = (NMEA0183WindDataSource*)context;
+    self->metrics.messages++;
+    if (!self->filter.accept(s, millis())) return;
+    if (self->tap) self->tap(self->tap_context, s);
+    for (uint8_t i = 0; i < NMEA_DECODER_COUNT; i++) {
+      if (NMEA_DECODERS[i].type == s.typeCode) {
+        self->decoded[i]++;
+        (self->*NMEA_DECODERS[i].decode)(s);
+        return;
+      }
+    }
+    self->unhandled++;
+  }
+
+  // $--MWV,angle,R|T,speed,N|K|M,A|V
+  void decodeMWV(const NMEASentence& s) {
+    float angle, ms;
+    char reference = s.getChar(1);
+    if (s.getChar(4) != 'A' || !s.getFloat(0, angle) || !getSpeed(s, 2, ms) ||
+        (reference != 'R' && reference != 'T')) {
+      invalid++;
+      return;
+    }
+    if (reference == 'T') {
+      uint32_t now = millis();
+      instruments.set(IQ_TRUE_WIND_SPEED, ms, now);
+      instruments.set(IQ_TRUE_WIND_ANGLE, wrap360(angle), now);
+      true_computed = false;
+    } else {
+      publishApparent(ms, wrap360(angle));
+    }
+  }
+
+  // $--VWR,angle,L|R,knots,N,m/s,M,km/h,K
+  void decodeVWR(const NMEASentence& s) {
+    float angle, ms = 0;
+    char side = s.getChar(1);
+    if (!s.getFloat(0, angle) || (side != 'L' && side != 'R') || angle < 0 || angle > 180) {
+      invalid++;
+      return;
+    }
+    // Prefer m/s, then knots, then km/h, whichever the instrument filled in
+    if (!getSpeed(s, 4, ms) && !getSpeed(s, 2, ms) && !getSpeed(s, 6, ms)) {
+      invalid++;
+      return;
+    }
+    publishApparent(ms, side == 'L' ? wrap360(360.0f - angle) : angle);
+  }
+
+  // $--MWD,direction,T,direction,M,knots,N,m/s,M
+  void decodeMWD(const NMEASentence& s) {
+    uint32_t now = millis();
+    float ms;
+    bool direction = setAngle(IQ_TRUE_WIND_DIRECTION, s, 0, 'T', now);
+    bool speed = getSpeed(s, 6, ms) || getSpeed(s, 4, ms);
+    if (!direction && !speed) {
+      invalid++;
+      return;
+    }
+    if (speed) instruments.set(IQ_TRUE_WIND_SPEED, ms, now);
+    bool angle_set = false;
+    if (direction && isFresh(IQ_HEADING_TRUE, now)) {
+      float angle = instruments.get(IQ_TRUE_WIND_DIRECTION) - instruments.get(IQ_HEADING_TRUE);
+      instruments.set(IQ_TRUE_WIND_ANGLE, wrap360(angle), now);
+      angle_set = true;
+    }
+    // Without a heading there is no angle; keep computing true wind
+    if (speed && angle_set) true_computed = false;
+  }
+
+  // $--VHW,heading,T,heading,M,knots,N,km/h,K
+  void decodeVHW(const NMEASentence& s) {
+    uint32_t now = millis();
+    float ms;
+    bool any = setAngle(IQ_HEADING_TRUE, s, 0, 'T', now);
+    any |= setAngle(IQ_HEADING_MAGNETIC, s, 2, 'M', now);
+    if (getSpeed(s, 4, ms) || getSpeed(s, 6, ms)) {
+      instruments.set(IQ_SPEED_THROUGH_WATER, ms, now);
+      any = true;
+    }
+    if (!any) invalid++;
+  }
+
+  // $--HDG,sensor heading,deviation,E|W,variation,E|W
+  void decodeHDG(const NMEASentence& s) {
+    uint32_t now = millis();
+    float heading, deviation, east;
+    if (!s.getFloat(0, heading)) {
+      invalid++;
+      return;
+    }
+    if (getEast(s, 1, deviation)) heading += deviation;
+    instruments.set(IQ_HEADING_MAGNETIC, wrap360(heading), now);
+    if (getEast(s, 3, east)) {
+      setVariation(east, now);
+      instruments.set(IQ_HEADING_TRUE, wrap360(heading + east), now);
+    }
+  }
+
+  // $--HDT,heading,T
+  void decodeHDT(const NMEASentence& s) {
+    if (!setAngle(IQ_HEADING_TRUE, s, 0, 'T', millis())) invalid++;
+  }
+
+  // $--HDM,heading,M; gives a true heading with a recent variation if
+  // nothing sends one directly
+  void decodeHDM(const NMEASentence& s) {
+    uint32_t now = millis();
+    if (!setAngle(IQ_HEADING_MAGNETIC, s, 0, 'M', now)) {
+      invalid++;
+      return;
+    }
+    if (variation_time && now - variation_time < NMEA_TIMEOUT_DATA && !isFresh(IQ_HEADING_TRUE, now)) {
+      instruments.set(IQ_HEADING_TRUE, wrap360(instruments.get(IQ_HEADING_MAGNETIC) + variation), now);
+    }
+  }
+
+  // $--RMC,time,A|V,lat,N|S,lon,E|W,knots,course,date,variation,E|W[,mode]
+  void decodeRMC(const NMEASentence& s) {
+    uint32_t now = millis();
+    float knots, east;
+    if (s.getChar(1) != 'A') {
+      invalid++;
+      return;
+    }
+    if (s.getFloat(6, knots)) instruments.set(IQ_SPEED_OVER_GROUND, knots * NMEA_KNOTS_TO_MS, now);
+    setAngle(IQ_COURSE_OVER_GROUND, s, 7, 0, now);   // Empty when stopped
+    if (getEast(s, 9, east)) setVariation(east, now);
+  }
+
+  // $--VTG,course,T,course,M,knots,N,km/h,K[,mode]
+  // NMEA 1.x, without the unit letters: $--VTG,course,course,knots,km/h
+  void decodeVTG(const NMEASentence& s) {
+    uint32_t now = millis();
+    float ms, knots;
+    if (!s.isEmpty(1) && s.getChar(1) != 'T') {
+      setAngle(IQ_COURSE_OVER_GROUND, s, 0, 0, now);
+      if (s.getFloat(2, knots)) instruments.set(IQ_SPEED_OVER_GROUND, knots * NMEA_KNOTS_TO_MS, now);
+      return;
+    }
+    if (s.getChar(8) == 'N') {   // Mode indicator: data not valid
+      invalid++;
+      return;
+    }
+    setAngle(IQ_COURSE_OVER_GROUND, s, 0, 'T', now);
+    if (getSpeed(s, 4, ms) || getSpeed(s, 6, ms)) instruments.set(IQ_SPEED_OVER_GROUND, ms, now);
+  }
+
+  // Apparent wind minus the boat's motion through the water
+  void computeTrueWind(uint32_t now) {
+    float speed = instruments.get(IQ_APPARENT_WIND_SPEED);
+    float rad = instruments.get(IQ_APPARENT_WIND_ANGLE) * 0.017453293f;
+    float along = speed * cosf(rad) - instruments.get(IQ_SPEED_THROUGH_WATER);
+    float across = speed * sinf(rad);
+    float angle = wrap360(atan2f(across, along) * 57.29578f);
+    instruments.set(IQ_TRUE_WIND_SPEED, sqrtf(along * along + across * across), now);
+    instruments.set(IQ_TRUE_WIND_ANGLE, angle, now);
+    if (isFresh(IQ_HEADING_TRUE, now)) {
+      instruments.set(IQ_TRUE_WIND_DIRECTION, wrap360(instruments.get(IQ_HEADING_TRUE) + angle), now);
+    }
+    true_computed = true;
+    computed++;
+  }
+
+  void publishApparent(float speed, float angle) {
+    uint32_t now = millis();
+    instruments.set(IQ_APPARENT_WIND_SPEED, speed, now);
+    instruments.set(IQ_APPARENT_WIND_ANGLE, angle, now);
+    bool received_true = !true_computed &&
+      isFresh(IQ_TRUE_WIND_ANGLE, now) && isFresh(IQ_TRUE_WIND_SPEED, now);
+    if (!received_true && isFresh(IQ_SPEED_THROUGH_WATER, now)) {
+      computeTrueWind(now);
+    }
+
+    WindSample sample = {};
+    sample.speed = speed;
+    sample.angle = angle;
+    sample.receivedMs = now;
+    sample.valid = WIND_SAMPLE_SPEED_VALID | WIND_SAMPLE_ANGLE_VALID;
+    if (isFresh(IQ_TRUE_WIND_ANGLE, now) && isFresh(IQ_TRUE_WIND_SPEED, now)) {
+      sample.trueSpeed = instruments.get(IQ_TRUE_WIND_SPEED);
+      sample.trueAngle = instruments.get(IQ_TRUE_WIND_ANGLE);
+      sample.valid |= WIND_SAMPLE_TRUE_VALID;
+    }
+    publishSample(sample);
+  }
+
+  // UART event task: copy what the driver has received into the ring
+  void drainPort() {
+    uint8_t chunk[64];
+    int n;
+    while ((n = port->available()) > 0) {
+      size_t got = port->read(chunk, n < (int)sizeof(chunk) ? n : sizeof(chunk));
+      if (!got) break;
+      for (size_t i = 0; i < got; i++) rx_ring.push(chunk[i]);
+    }
+  }
+
+  void syncParserMetrics() {
+    metrics.bytes = parser.getBytes();
+    metrics.parseErrors = parser.getChecksumErrors() + parser.getOverruns() + parser.getMalformed();
+  }
+
+public:
+  NMEA0183WindDataSource(HardwareSerial* serial_port, int8_t rx, uint32_t baud_rate)
+    : port(serial_port), rx_pin(rx), baud(baud_rate), tap(nullptr), tap_context(nullptr),
+      uart_overflows(0), true_computed(false),
+      variation(0), variation_time(0), unhandled(0), invalid(0), computed(0), running(false) {
+    memset(decoded, 0, sizeof(decoded));
+    parser.setHandler(onSentence, this);
+    // Talker priority only for what is decoded; other types would fill the stream table
+    uint32_t types[NMEA_DECODER_COUNT];
+    for (uint8_t i = 0; i < NMEA_DECODER_COUNT; i++) types[i] = NMEA_DECODERS[i].type;
+    filter.setPriorityTypes(types, NMEA_DECODER_COUNT);
+  }
+
+  ~NMEA0183WindDataSource() {
+    if (running) stop();
+  }
+
+  bool begin() override {
+    parser.reset();
+    filter.reset();
+    instruments.clear();
+    true_computed = false;
+    variation_time = 0;
+    running = true;
+    if (!port) return true;
+    Serial.printf("[NMEA] Listening on RX pin %d at %lu baud\n", rx_pin, (unsigned long)baud);
+    port->onReceive([this]() { drainPort(); }, false);
+    port->onReceiveError([this](hardwareSerial_error_t error) {
+      if (error == UART_BUFFER_FULL_ERROR || error == UART_FIFO_OVF_ERROR) uart_overflows++;
+    });
+    NMEA0183Port::attachReader(port, this, rx_pin, baud, NMEA_RX_BUFFER_SIZE);
+    return true;
+  }
+
+  void update() override {
+    if (!running) return;
+    uint8_t c;
+    while (rx_ring.pop(c)) parser.feed(c);
+    syncParserMetrics();
+  }
+
+  // Push received bytes into the ring, as the UART callback would (for
+  // sources without a port, e.g. in tests); parsed by the next update()
+  void feed(const char* data, size_t length) {
+    if (port) return;   // The UART callback is the ring's only producer
+    for (size_t i = 0; i < length; i++) rx_ring.push((uint8_t)data[i]);
+  }
+
+  bool isConnected() override {
+    return isFresh(IQ_APPARENT_WIND_SPEED, millis());
+  }
+
+  float getWindSpeed() override { return instruments.get(IQ_APPARENT_WIND_SPEED); }
+  float getWindAngle() override { return instruments.get(IQ_APPARENT_WIND_ANGLE); }
+  const char* getSourceName() override { return "NMEA 0183"; }
+
+  const char* getStatusText() override {
+    if (!running) return "Off";
+    return isConnected() ? "NMEA" : "NMEA wait";
+  }
+
+  void stop() override {
+    running = false;
+    NMEA0183Port::detachReader(this);
+    Serial.println("[NMEA] Stopped");
+  }
+
+  // Called with each sentence that passed the talker filter
+  void setSentenceTap(NMEASentenceHandler callback, void* context) {
+    tap = callback;
+    tap_context = context;
+  }
+
+  // Everything decoded from the bus, each quantity with its update time
+  const InstrumentState& getInstrumentState() { return instruments; }
+
+  NMEA0183Parser& getParser() { return parser; }
+  NMEA0183TalkerFilter& getFilter() { return filter; }
+  uint32_t getInvalid() { return invalid; }
+  uint32_t getUnhandled() { return unhandled; }
+  uint32_t getTrueComputed() { return computed; }
+  uint32_t getRxMaxFill() { return rx_ring.getMaxDepth(); }
+  uint32_t getRxDropped() { return rx_ring.getOverruns(); }
+  uint32_t getUartOverflows() { return uart_overflows; }
+
+  // Sentences decoded of a type (NMEA_TYPE('M','W','V')), 0 if not in the table
+  uint32_t getDecoded(uint32_t type) {
+    for (uint8_t i = 0; i < NMEA_DECODER_COUNT; i++) {
+      if (NMEA_DECODERS[i].type == type) return decoded[i];
+    }
+    return 0;
+  }
+
+  void printStats(Print& out) {
+    out.printf("[NMEA] bytes=%lu sentences=%lu checksum errors=%lu overruns=%lu restarts=%lu "
+               "malformed=%lu unchecked=%lu invalid=%lu\n",
+               (unsigned long)parser.getBytes(), (unsigned long)parser.getSentences(),
+               (unsigned long)parser.getChecksumErrors(), (unsigned long)parser.getOverruns(),
+               (unsigned long)parser.getRestarts(), (unsigned long)parser.getMalformed(),
+               (unsigned long)parser.getUnchecked(), (unsigned long)invalid);
+    out.print("[NMEA] decoded");
+    for (uint8_t i = 0; i < NMEA_DECODER_COUNT; i++) {
+      out.printf(" %s=%lu", NMEA_DECODERS[i].name, (unsigned long)decoded[i]);
+    }
+    out.printf(" other=%lu, true wind computed=%lu\n", (unsigned long)unhandled, (unsigned long)computed);
+    out.printf("[NMEA] filter accepted=%lu priority=%lu duplicate=%lu echo=%lu takeovers=%lu "
+               "unfiltered=%lu\n",
+               (unsigned long)filter.getAccepted(), (unsigned long)filter.getRejectedPriority(),
+               (unsigned long)filter.getRejectedDuplicate(), (unsigned long)filter.getRejectedEcho(),
+               (unsigned long)filter.getTakeovers(), (unsigned long)filter.getUnfiltered());
+    out.printf("[NMEA] rx buffer worst fill=%lu/%u dropped bytes=%lu uart overflows=%lu\n",
+               (unsigned long)rx_ring.getMaxDepth(), (unsigned)NMEA_RX_BUFFER_SIZE,
+               (unsigned long)rx_ring.getOverruns(), (unsigned long)uart_overflows);
+  }
+};
+
+// Wind first: it is most of the traffic
+const NMEASentenceDecoder NMEA0183WindDataSource::NMEA_DECODERS[NMEA_DECODER_COUNT] = {
+  { NMEA_TYPE('M', 'W', 'V'), "MWV", &NMEA0183WindDataSource::decodeMWV },
+  { NMEA_TYPE('V', 'W', 'R'), "VWR", &NMEA0183WindDataSource::decodeVWR },
+  { NMEA_TYPE('M', 'W', 'D'), "MWD", &NMEA0183WindDataSource::decodeMWD },
+  { NMEA_TYPE('V', 'H', 'W'), "VHW", &NMEA0183WindDataSource::decodeVHW },
+  { NMEA_TYPE('H', 'D', 'G'), "HDG", &NMEA0183WindDataSource::decodeHDG },
+  { NMEA_TYPE('H', 'D', 'T'), "HDT", &NMEA0183WindDataSource::decodeHDT },
+  { NMEA_TYPE('H', 'D', 'M'), "HDM", &NMEA0183WindDataSource::decodeHDM },
+  { NMEA_TYPE('R', 'M', 'C'), "RMC", &NMEA0183WindDataSource::decodeRMC },
+  { NMEA_TYPE('V', 'T', 'G'), "VTG", &NMEA0183WindDataSource::decodeVTG },
+};
+
+
+#endif // NMEA0183_WIND_DATA_SOURCE_H
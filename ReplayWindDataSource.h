@@ -0,0 +1,167 @@
+/*
+  ReplayWindDataSource.h - Plays back a WindRecordingFormat recording
+
+  Reads the recording through a read callback (a LittleFS file on the
+  device, a FILE* or memory buffer on the desktop) in small chunks, and
+  publishes the samples with their recorded spacing scaled by the
+  playback speed: 1 = real time, N = N times faster,
+  WIND_REPLAY_AS_FAST_AS_POSSIBLE = one sample per update().
+
+  Playback is deterministic: the same recording always yields the same
+  samples in the same order, whatever the speed. Only receivedMs is
+  replaced with the local time of publishing; sourceTime is kept. The
+  gap between segments (e.g. across a reboot) is skipped.
+
+  Needs only millis() and Serial, so it also builds on Linux with the
+  shim in tools/wind-replay.
+*/
+
+#ifndef REPLAY_WIND_DATA_SOURCE_H
+#define REPLAY_WIND_DATA_SOURCE_H
+
+#include "WindDataSource.h"
+#include "WindRecordingFormat.h"
+
+#define WIND_REPLAY_AS_FAST_AS_POSSIBLE 0
+#define WIND_REPLAY_BUFFER              256
+
+// Fills buffer with up to length bytes, returns 0 at the end
+typedef size_t (*WindRecordRead)(void* context, uint8_t* buffer, size_t length);
+
+class ReplayWindDataSource final : public WindDataSource {
+private:
+  WindRecordRead reader;
+  void* reader_context;
+  WindRecordCodec codec;
+  uint8_t buffer[WIND_REPLAY_BUFFER];
+  size_t buffered;
+  size_t pos;
+  bool eof;
+
+  float speed;               // Playback rate, 0 = as fast as possible
+  WindSample next;
+  bool have_next;
+  bool segment_start;        // next is the first sample of a segment
+  uint32_t prev_received;    // Recorded time of the last sample played
+  double play_clock;         // Recorded ms played so far
+  double next_due;           // play_clock at which next is published
+  unsigned long last_update;
+
+  WindSample current;
+  uint32_t played;
+  uint32_t segments;
+  bool corrupt;
+  bool running;
+
+  void refill() {
+    if (eof || buffered - pos >= WIND_RECORD_MAX_SIZE) return;
+    memmove(buffer, buffer + pos, buffered - pos);
+    buffered -= pos;
+    pos = 0;
+    while (!eof && buffered < WIND_REPLAY_BUFFER) {
+      size_t n = reader(reader_context, buffer + buffered, WIND_REPLAY_BUFFER - buffered);
+      if (n == 0) eof = true;
+      buffered += n;
+      metrics.bytes += n;
+    }
+  }
+
+  // Decode the next sample into next, skipping segment headers
+  void loadNext() {
+    have_next = false;
+    while (!corrupt) {
+      refill();
+      size_t used;
+      WindRecordResult result = codec.decode(buffer + pos, buffered - pos, used, next);
+      pos += used;
+      if (result != WIND_RECORD_NEED_MORE) metrics.messages++;
+      if (result == WIND_RECORD_SEGMENT) {
+        segment_start = true;
+        segments++;
+      } else if (result == WIND_RECORD_SAMPLE) {
+        uint32_t gap = segment_start ? 0 : next.receivedMs - prev_received;
+        next_due += gap;
+        prev_received = next.receivedMs;
+        segment_start = false;
+        have_next = true;
+        return;
+      } else if (result == WIND_RECORD_CORRUPT) {
+        Serial.printf("[Replay] Corrupt record after %lu samples\n", (unsigned long)played);
+        metrics.parseErrors++;
+        corrupt = true;
+      } else {
+        // End of the recording; a partial record is a write cut short
+        if (pos < buffered) Serial.println("[Replay] Last record truncated");
+        return;
+      }
+    }
+  }
+
+  void publishNext() {
+    current = next;
+    current.receivedMs = millis();
+    played++;
+    publishSample(current);
+    loadNext();
+  }
+
+public:
+  ReplayWindDataSource(WindRecordRead read, void* context, float playback_speed = 1.0f)
+    : reader(read), reader_context(context), buffered(0), pos(0), eof(false),
+      speed(playback_speed), have_next(false), segment_start(false), prev_received(0),
+      play_clock(0), next_due(0), last_update(0), current(), played(0), segments(0),
+      corrupt(false), running(false) {}
+
+  // 1 = real time, N = N times faster, WIND_REPLAY_AS_FAST_AS_POSSIBLE
+  void setSpeed(float playback_speed) { speed = playback_speed; }
+
+  bool begin() override {
+    refill();
+    if (buffered < WIND_RECORD_HEADER_SIZE || memcmp(buffer, WIND_RECORD_MAGIC, 4) != 0) {
+      Serial.println("[Replay] Not a wind recording");
+      return false;
+    }
+    play_clock = 0;
+    next_due = 0;
+    last_update = millis();
+    running = true;
+    loadNext();
+    Serial.printf("[Replay] Started at %s\n", speed > 0 ? "recorded pace" : "full speed");
+    return true;
+  }
+
+  void update() override {
+    if (!running || !have_next) return;
+    if (speed <= 0) {
+      publishNext();
+      return;
+    }
+    unsigned long now = millis();
+    play_clock += (now - last_update) * (double)speed;
+    last_update = now;
+    while (have_next && next_due <= play_clock) {
+      publishNext();
+    }
+  }
+
+  bool isConnected() override { return running && have_next; }
+  float getWindSpeed() override { return current.speed; }
+  float getWindAngle() override { return current.angle; }
+  const char* getSourceName() override { return "Replay"; }
+
+  const char* getStatusText() override {
+    if (corrupt) return "Replay err";
+    return have_next ? "Replay" : "Replay end";
+  }
+
+  void stop() override {
+    running = false;
+  }
+
+  bool isFinished() { return !have_next; }
+  bool isCorrupt() { return corrupt; }
+  uint32_t getPlayed() { return played; }
+  uint32_t getSegments() { return segments; }
+};
+
+#endif // REPLAY_WIND_DATA_SOURCE_H
@@ -0,0 +1,264 @@
+/*
+  SignalKDeltaParser.h - Single-pass streaming parser for Signal K deltas
+
+  Walks a delta frame straight out of the WebSocket payload buffer and
+  reports every updates[].values[].{path,value} together with the
+  timestamp of the update it belongs to. No heap, no DOM: strings are
+  handed out as pointer/length spans into the caller's buffer, and the
+  only state is a fixed pending-value table held in the parser object.
+
+  Numeric values are reported directly. Object values (e.g.
+  navigation.attitude {roll, pitch, yaw}) are reported once per numeric
+  member with the member name in `field`. Strings, booleans and nulls
+  are skipped.
+
+  Paths are hashed while they are scanned (see SignalKPathHash.h) so
+  consumers can dispatch on `pathHash` without touching the string.
+
+  Does not depend on Arduino so it can be exercised on a desktop build.
+*/
+
+#ifndef SIGNALK_DELTA_PARSER_H
+#define SIGNALK_DELTA_PARSER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "SignalKPathHash.h"
+#include "SignalKJsonScanner.h"
+
+// Values buffered while waiting for an update's timestamp
+#define SIGNALK_MAX_PENDING_VALUES 16
+
+// Numeric members kept per object value (roll/pitch/yaw etc.)
+#define SIGNALK_MAX_OBJECT_FIELDS 4
+
+struct SignalKDeltaValue {
+  const char* path;           // Points into the payload, not NUL terminated
+  uint16_t pathLength;
+  uint32_t pathHash;          // Hash of path, or of "path.field" for object members
+  const char* field;          // Member name for object values, else nullptr
+  uint16_t fieldLength;
+  float value;
+  const char* timestamp;      // ISO 8601 timestamp of the update, or nullptr
+  uint16_t timestampLength;
+};
+
+typedef void (*SignalKValueHandler)(void* context, const SignalKDeltaValue& value);
+
+class SignalKDeltaParser : private SignalKJsonScanner {
+private:
+  SignalKValueHandler handler;
+  void* handlerContext;
+
+  // Current update block
+  const char* updateTimestamp;
+  uint16_t updateTimestampLength;
+  SignalKDeltaValue pending[SIGNALK_MAX_PENDING_VALUES];
+  uint8_t pendingCount;
+
+  // Current value object
+  SignalKDeltaValue fields[SIGNALK_MAX_OBJECT_FIELDS];
+  uint8_t fieldCount;
+
+  // Statistics
+  uint32_t framesParsed;
+  uint32_t valuesParsed;
+  uint32_t parseErrors;
+
+  void emit(SignalKDeltaValue& value) {
+    valuesParsed++;
+    if (handler) {
+      handler(handlerContext, value);
+    }
+  }
+
+  // Hold the value until the update's timestamp is known. If the table
+  // is full the value goes out now without a timestamp.
+  void deliver(SignalKDeltaValue& value) {
+    if (updateTimestamp) {
+      value.timestamp = updateTimestamp;
+      value.timestampLength = updateTimestampLength;
+      emit(value);
+    } else if (pendingCount < SIGNALK_MAX_PENDING_VALUES) {
+      pending[pendingCount++] = value;
+    } else {
+      emit(value);
+    }
+  }
+
+  // Object value: collect numeric members, skip everything else
+  bool parseObjectValue() {
+    if (!consume('{')) return false;
+    if (consume('}')) return true;
+    do {
+      const char* key;
+      uint16_t keyLength;
+      if (!parseString(key, keyLength) || !consume(':')) return false;
+      if (atNumber()) {
+        float v;
+        if (!parseNumber(v)) return false;
+        if (fieldCount < SIGNALK_MAX_OBJECT_FIELDS) {
+          SignalKDeltaValue& f = fields[fieldCount++];
+          f.field = key;
+          f.fieldLength = keyLength;
+          f.value = v;
+        }
+      } else if (!skipValue()) {
+        return false;
+      }
+    } while (consume(','));
+    return consume('}');
+  }
+
+  // { "path": "...", "value": ... } in either member order
+  bool parseValueEntry() {
+    if (!consume('{')) return false;
+
+    const char* path = nullptr;
+    uint16_t pathLength = 0;
+    uint32_t pathHash = 0;
+    fieldCount = 0;
+    bool scalar = false;
+    float scalarValue = 0;
+
+    if (!consume('}')) {
+      do {
+        const char* key;
+        uint16_t keyLength;
+        if (!parseString(key, keyLength) || !consume(':')) return false;
+
+        if (keyLength == 4 && memcmp(key, "path", 4) == 0) {
+          if (!parseHashedString(path, pathLength, pathHash)) return false;
+        } else if (keyLength == 5 && memcmp(key, "value", 5) == 0) {
+          if (atNumber()) {
+            if (!parseNumber(scalarValue)) return false;
+            scalar = true;
+          } else if (peek('{')) {
+            if (!parseObjectValue()) return false;
+          } else if (!skipValue()) {
+            return false;
+          }
+        } else if (!skipValue()) {
+          return false;
+        }
+      } while (consume(','));
+      if (!consume('}')) return false;
+    }
+
+    if (!path) return true;
+
+    if (scalar) {
+      SignalKDeltaValue v = {path, pathLength, pathHash, nullptr, 0, scalarValue, nullptr, 0};
+      deliver(v);
+    } else {
+      uint32_t memberSeed = signalKHashAppend(pathHash, ".", 1);
+      for (uint8_t i = 0; i < fieldCount; i++) {
+        uint32_t fieldHash = signalKHashAppend(memberSeed, fields[i].field, fields[i].fieldLength);
+        SignalKDeltaValue v = {path, pathLength, fieldHash, fields[i].field, fields[i].fieldLength,
+                               fields[i].value, nullptr, 0};
+        deliver(v);
+      }
+    }
+    return true;
+  }
+
+  bool parseValues() {
+    if (!consume('[')) return false;
+    if (consume(']')) return true;
+    do {
+      if (!parseValueEntry()) return false;
+    } while (consume(','));
+    return consume(']');
+  }
+
+  bool parseUpdate() {
+    if (!consume('{')) return false;
+
+    updateTimestamp = nullptr;
+    updateTimestampLength = 0;
+    pendingCount = 0;
+
+    if (!consume('}')) {
+      do {
+        const char* key;
+        uint16_t keyLength;
+        if (!parseString(key, keyLength) || !consume(':')) return false;
+
+        if (keyLength == 6 && memcmp(key, "values", 6) == 0) {
+          if (!parseValues()) return false;
+        } else if (keyLength == 9 && memcmp(key, "timestamp", 9) == 0 && peek('"')) {
+          if (!parseString(updateTimestamp, updateTimestampLength)) return false;
+        } else if (!skipValue()) {
+          return false;
+        }
+      } while (consume(','));
+      if (!consume('}')) return false;
+    }
+
+    // Flush values that arrived before the timestamp
+    for (uint8_t i = 0; i < pendingCount; i++) {
+      pending[i].timestamp = updateTimestamp;
+      pending[i].timestampLength = updateTimestampLength;
+      emit(pending[i]);
+    }
+    pendingCount = 0;
+    return true;
+  }
+
+  bool parseUpdates() {
+    if (!consume('[')) return false;
+    if (consume(']')) return true;
+    do {
+      if (!parseUpdate()) return false;
+    } while (consume(','));
+    return consume(']');
+  }
+
+  bool parseFrame() {
+    if (!consume('{')) return false;
+    if (consume('}')) return true;
+    do {
+      const char* key;
+      uint16_t keyLength;
+      if (!parseString(key, keyLength) || !consume(':')) return false;
+
+      if (keyLength == 7 && memcmp(key, "updates", 7) == 0) {
+        if (!parseUpdates()) return false;
+      } else if (!skipValue()) {
+        return false;
+      }
+    } while (consume(','));
+    return consume('}');
+  }
+
+public:
+  SignalKDeltaParser()
+    : handler(nullptr), handlerContext(nullptr),
+      updateTimestamp(nullptr), updateTimestampLength(0), pendingCount(0), fieldCount(0),
+      framesParsed(0), valuesParsed(0), parseErrors(0) {}
+
+  void setHandler(SignalKValueHandler h, void* context) {
+    handler = h;
+    handlerContext = context;
+  }
+
+  // Parse one complete frame. Values seen before a syntax error have
+  // already been delivered; returns false if the frame was malformed.
+  bool parse(const char* json, size_t length) {
+    reset(json, length);
+
+    if (!parseFrame()) {
+      parseErrors++;
+      return false;
+    }
+    framesParsed++;
+    return true;
+  }
+
+  uint32_t getFramesParsed() { return framesParsed; }
+  uint32_t getValuesParsed() { return valuesParsed; }
+  uint32_t getParseErrors() { return parseErrors; }
+};
+
+#endif // SIGNALK_DELTA_PARSER_H
@@ -0,0 +1,246 @@
+/*
+  SignalKFailoverSource.h - Hot-standby failover across Signal K servers
+
+  Runs one SignalKWindDataSource per configured server (primary first,
+  then backups) and keeps all of them connected and subscribed, so a
+  backup already has live data when it is needed.
+
+  A link is healthy while wind deltas keep arriving within the missed-
+  data interval (the wind subscription period plus a margin). With the
+  instant policy the server only sends on change, so a steady wind is
+  not a dead link: there a link is healthy while it has delivered data
+  and is alive, i.e. subscribed and answering the WebSocket heartbeat
+  (SignalKWindDataSource::isAlive()). When the
+  active link misses one interval the display moves to the first healthy
+  link in list order straight away. Moving back to a higher-priority
+  server needs it to stay healthy for SK_FAILBACK_HOLD first, so a
+  flapping primary does not make the display bounce.
+  
+  Every sample the active link publishes is republished here as it
+  arrives (each link is subscribed to), so raw subscribers such as the
+  recorder see all of them, not just the newest per update().
+  
+  Links live in StaticSlots inside this object, so rebuilding the
+  failover source after a config change does not touch the heap.
+*/
+
+#ifndef SIGNALK_FAILOVER_SOURCE_H
+#define SIGNALK_FAILOVER_SOURCE_H
+
+#include "WindDataSource.h"
+#include "SignalKWindDataSource.h"
+#include "StaticSlot.h"
+#include "WindConfig.h"
+
+#define SK_FAILOVER_MARGIN    500      // ms added to the wind period before a link counts as stale
+#define SK_FAILBACK_HOLD      30000    // ms a higher-priority link must stay healthy before switching back
+
+class SignalKFailoverSource final : public WindDataSource {
+private:
+  // Subscriber context for one link
+  struct LinkTap {
+    SignalKFailoverSource* owner;
+    uint8_t index;
+  };
+  
+  StaticSlot<SignalKWindDataSource> link_slots[SIGNALK_MAX_SERVERS];
+  SignalKWindDataSource* links[SIGNALK_MAX_SERVERS];
+  unsigned long healthy_since[SIGNALK_MAX_SERVERS];  // millis(), 0 = not healthy
+  LinkTap taps[SIGNALK_MAX_SERVERS];
+  uint8_t link_count;
+  uint8_t active;
+  unsigned long missed_interval;
+  bool check_data_age;           // False for instant: quiet is not stale
+  uint32_t failovers;
+  char ssid[33];
+  char password[65];
+
+  bool isHealthy(uint8_t i, unsigned long now) {
+    unsigned long rx = links[i]->getLastDataTime();
+    if (!rx) return false;
+    if (!check_data_age) return links[i]->isAlive(now);
+    return now - rx <= missed_interval;
+  }
+
+  // Republish samples from the active link only
+  static void onLinkSample(void* context, const WindSample& sample) {
+    LinkTap* tap = (LinkTap*)context;
+    SignalKFailoverSource* self = tap->owner;
+    if (tap->index == self->active) {
+      self->publishSample(sample);
+    }
+  }
+
+  void activate(uint8_t i, const char* reason) {
+    Serial.printf("[Failover] %s -> %s (%s)\n",
+                  links[active]->getHost(), links[i]->getHost(), reason);
+    active = i;
+    failovers++;
+    
+    // The new link's latest sample, so the display need not wait for the next one
+    WindSample sample = links[i]->getLatestSample();
+    if (sample.sequence) publishSample(sample);
+  }
+
+  void selectActive() {
+    unsigned long now = millis();
+    for (uint8_t i = 0; i < link_count; i++) {
+      if (isHealthy(i, now)) {
+        if (!healthy_since[i]) healthy_since[i] = now ? now : 1;
+      } else {
+        healthy_since[i] = 0;
+      }
+    }
+
+    // Active link went quiet: take the first healthy one, no hold
+    if (!healthy_since[active]) {
+      for (uint8_t i = 0; i < link_count; i++) {
+        if (i != active && healthy_since[i]) {
+          activate(i, "missed data");
+          return;
+        }
+      }
+      return;
+    }
+
+    // Active link is fine: return to a better one once it has settled
+    for (uint8_t i = 0; i < active; i++) {
+      if (healthy_since[i] && now - healthy_since[i] >= SK_FAILBACK_HOLD) {
+        activate(i, "failback");
+        return;
+      }
+    }
+  }
+
+public:
+  SignalKFailoverSource(const char* wifi_ssid, const char* wifi_pass)
+    : link_count(0), active(0), missed_interval(1000 + SK_FAILOVER_MARGIN),
+      check_data_age(true), failovers(0) {
+    snprintf(ssid, sizeof(ssid), "%s", wifi_ssid ? wifi_ssid : "");
+    snprintf(password, sizeof(password), "%s", wifi_pass ? wifi_pass : "");
+    for (uint8_t i = 0; i < SIGNALK_MAX_SERVERS; i++) {
+      links[i] = nullptr;
+      healthy_since[i] = 0;
+      taps[i].owner = this;
+      taps[i].index = i;
+    }
+  }
+
+  ~SignalKFailoverSource() {
+    stop();
+    for (uint8_t i = 0; i < link_count; i++) {
+      link_slots[i].destroy();
+    }
+  }
+
+  // Add a server in priority order (before begin())
+  bool addServer(const char* host, uint16_t port) {
+    if (link_count >= SIGNALK_MAX_SERVERS || !host || !host[0]) return false;
+    links[link_count] = link_slots[link_count].create(ssid, password, host, port);
+    links[link_count]->subscribe(onLinkSample, &taps[link_count]);
+    link_count++;
+    return true;
+  }
+
+  // Same subscription on every server; the apparent wind period sets
+  // how long a link may go without data before it is considered stale,
+  // unless that path is subscribed with the instant policy
+  void setSubscriptions(const SignalKSubscription* subs) {
+    for (uint8_t i = 0; i < link_count; i++) {
+      links[i]->setSubscriptions(subs);
+    }
+    for (uint8_t i = 0; i < SIGNALK_DEFAULT_PATH_COUNT; i++) {
+      if (SIGNALK_DEFAULT_PATHS[i].quantity == IQ_APPARENT_WIND_SPEED) {
+        missed_interval = subs[i].period + SK_FAILOVER_MARGIN;
+        check_data_age = subs[i].policy != SK_POLICY_INSTANT;
+      }
+    }
+  }
+
+  bool begin() override {
+    if (link_count == 0) return false;
+    bool ok = false;
+    for (uint8_t i = 0; i < link_count; i++) {
+      ok |= links[i]->begin();
+      healthy_since[i] = 0;
+    }
+    active = 0;
+    return ok;
+  }
+
+  void update() override {
+    for (uint8_t i = 0; i < link_count; i++) {
+      links[i]->update();
+    }
+    if (link_count > 1) {
+      selectActive();
+    }
+    
+    // Wire counters are the sum over all links
+    metrics.messages = metrics.bytes = metrics.parseErrors = metrics.reconnects = 0;
+    for (uint8_t i = 0; i < link_count; i++) {
+      metrics.addCounters(links[i]->getMetrics());
+    }
+  }
+
+  bool isConnected() override {
+    return link_count && links[active]->isConnected();
+  }
+
+  float getWindSpeed() override {
+    return link_count ? links[active]->getWindSpeed() : 0;
+  }
+
+  float getWindAngle() override {
+    return link_count ? links[active]->getWindAngle() : 0;
+  }
+
+  const char* getSourceName() override {
+    return "WiFi/Signal K";
+  }
+
+  const char* getStatusText() override {
+    if (!link_count) return "Off";
+    if (active > 0 && links[active]->getState() == SK_STATE_STREAMING) return "SK backup";
+    return links[active]->getStatusText();
+  }
+
+  void stop() override {
+    for (uint8_t i = 0; i < link_count; i++) {
+      if (links[i]->getState() != SK_STATE_IDLE) {
+        links[i]->stop();
+      }
+    }
+  }
+
+  SignalKWindDataSource* getActiveLink() { return link_count ? links[active] : nullptr; }
+  uint8_t getActiveIndex() { return active; }
+  uint8_t getLinkCount() { return link_count; }
+  SignalKWindDataSource* getLink(uint8_t i) { return i < link_count ? links[i] : nullptr; }
+  uint32_t getFailovers() { return failovers; }
+
+  // Active link's timing, for the latency instrumentation
+  unsigned long getLastDataTime() { return link_count ? links[active]->getLastDataTime() : 0; }
+  LatencyHistogram& getServerLatency() { return links[active]->getServerLatency(); }
+  bool isWallClockSynced() { return link_count && links[active]->isWallClockSynced(); }
+
+  // Per-server counters, to compare links and servers
+  template <class Output>
+  void printLinkMetrics(Output& out) {
+    unsigned long now = millis();
+    for (uint8_t i = 0; i < link_count; i++) {
+      char name[80];
+      snprintf(name, sizeof(name), "server %u %s%s", i, links[i]->getHost(), i == active ? " (active)" : "");
+      links[i]->getMetrics().print(out, name, now);
+    }
+  }
+
+  void printPathRates(Print& out) {
+    for (uint8_t i = 0; i < link_count; i++) {
+      out.printf("[Failover] Server %u %s%s\n", i, links[i]->getHost(), i == active ? " (active)" : "");
+      links[i]->printPathRates(out);
+    }
+  }
+};
+
+#endif // SIGNALK_FAILOVER_SOURCE_H
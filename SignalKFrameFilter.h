@@ -0,0 +1,185 @@
+/*
+  SignalKFrameFilter.h - Cheap pre-parse filter for Signal K frames
+
+  Scans the raw WebSocket payload for the "context" value and the
+  "path" values and drops frames that cannot contain anything we use
+  (AIS targets, notifications.*, other vessels) before any JSON parsing.
+
+  The vessel's own context is learned from the server's hello message
+  ("self": "vessels.urn:..."). Until then every vessel context is let
+  through so no wind data is lost on connect.
+
+  Does not depend on Arduino so it can be exercised on a desktop build.
+*/
+
+#ifndef SIGNALK_FRAME_FILTER_H
+#define SIGNALK_FRAME_FILTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define SIGNALK_FILTER_MAX_PREFIXES 16
+#define SIGNALK_FILTER_MAX_SELF 64
+
+enum SignalKFrameVerdict {
+  SK_FRAME_ACCEPT,
+  SK_FRAME_REJECT_CONTEXT,     // Delta for another vessel/context
+  SK_FRAME_REJECT_PATH,        // No path we are interested in
+  SK_FRAME_REJECT_NO_UPDATES   // Hello, error or other non-delta message
+};
+
+class SignalKFrameFilter {
+private:
+  const char* prefixes[SIGNALK_FILTER_MAX_PREFIXES];
+  uint8_t prefixLengths[SIGNALK_FILTER_MAX_PREFIXES];
+  uint8_t prefixCount;
+
+  char selfContext[SIGNALK_FILTER_MAX_SELF];
+  uint8_t selfLength;
+
+  uint32_t accepted;
+  uint32_t rejectedContext;
+  uint32_t rejectedPath;
+  uint32_t rejectedNoUpdates;
+
+  // Find "key" followed by optional whitespace and a colon. Returns a
+  // pointer just past the colon, or nullptr.
+  static const char* findKey(const char* from, const char* end, const char* key, size_t keyLength) {
+    const char* p = from;
+    while (p + keyLength + 2 < end) {
+      const char* quote = (const char*)memchr(p, '"', end - p);
+      if (!quote || quote + keyLength + 2 > end) return nullptr;
+      if (memcmp(quote + 1, key, keyLength) == 0 && quote[keyLength + 1] == '"') {
+        const char* q = quote + keyLength + 2;
+        while (q < end && (*q == ' ' || *q == '\t' || *q == '\n' || *q == '\r')) q++;
+        if (q < end && *q == ':') return q + 1;
+      }
+      p = quote + 1;
+    }
+    return nullptr;
+  }
+
+  // Read the string value starting after a key's colon
+  static bool stringValue(const char* p, const char* end, const char*& start, size_t& length) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) p++;
+    if (p >= end || *p != '"') return false;
+    start = ++p;
+    const char* close = (const char*)memchr(p, '"', end - p);
+    if (!close) return false;
+    length = close - start;
+    return true;
+  }
+
+  bool contextWanted(const char* ctx, size_t length) {
+    if (length == 12 && memcmp(ctx, "vessels.self", 12) == 0) return true;
+    if (selfLength) {
+      return length == selfLength && memcmp(ctx, selfContext, selfLength) == 0;
+    }
+    // Self not learned yet: keep vessel contexts, drop everything else
+    return length > 8 && memcmp(ctx, "vessels.", 8) == 0;
+  }
+
+  bool pathWanted(const char* path, size_t length) {
+    for (uint8_t i = 0; i < prefixCount; i++) {
+      if (length >= prefixLengths[i] && memcmp(path, prefixes[i], prefixLengths[i]) == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void learnSelf(const char* json, const char* end) {
+    const char* p = findKey(json, end, "self", 4);
+    const char* value;
+    size_t length;
+    if (p && stringValue(p, end, value, length) && length < SIGNALK_FILTER_MAX_SELF) {
+      memcpy(selfContext, value, length);
+      selfContext[length] = '\0';
+      selfLength = (uint8_t)length;
+    }
+  }
+
+  SignalKFrameVerdict classify(const char* json, size_t length) {
+    const char* end = json + length;
+
+    if (!findKey(json, end, "updates", 7)) {
+      learnSelf(json, end);
+      return SK_FRAME_REJECT_NO_UPDATES;
+    }
+
+    // A delta without a context refers to the server's own vessel
+    const char* p = findKey(json, end, "context", 7);
+    const char* ctx;
+    size_t ctxLength;
+    if (p && stringValue(p, end, ctx, ctxLength) && !contextWanted(ctx, ctxLength)) {
+      return SK_FRAME_REJECT_CONTEXT;
+    }
+
+    if (prefixCount == 0) return SK_FRAME_ACCEPT;
+
+    p = json;
+    while ((p = findKey(p, end, "path", 4)) != nullptr) {
+      const char* path;
+      size_t pathLength;
+      if (stringValue(p, end, path, pathLength) && pathWanted(path, pathLength)) {
+        return SK_FRAME_ACCEPT;
+      }
+    }
+    return SK_FRAME_REJECT_PATH;
+  }
+
+public:
+  SignalKFrameFilter()
+    : prefixCount(0), selfLength(0),
+      accepted(0), rejectedContext(0), rejectedPath(0), rejectedNoUpdates(0) {
+    selfContext[0] = '\0';
+  }
+
+  // Register a path prefix of interest (e.g. "environment.wind.").
+  // The string must outlive the filter. With no prefixes every path passes.
+  bool addPathPrefix(const char* prefix) {
+    if (prefixCount >= SIGNALK_FILTER_MAX_PREFIXES) return false;
+    for (uint8_t i = 0; i < prefixCount; i++) {
+      if (strcmp(prefixes[i], prefix) == 0) return true;
+    }
+    prefixes[prefixCount] = prefix;
+    prefixLengths[prefixCount] = (uint8_t)strlen(prefix);
+    prefixCount++;
+    return true;
+  }
+
+  void clearPathPrefixes() { prefixCount = 0; }
+
+  // Forget the learned self context (call on reconnect)
+  void resetSelf() {
+    selfLength = 0;
+    selfContext[0] = '\0';
+  }
+
+  // Classify a frame and update the counters
+  SignalKFrameVerdict check(const char* json, size_t length) {
+    SignalKFrameVerdict verdict = classify(json, length);
+    switch (verdict) {
+      case SK_FRAME_ACCEPT: accepted++; break;
+      case SK_FRAME_REJECT_CONTEXT: rejectedContext++; break;
+      case SK_FRAME_REJECT_PATH: rejectedPath++; break;
+      case SK_FRAME_REJECT_NO_UPDATES: rejectedNoUpdates++; break;
+    }
+    return verdict;
+  }
+
+  bool accept(const char* json, size_t length) {
+    return check(json, length) == SK_FRAME_ACCEPT;
+  }
+
+  const char* getSelfContext() { return selfContext; }
+
+  uint32_t getAccepted() { return accepted; }
+  uint32_t getRejected() { return rejectedContext + rejectedPath + rejectedNoUpdates; }
+  uint32_t getRejectedContext() { return rejectedContext; }
+  uint32_t getRejectedPath() { return rejectedPath; }
+  uint32_t getRejectedNoUpdates() { return rejectedNoUpdates; }
+};
+
+#endif // SIGNALK_FRAME_FILTER_H
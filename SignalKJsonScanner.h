@@ -0,0 +1,208 @@
+/*
+  SignalKJsonScanner.h - Cursor-based JSON scanning primitives
+
+  Shared by the Signal K delta parser and the REST snapshot reader.
+  Works in place on a caller-owned buffer: strings come back as spans,
+  numbers are converted without strtod, and unknown values are skipped
+  iteratively with a bit stack so stack use stays constant.
+*/
+
+#ifndef SIGNALK_JSON_SCANNER_H
+#define SIGNALK_JSON_SCANNER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "SignalKPathHash.h"
+
+// Nesting limit when skipping unknown values (bits in a uint32_t)
+#define SIGNALK_MAX_SKIP_DEPTH 32
+
+class SignalKJsonScanner {
+protected:
+  const char* p;
+  const char* end;
+
+  SignalKJsonScanner() : p(nullptr), end(nullptr) {}
+
+  void reset(const char* json, size_t length) {
+    p = json;
+    end = json + length;
+  }
+
+  void skipWhitespace() {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+      p++;
+    }
+  }
+
+  bool consume(char c) {
+    skipWhitespace();
+    if (p < end && *p == c) {
+      p++;
+      return true;
+    }
+    return false;
+  }
+
+  bool peek(char c) {
+    skipWhitespace();
+    return p < end && *p == c;
+  }
+
+  // Returns the raw span between the quotes; escapes are left as-is
+  bool parseString(const char*& start, uint16_t& length) {
+    if (!consume('"')) return false;
+    start = p;
+    while (p < end && *p != '"') {
+      if (*p == '\\') p++;
+      p++;
+    }
+    if (p >= end) return false;
+    length = (uint16_t)(p - start);
+    p++;
+    return true;
+  }
+
+  // Same as parseString, hashing the raw bytes on the way
+  bool parseHashedString(const char*& start, uint16_t& length, uint32_t& hash) {
+    if (!consume('"')) return false;
+    start = p;
+    uint32_t h = SIGNALK_HASH_SEED;
+    while (p < end && *p != '"') {
+      if (*p == '\\') {
+        h = (h ^ (uint8_t)*p) * SIGNALK_HASH_PRIME;
+        p++;
+        if (p >= end) return false;
+      }
+      h = (h ^ (uint8_t)*p) * SIGNALK_HASH_PRIME;
+      p++;
+    }
+    if (p >= end) return false;
+    length = (uint16_t)(p - start);
+    hash = h;
+    p++;
+    return true;
+  }
+
+  bool parseNumber(float& out) {
+    skipWhitespace();
+    bool negative = false;
+    if (p < end && *p == '-') {
+      negative = true;
+      p++;
+    }
+    if (p >= end || *p < '0' || *p > '9') return false;
+
+    // Keep 9 significant digits in an integer, track the decimal exponent
+    uint32_t mantissa = 0;
+    int exponent = 0;
+    int digits = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+      if (digits < 9) {
+        mantissa = mantissa * 10 + (*p - '0');
+        if (mantissa) digits++;
+      } else {
+        exponent++;
+      }
+      p++;
+    }
+    if (p < end && *p == '.') {
+      p++;
+      while (p < end && *p >= '0' && *p <= '9') {
+        if (digits < 9) {
+          mantissa = mantissa * 10 + (*p - '0');
+          if (mantissa) digits++;
+          exponent--;
+        }
+        p++;
+      }
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+      p++;
+      bool expNegative = false;
+      if (p < end && (*p == '+' || *p == '-')) {
+        expNegative = (*p == '-');
+        p++;
+      }
+      int e = 0;
+      while (p < end && *p >= '0' && *p <= '9') {
+        if (e < 100) e = e * 10 + (*p - '0');
+        p++;
+      }
+      exponent += expNegative ? -e : e;
+    }
+
+    float result = (float)mantissa;
+    while (exponent > 0) { result *= 10.0f; exponent--; }
+    while (exponent < 0) {
+      if (exponent <= -4) { result *= 0.0001f; exponent += 4; }
+      else { result *= 0.1f; exponent++; }
+    }
+    out = negative ? -result : result;
+    return true;
+  }
+
+  bool matchLiteral(const char* literal) {
+    size_t n = strlen(literal);
+    if ((size_t)(end - p) < n || memcmp(p, literal, n) != 0) return false;
+    p += n;
+    return true;
+  }
+
+  // Skip any JSON value without recursion. Container types are tracked
+  // in a bit stack (1 = object) so mismatched brackets are still caught.
+  bool skipValue() {
+    skipWhitespace();
+    if (p >= end) return false;
+
+    char c = *p;
+    if (c == '"') {
+      const char* s;
+      uint16_t n;
+      return parseString(s, n);
+    }
+    if (c == '-' || (c >= '0' && c <= '9')) {
+      float ignored;
+      return parseNumber(ignored);
+    }
+    if (c == 't') return matchLiteral("true");
+    if (c == 'f') return matchLiteral("false");
+    if (c == 'n') return matchLiteral("null");
+    if (c != '{' && c != '[') return false;
+
+    uint32_t stack = 0;
+    int depth = 0;
+    while (p < end) {
+      c = *p;
+      if (c == '"') {
+        const char* s;
+        uint16_t n;
+        if (!parseString(s, n)) return false;
+        continue;
+      }
+      if (c == '{' || c == '[') {
+        if (depth >= SIGNALK_MAX_SKIP_DEPTH) return false;
+        stack = (stack << 1) | (c == '{' ? 1 : 0);
+        depth++;
+      } else if (c == '}' || c == ']') {
+        if (depth == 0 || ((stack & 1) != 0) != (c == '}')) return false;
+        stack >>= 1;
+        depth--;
+        if (depth == 0) {
+          p++;
+          return true;
+        }
+      }
+      p++;
+    }
+    return false;
+  }
+
+  bool atNumber() {
+    skipWhitespace();
+    return p < end && (*p == '-' || (*p >= '0' && *p <= '9'));
+  }
+};
+
+#endif // SIGNALK_JSON_SCANNER_H
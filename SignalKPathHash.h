@@ -0,0 +1,38 @@
+/*
+  SignalKPathHash.h - FNV-1a hashing of Signal K paths
+
+  The same hash is computed at compile time for registered paths and
+  while the parser scans an incoming path, so dispatch is a table
+  lookup instead of a string compare per registered path.
+
+  Object members are keyed as "path.field" (e.g. navigation.attitude.roll).
+*/
+
+#ifndef SIGNALK_PATH_HASH_H
+#define SIGNALK_PATH_HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SIGNALK_HASH_SEED 2166136261u
+#define SIGNALK_HASH_PRIME 16777619u
+
+// Compile-time hash of a NUL terminated string
+constexpr uint32_t signalKPathHash(const char* s, uint32_t h = SIGNALK_HASH_SEED) {
+  return *s ? signalKPathHash(s + 1, (h ^ (uint8_t)*s) * SIGNALK_HASH_PRIME) : h;
+}
+
+// Compile-time hash of "path.field"
+constexpr uint32_t signalKFieldHash(const char* path, const char* field) {
+  return signalKPathHash(field, (signalKPathHash(path) ^ (uint8_t)'.') * SIGNALK_HASH_PRIME);
+}
+
+// Runtime: continue a hash over a span
+inline uint32_t signalKHashAppend(uint32_t h, const char* s, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    h = (h ^ (uint8_t)s[i]) * SIGNALK_HASH_PRIME;
+  }
+  return h;
+}
+
+#endif // SIGNALK_PATH_HASH_H
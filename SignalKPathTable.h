@@ -0,0 +1,272 @@
+/*
+  SignalKPathTable.h - Hashed dispatch table for Signal K paths
+
+  Each entry maps a path (or "path.field" for object values) to an
+  instrument quantity, a unit conversion and a handler. Entries are
+  keyed by the FNV-1a hash from SignalKPathHash.h and stored in a small
+  open-addressed bucket array, so a lookup costs one hash probe plus a
+  single confirming compare no matter how many paths are registered.
+
+  Paths can be registered at compile time through a constexpr
+  SignalKPathDef array (hashes computed by the compiler) or at run time
+  with add(). The subscribe message is built from the same table, using
+  each entry's subscription policy (instant/ideal/fixed, minPeriod,
+  period). Entries also count arrivals so per-path delta rates can be
+  measured.
+*/
+
+#ifndef SIGNALK_PATH_TABLE_H
+#define SIGNALK_PATH_TABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "SignalKPathHash.h"
+#include "SignalKDeltaParser.h"
+#include "InstrumentState.h"
+
+#define SIGNALK_MAX_PATHS 16
+#define SIGNALK_PATH_BUCKETS 32   // Power of two, at least 2x SIGNALK_MAX_PATHS
+
+enum SignalKConversion {
+  SK_CONV_NONE,             // Value already in internal units
+  SK_CONV_RAD_TO_DEG_360,   // Radians to degrees, normalized 0-360
+  SK_CONV_RAD_TO_DEG_180    // Radians to degrees, normalized -180..180
+};
+
+// Signal K subscription policies
+enum SignalKPolicy {
+  SK_POLICY_INSTANT,   // Send on every change, throttled by minPeriod
+  SK_POLICY_IDEAL,     // Send on change, and every period if unchanged
+  SK_POLICY_FIXED      // Send every period
+};
+
+#define SK_PERIOD_MAX  60000   // ms, longest period or minPeriod accepted
+
+struct SignalKSubscription {
+  uint8_t policy;      // SignalKPolicy
+  uint16_t minPeriod;  // ms, 0 = unthrottled, never above period
+  uint16_t period;     // ms
+};
+
+inline bool signalKSubscriptionValid(const SignalKSubscription& sub) {
+  return sub.policy <= SK_POLICY_FIXED && sub.period > 0 && sub.period <= SK_PERIOD_MAX &&
+         sub.minPeriod <= sub.period;
+}
+
+inline const char* signalKPolicyName(uint8_t policy) {
+  switch (policy) {
+    case SK_POLICY_INSTANT: return "instant";
+    case SK_POLICY_IDEAL: return "ideal";
+    default: return "fixed";
+  }
+}
+
+// Wind angle/speed as fast as the sensor goes (10 Hz ultrasonic),
+// everything else once a second or on change
+inline SignalKSubscription signalKDefaultSubscription(InstrumentQuantity quantity) {
+  SignalKSubscription sub;
+  if (quantity == IQ_APPARENT_WIND_SPEED || quantity == IQ_APPARENT_WIND_ANGLE) {
+    sub.policy = SK_POLICY_INSTANT;
+    sub.minPeriod = 100;
+    sub.period = 1000;
+  } else {
+    sub.policy = SK_POLICY_IDEAL;
+    sub.minPeriod = 200;
+    sub.period = 1000;
+  }
+  return sub;
+}
+
+typedef void (*SignalKPathHandler)(void* context, InstrumentQuantity quantity, float value);
+
+// Compile-time path definition
+struct SignalKPathDef {
+  const char* path;
+  const char* field;        // Member of an object value, or nullptr
+  const char* label;        // Short name for the config screen
+  uint32_t hash;
+  InstrumentQuantity quantity;
+  SignalKConversion conversion;
+};
+
+#define SIGNALK_PATH(path, label, quantity, conversion) \
+  { path, nullptr, label, signalKPathHash(path), quantity, conversion }
+#define SIGNALK_FIELD(path, field, label, quantity, conversion) \
+  { path, field, label, signalKFieldHash(path, field), quantity, conversion }
+
+// Paths the wind display understands
+static constexpr SignalKPathDef SIGNALK_DEFAULT_PATHS[] = {
+  SIGNALK_PATH("environment.wind.speedApparent", "App wind speed", IQ_APPARENT_WIND_SPEED, SK_CONV_NONE),
+  SIGNALK_PATH("environment.wind.angleApparent", "App wind angle", IQ_APPARENT_WIND_ANGLE, SK_CONV_RAD_TO_DEG_360),
+  SIGNALK_PATH("environment.wind.speedTrue", "True wind speed", IQ_TRUE_WIND_SPEED, SK_CONV_NONE),
+  SIGNALK_PATH("environment.wind.angleTrueWater", "True wind angle", IQ_TRUE_WIND_ANGLE, SK_CONV_RAD_TO_DEG_360),
+  SIGNALK_PATH("environment.wind.directionTrue", "True wind dir", IQ_TRUE_WIND_DIRECTION, SK_CONV_RAD_TO_DEG_360),
+  SIGNALK_PATH("navigation.speedThroughWater", "Boat speed", IQ_SPEED_THROUGH_WATER, SK_CONV_NONE),
+  SIGNALK_PATH("navigation.headingTrue", "Heading true", IQ_HEADING_TRUE, SK_CONV_RAD_TO_DEG_360),
+  SIGNALK_PATH("navigation.headingMagnetic", "Heading mag", IQ_HEADING_MAGNETIC, SK_CONV_RAD_TO_DEG_360),
+  SIGNALK_PATH("navigation.speedOverGround", "SOG", IQ_SPEED_OVER_GROUND, SK_CONV_NONE),
+  SIGNALK_PATH("navigation.courseOverGroundTrue", "COG", IQ_COURSE_OVER_GROUND, SK_CONV_RAD_TO_DEG_360),
+  SIGNALK_FIELD("navigation.attitude", "roll", "Attitude", IQ_ROLL, SK_CONV_RAD_TO_DEG_180),
+  SIGNALK_FIELD("navigation.attitude", "pitch", "Attitude", IQ_PITCH, SK_CONV_RAD_TO_DEG_180),
+  SIGNALK_FIELD("navigation.attitude", "yaw", "Attitude", IQ_YAW, SK_CONV_RAD_TO_DEG_360),
+};
+
+#define SIGNALK_DEFAULT_PATH_COUNT (sizeof(SIGNALK_DEFAULT_PATHS) / sizeof(SIGNALK_DEFAULT_PATHS[0]))
+
+inline float signalKConvert(SignalKConversion conversion, float value) {
+  switch (conversion) {
+    case SK_CONV_RAD_TO_DEG_360:
+      value = value * 57.29578f;
+      while (value < 0) value += 360;
+      while (value >= 360) value -= 360;
+      return value;
+    case SK_CONV_RAD_TO_DEG_180:
+      value = value * 57.29578f;
+      while (value < -180) value += 360;
+      while (value >= 180) value -= 360;
+      return value;
+    default:
+      return value;
+  }
+}
+
+struct SignalKPathEntry {
+  const char* path;
+  const char* field;
+  uint32_t hash;
+  InstrumentQuantity quantity;
+  SignalKConversion conversion;
+  SignalKPathHandler handler;
+  void* context;
+  SignalKSubscription subscription;
+  uint32_t received;        // Values dispatched to this entry
+};
+
+class SignalKPathTable {
+private:
+  SignalKPathEntry entries[SIGNALK_MAX_PATHS];
+  int8_t buckets[SIGNALK_PATH_BUCKETS];   // Entry index, -1 = empty
+  uint8_t count;
+
+  uint32_t dispatched;
+  uint32_t unknown;
+
+  bool matches(const SignalKPathEntry& e, const SignalKDeltaValue& v) {
+    size_t pathLength = strlen(e.path);
+    if (pathLength != v.pathLength || memcmp(e.path, v.path, pathLength) != 0) return false;
+    if (!e.field) return v.field == nullptr;
+    size_t fieldLength = strlen(e.field);
+    return v.field && fieldLength == v.fieldLength && memcmp(e.field, v.field, fieldLength) == 0;
+  }
+
+public:
+  SignalKPathTable() : count(0), dispatched(0), unknown(0) {
+    clear();
+  }
+
+  void clear() {
+    count = 0;
+    for (int i = 0; i < SIGNALK_PATH_BUCKETS; i++) {
+      buckets[i] = -1;
+    }
+  }
+
+  // Register one path. `hash` must match signalKPathHash/signalKFieldHash.
+  bool add(const char* path, const char* field, uint32_t hash, InstrumentQuantity quantity,
+           SignalKConversion conversion, SignalKPathHandler handler, void* context) {
+    if (count >= SIGNALK_MAX_PATHS) return false;
+
+    uint32_t slot = hash & (SIGNALK_PATH_BUCKETS - 1);
+    while (buckets[slot] >= 0) {
+      const SignalKPathEntry& e = entries[buckets[slot]];
+      if (e.hash == hash) return false;   // Duplicate or collision
+      slot = (slot + 1) & (SIGNALK_PATH_BUCKETS - 1);
+    }
+
+    SignalKPathEntry& e = entries[count];
+    e.path = path;
+    e.field = field;
+    e.hash = hash;
+    e.quantity = quantity;
+    e.conversion = conversion;
+    e.handler = handler;
+    e.context = context;
+    e.subscription = signalKDefaultSubscription(quantity);
+    e.received = 0;
+    buckets[slot] = count;
+    count++;
+    return true;
+  }
+
+  // Register at run time, hashing the path here
+  bool add(const char* path, const char* field, InstrumentQuantity quantity,
+           SignalKConversion conversion, SignalKPathHandler handler, void* context) {
+    uint32_t hash = signalKHashAppend(SIGNALK_HASH_SEED, path, strlen(path));
+    if (field) {
+      hash = signalKHashAppend(hash, ".", 1);
+      hash = signalKHashAppend(hash, field, strlen(field));
+    }
+    return add(path, field, hash, quantity, conversion, handler, context);
+  }
+
+  // Register a compile-time definition list
+  bool addAll(const SignalKPathDef* defs, size_t n, SignalKPathHandler handler, void* context) {
+    bool ok = true;
+    for (size_t i = 0; i < n; i++) {
+      ok &= add(defs[i].path, defs[i].field, defs[i].hash, defs[i].quantity,
+                defs[i].conversion, handler, context);
+    }
+    return ok;
+  }
+
+  SignalKPathEntry* find(const SignalKDeltaValue& v) {
+    uint32_t slot = v.pathHash & (SIGNALK_PATH_BUCKETS - 1);
+    while (buckets[slot] >= 0) {
+      SignalKPathEntry& e = entries[buckets[slot]];
+      if (e.hash == v.pathHash) {
+        return matches(e, v) ? &e : nullptr;
+      }
+      slot = (slot + 1) & (SIGNALK_PATH_BUCKETS - 1);
+    }
+    return nullptr;
+  }
+
+  // Convert and hand a parsed value to its handler. Returns false for
+  // paths that are not registered.
+  bool dispatch(const SignalKDeltaValue& v) {
+    SignalKPathEntry* e = find(v);
+    if (!e) {
+      unknown++;
+      return false;
+    }
+    dispatched++;
+    e->received++;
+    if (e->handler) {
+      e->handler(e->context, e->quantity, signalKConvert(e->conversion, v.value));
+    }
+    return true;
+  }
+
+  uint8_t size() { return count; }
+  const SignalKPathEntry& entry(uint8_t i) { return entries[i]; }
+  
+  // Entries sharing a path share the subscription of the first one
+  void setSubscription(uint8_t i, const SignalKSubscription& sub) {
+    if (i < count) entries[i].subscription = sub;
+  }
+
+  // True if an earlier entry has the same path (object fields share one
+  // subscription)
+  bool isDuplicatePath(uint8_t i) {
+    for (uint8_t j = 0; j < i; j++) {
+      if (strcmp(entries[j].path, entries[i].path) == 0) return true;
+    }
+    return false;
+  }
+
+  uint32_t getDispatched() { return dispatched; }
+  uint32_t getUnknown() { return unknown; }
+};
+
+#endif // SIGNALK_PATH_TABLE_H
@@ -0,0 +1,347 @@
+/*
+  SignalKRestSnapshot.h - One-shot non-blocking REST fetch of current values
+
+  Fetches a Signal K REST resource (e.g.
+  /signalk/v1/api/vessels/self/environment/wind) over a plain socket
+  while the WebSocket handshake is still in progress, so the display has
+  current values after one round trip instead of waiting for the next
+  delta.
+
+  The socket is non-blocking throughout: poll() advances connect ->
+  send -> receive one step at a time and never waits. The response is
+  read into a fixed buffer and each {"value": n, "timestamp": "..."}
+  member of the body is reported through the same SignalKValueHandler
+  the delta parser uses, with the full path rebuilt from the resource
+  path ("environment.wind" + "." + key) and hashed for the path table.
+
+  Host name lookup (when the host is not an IP literal) uses
+  getaddrinfo() and does block, exactly like the WebSocket client does
+  for the same host.
+
+  Uses POSIX sockets, which the ESP32 core provides through lwIP, so it
+  also builds on a desktop.
+*/
+
+#ifndef SIGNALK_REST_SNAPSHOT_H
+#define SIGNALK_REST_SNAPSHOT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "SignalKJsonScanner.h"
+#include "SignalKDeltaParser.h"
+
+#define SIGNALK_SNAPSHOT_BUFFER  4096   // Response bytes kept (headers + body)
+#define SIGNALK_SNAPSHOT_PATH    64     // Longest rebuilt Signal K path
+#define SIGNALK_SNAPSHOT_TIMEOUT 3000   // ms for the whole exchange
+
+enum SignalKSnapshotState {
+  SK_SNAPSHOT_IDLE,
+  SK_SNAPSHOT_CONNECTING,
+  SK_SNAPSHOT_SENDING,
+  SK_SNAPSHOT_RECEIVING,
+  SK_SNAPSHOT_DONE,
+  SK_SNAPSHOT_FAILED
+};
+
+class SignalKRestSnapshot : private SignalKJsonScanner {
+private:
+  SignalKValueHandler handler;
+  void* handlerContext;
+
+  int sock;
+  SignalKSnapshotState state;
+  unsigned long started;
+
+  char request[192];
+  size_t requestLength;
+  size_t requestSent;
+
+  char response[SIGNALK_SNAPSHOT_BUFFER];
+  size_t responseLength;
+
+  // Rebuilt path: resource path, '.', member name
+  char path[SIGNALK_SNAPSHOT_PATH];
+  size_t prefixLength;
+  uint32_t prefixHash;     // Hash of path[0..prefixLength), including the '.'
+
+  uint16_t valuesFound;
+
+  void closeSocket() {
+    if (sock >= 0) {
+      close(sock);
+      sock = -1;
+    }
+  }
+
+  void finish(SignalKSnapshotState result) {
+    closeSocket();
+    state = result;
+  }
+
+  static bool resolve(const char* host, uint16_t port, struct sockaddr_in& addr) {
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_aton(host, &addr.sin_addr)) return true;
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* result = nullptr;
+    if (getaddrinfo(host, nullptr, &hints, &result) != 0 || !result) return false;
+    addr.sin_addr = ((struct sockaddr_in*)result->ai_addr)->sin_addr;
+    freeaddrinfo(result);
+    return true;
+  }
+
+  // Zero-timeout select on one descriptor
+  bool ready(bool forWrite) {
+    fd_set set;
+    FD_ZERO(&set);
+    FD_SET(sock, &set);
+    struct timeval tv = {0, 0};
+    int n = select(sock + 1, forWrite ? nullptr : &set, forWrite ? &set : nullptr, nullptr, &tv);
+    return n > 0;
+  }
+
+  // Status line must be 200; returns the body span
+  bool splitResponse(const char*& body, size_t& bodyLength) {
+    if (responseLength < 12 || memcmp(response, "HTTP/1.", 7) != 0) return false;
+    if (memcmp(response + 8, " 200", 4) != 0) return false;
+    for (size_t i = 12; i + 4 <= responseLength; i++) {
+      if (memcmp(response + i, "\r\n\r\n", 4) == 0) {
+        body = response + i + 4;
+        bodyLength = responseLength - i - 4;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void emitMember(const char* key, uint16_t keyLength, float value,
+                  const char* timestamp, uint16_t timestampLength) {
+    if (prefixLength + keyLength >= SIGNALK_SNAPSHOT_PATH) return;
+    memcpy(path + prefixLength, key, keyLength);
+    path[prefixLength + keyLength] = '\0';
+
+    SignalKDeltaValue v;
+    v.path = path;
+    v.pathLength = (uint16_t)(prefixLength + keyLength);
+    v.pathHash = signalKHashAppend(prefixHash, key, keyLength);
+    v.field = nullptr;
+    v.fieldLength = 0;
+    v.value = value;
+    v.timestamp = timestamp;
+    v.timestampLength = timestampLength;
+    valuesFound++;
+    if (handler) {
+      handler(handlerContext, v);
+    }
+  }
+
+  // { "value": n, "timestamp": "...", ... } for one member
+  bool parseLeaf(const char* key, uint16_t keyLength) {
+    if (!consume('{')) return false;
+    bool haveValue = false;
+    float value = 0;
+    const char* timestamp = nullptr;
+    uint16_t timestampLength = 0;
+
+    if (!consume('}')) {
+      do {
+        const char* name;
+        uint16_t nameLength;
+        if (!parseString(name, nameLength) || !consume(':')) return false;
+
+        if (nameLength == 5 && memcmp(name, "value", 5) == 0 && atNumber()) {
+          if (!parseNumber(value)) return false;
+          haveValue = true;
+        } else if (nameLength == 9 && memcmp(name, "timestamp", 9) == 0 && peek('"')) {
+          if (!parseString(timestamp, timestampLength)) return false;
+        } else if (!skipValue()) {
+          return false;
+        }
+      } while (consume(','));
+      if (!consume('}')) return false;
+    }
+
+    if (haveValue) {
+      emitMember(key, keyLength, value, timestamp, timestampLength);
+    }
+    return true;
+  }
+
+public:
+  SignalKRestSnapshot()
+    : handler(nullptr), handlerContext(nullptr), sock(-1), state(SK_SNAPSHOT_IDLE), started(0),
+      requestLength(0), requestSent(0), responseLength(0), prefixLength(0),
+      prefixHash(SIGNALK_HASH_SEED), valuesFound(0) {
+    request[0] = '\0';
+    path[0] = '\0';
+  }
+
+  ~SignalKRestSnapshot() {
+    closeSocket();
+  }
+
+  void setHandler(SignalKValueHandler h, void* context) {
+    handler = h;
+    handlerContext = context;
+  }
+
+  // Signal K path of the resource, e.g. "environment.wind"; member names
+  // of the response are appended to it
+  void setPathPrefix(const char* prefix) {
+    size_t n = strlen(prefix);
+    if (n + 2 > SIGNALK_SNAPSHOT_PATH) n = SIGNALK_SNAPSHOT_PATH - 2;
+    memcpy(path, prefix, n);
+    path[n] = '.';
+    prefixLength = n + 1;
+    prefixHash = signalKHashAppend(SIGNALK_HASH_SEED, path, prefixLength);
+  }
+
+  // Open the connection and queue the request. Returns false if the
+  // socket could not be created; the caller just carries on without it.
+  bool start(const char* host, uint16_t port, const char* resource, unsigned long now) {
+    cancel();
+    responseLength = 0;
+    requestSent = 0;
+    valuesFound = 0;
+    started = now;
+
+    struct sockaddr_in addr;
+    if (!resolve(host, port, addr)) {
+      state = SK_SNAPSHOT_FAILED;
+      return false;
+    }
+
+    int n = snprintf(request, sizeof(request),
+                     "GET %s HTTP/1.0\r\nHost: %s\r\nAccept: application/json\r\n\r\n",
+                     resource, host);
+    if (n <= 0 || (size_t)n >= sizeof(request)) {
+      state = SK_SNAPSHOT_FAILED;
+      return false;
+    }
+    requestLength = (size_t)n;
+
+    sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock < 0) {
+      state = SK_SNAPSHOT_FAILED;
+      return false;
+    }
+    fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+
+    if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) == 0) {
+      state = SK_SNAPSHOT_SENDING;
+    } else if (errno == EINPROGRESS) {
+      state = SK_SNAPSHOT_CONNECTING;
+    } else {
+      finish(SK_SNAPSHOT_FAILED);
+      return false;
+    }
+    return true;
+  }
+
+  void cancel() {
+    closeSocket();
+    state = SK_SNAPSHOT_IDLE;
+  }
+
+  // Advance by at most one step per state; never blocks
+  SignalKSnapshotState poll(unsigned long now) {
+    if (state == SK_SNAPSHOT_IDLE || state == SK_SNAPSHOT_DONE || state == SK_SNAPSHOT_FAILED) {
+      return state;
+    }
+    if (now - started > SIGNALK_SNAPSHOT_TIMEOUT) {
+      finish(SK_SNAPSHOT_FAILED);
+      return state;
+    }
+
+    if (state == SK_SNAPSHOT_CONNECTING) {
+      if (!ready(true)) return state;
+      int err = 0;
+      socklen_t len = sizeof(err);
+      if (getsockopt(sock, SOL_SOCKET, SO_ERROR, &err, &len) != 0 || err != 0) {
+        finish(SK_SNAPSHOT_FAILED);
+        return state;
+      }
+      state = SK_SNAPSHOT_SENDING;
+    }
+
+    if (state == SK_SNAPSHOT_SENDING) {
+      ssize_t n = send(sock, request + requestSent, requestLength - requestSent, 0);
+      if (n < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) finish(SK_SNAPSHOT_FAILED);
+        return state;
+      }
+      requestSent += (size_t)n;
+      if (requestSent < requestLength) return state;
+      state = SK_SNAPSHOT_RECEIVING;
+    }
+
+    if (state == SK_SNAPSHOT_RECEIVING) {
+      // Drain what is there; a full buffer is parsed as far as it goes
+      while (responseLength < sizeof(response)) {
+        ssize_t n = recv(sock, response + responseLength, sizeof(response) - responseLength, 0);
+        if (n < 0) {
+          if (errno != EAGAIN && errno != EWOULDBLOCK) finish(SK_SNAPSHOT_FAILED);
+          return state;
+        }
+        if (n == 0) break;  // Server closed: response complete
+        responseLength += (size_t)n;
+      }
+      closeSocket();
+
+      const char* body;
+      size_t bodyLength;
+      if (!splitResponse(body, bodyLength)) {
+        state = SK_SNAPSHOT_FAILED;
+        return state;
+      }
+      parseBody(body, bodyLength);
+      state = SK_SNAPSHOT_DONE;
+    }
+    return state;
+  }
+
+  // Report every member of a REST body that carries a numeric "value".
+  // Members nested deeper (e.g. per-source "values") are skipped. Values
+  // before a syntax error or truncation have already been reported.
+  bool parseBody(const char* json, size_t length) {
+    reset(json, length);
+    if (!consume('{')) return false;
+    if (consume('}')) return true;
+    do {
+      const char* key;
+      uint16_t keyLength;
+      if (!parseString(key, keyLength) || !consume(':')) return false;
+      if (peek('{')) {
+        if (!parseLeaf(key, keyLength)) return false;
+      } else if (!skipValue()) {
+        return false;
+      }
+    } while (consume(','));
+    return consume('}');
+  }
+
+  SignalKSnapshotState getState() { return state; }
+  bool isActive() {
+    return state == SK_SNAPSHOT_CONNECTING || state == SK_SNAPSHOT_SENDING ||
+           state == SK_SNAPSHOT_RECEIVING;
+  }
+  uint16_t getValuesFound() { return valuesFound; }
+  unsigned long getStartTime() { return started; }
+};
+
+#endif // SIGNALK_REST_SNAPSHOT_H
@@ -0,0 +1,80 @@
+/*
+  SignalKTimestamp.h - ISO 8601 timestamp parsing for Signal K updates
+
+  Converts "2025-12-28T04:47:18.990Z" (optionally with a +hh:mm offset)
+  into milliseconds since the Unix epoch using integer arithmetic only.
+*/
+
+#ifndef SIGNALK_TIMESTAMP_H
+#define SIGNALK_TIMESTAMP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Days since 1970-01-01 for a proleptic Gregorian date
+inline int32_t signalKDaysFromCivil(int32_t y, uint32_t m, uint32_t d) {
+  y -= m <= 2;
+  const int32_t era = (y >= 0 ? y : y - 399) / 400;
+  const uint32_t yoe = (uint32_t)(y - era * 400);
+  const uint32_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  const uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + (int32_t)doe - 719468;
+}
+
+inline bool signalKReadDigits(const char*& p, const char* end, int count, int32_t& out) {
+  out = 0;
+  for (int i = 0; i < count; i++) {
+    if (p >= end || *p < '0' || *p > '9') return false;
+    out = out * 10 + (*p++ - '0');
+  }
+  return true;
+}
+
+// Returns false if the string is not a recognisable timestamp
+inline bool signalKParseTimestamp(const char* s, size_t length, int64_t& epochMs) {
+  const char* p = s;
+  const char* end = s + length;
+  int32_t year, month, day, hour, minute, second;
+
+  if (!signalKReadDigits(p, end, 4, year) || p >= end || *p++ != '-') return false;
+  if (!signalKReadDigits(p, end, 2, month) || p >= end || *p++ != '-') return false;
+  if (!signalKReadDigits(p, end, 2, day) || p >= end || (*p != 'T' && *p != ' ')) return false;
+  p++;
+  if (!signalKReadDigits(p, end, 2, hour) || p >= end || *p++ != ':') return false;
+  if (!signalKReadDigits(p, end, 2, minute) || p >= end || *p++ != ':') return false;
+  if (!signalKReadDigits(p, end, 2, second)) return false;
+  if (month < 1 || month > 12 || day < 1 || day > 31) return false;
+
+  // Fraction: keep milliseconds, ignore finer digits
+  int32_t millis = 0;
+  if (p < end && *p == '.') {
+    p++;
+    int digits = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+      if (digits < 3) millis = millis * 10 + (*p - '0');
+      digits++;
+      p++;
+    }
+    while (digits < 3) {
+      millis *= 10;
+      digits++;
+    }
+  }
+
+  int32_t offsetMinutes = 0;
+  if (p < end && (*p == '+' || *p == '-')) {
+    int sign = (*p++ == '-') ? -1 : 1;
+    int32_t oh, om = 0;
+    if (!signalKReadDigits(p, end, 2, oh)) return false;
+    if (p < end && *p == ':') p++;
+    if (p < end) signalKReadDigits(p, end, 2, om);
+    offsetMinutes = sign * (oh * 60 + om);
+  }
+
+  int64_t days = signalKDaysFromCivil(year, month, day);
+  int64_t seconds = days * 86400 + hour * 3600 + minute * 60 + second - offsetMinutes * 60;
+  epochMs = seconds * 1000 + millis;
+  return true;
+}
+
+#endif // SIGNALK_TIMESTAMP_H
@@ -2,35 +2,309 @@
   SignalKWindDataSource.h - WiFi + Signal K WebSocket data source
   
   Connects to Signal K server via WiFi and subscribes to wind data.
+  
+  Update timestamps are parsed to measure server-to-parse latency. The
+  wall clock comes from SNTP (the Signal K host first, then
+  pool.ntp.org); until it is synced, latency is measured against the
+  smallest server/local offset seen, i.e. relative to the fastest delta.
+  
+  Connecting never blocks: begin() only starts WiFi, and update() steps
+  a state machine (associating -> DHCP -> WebSocket handshake ->
+  subscribed -> streaming) driven by WiFi and WebSocket events. Each
+  state has its own timeout and status text for the display.
+  
+  The WebSocket is pinged every second. A server that hangs or a TCP
+  connection that half-closes stops answering, so isAlive() turns false
+  within SK_ALIVE_WINDOW even if no data was expected (instant policy in
+  a steady wind), and the library drops the socket after
+  SK_HEARTBEAT_MISSES unanswered pings.
+  
+  Alongside the handshake a one-shot REST GET of the current wind values
+  (SignalKRestSnapshot) fills the display within one round trip. Its
+  values are only applied to quantities no delta has updated since.
+  
+  Several instances can run at once (e.g. a primary and a backup server
+  on the same network). WebSocket and WiFi callbacks are bound to their
+  own instance, each instance keeps its own buffers and statistics, and
+  the shared WiFi station is only dropped when the last instance stops.
 */
 
 #ifndef SIGNALK_WIND_DATA_SOURCE_H
 #define SIGNALK_WIND_DATA_SOURCE_H
 
 #include "WindDataSource.h"
+#include "SignalKDeltaParser.h"
+#include "SignalKFrameFilter.h"
+#include "SignalKPathTable.h"
+#include "SignalKRestSnapshot.h"
+#include "InstrumentState.h"
+#include "SignalKTimestamp.h"
+#include "LatencyHistogram.h"
+#include <sys/time.h>
 #include <WiFi.h>
 #include <WebSocketsClient.h>
 #include <ArduinoJson.h>
 
-class SignalKWindDataSource : public WindDataSource {
+enum SignalKConnectionState {
+  SK_STATE_IDLE,              // Not started / stopped
+  SK_STATE_WIFI_ASSOCIATING,  // WiFi.begin() issued, waiting for the AP
+  SK_STATE_DHCP,              // Associated, waiting for an IP address
+  SK_STATE_WS_HANDSHAKE,      // WebSocket connecting to the server
+  SK_STATE_SUBSCRIBED,        // Subscribe sent, waiting for wind data
+  SK_STATE_STREAMING,         // Receiving wind data
+  SK_STATE_BACKOFF            // Waiting before retrying WiFi
+};
+
+// Per-state timeouts (ms)
+#define SK_TIMEOUT_ASSOCIATE  10000
+#define SK_TIMEOUT_DHCP       10000
+#define SK_TIMEOUT_HANDSHAKE  15000
+#define SK_TIMEOUT_SUBSCRIBED 10000   // Resubscribe if no data arrives
+#define SK_TIMEOUT_DATA       10000   // Streaming -> subscribed when data stops
+#define SK_BACKOFF_TIME       3000
+
+// WebSocket ping/pong keepalive
+#define SK_HEARTBEAT_INTERVAL 1000    // ms between pings
+#define SK_HEARTBEAT_TIMEOUT  500     // ms to wait for a pong, the failover margin
+#define SK_HEARTBEAT_MISSES   2       // Unanswered pings before the library disconnects
+#define SK_ALIVE_WINDOW       (SK_HEARTBEAT_INTERVAL + SK_HEARTBEAT_TIMEOUT)  // No pong or data: not alive
+#define SK_IDLE_RESUBSCRIBES  3       // Resubscribes without data before the link counts as dead
+
+// REST resource fetched while the WebSocket connects
+#define SK_SNAPSHOT_RESOURCE  "/signalk/v1/api/vessels/self/environment/wind"
+#define SK_SNAPSHOT_PATH      "environment.wind"
+
+// Serialized subscribe message (one entry per distinct path)
+#define SK_SUBSCRIBE_BUFFER   1024
+
+// Window after which the server-derived clock offset is re-learned
+#define SK_OFFSET_WINDOW      600000
+
+class SignalKWindDataSource final : public WindDataSource {
 private:
   WebSocketsClient webSocket;
-  String host;
+  SignalKDeltaParser parser;
+  SignalKFrameFilter filter;
+  SignalKPathTable paths;
+  SignalKRestSnapshot snapshot;
+  InstrumentState instruments;
+  char host[64];
   uint16_t port;
-  String ssid;
-  String password;
+  char ssid[33];
+  char password[65];
   
-  float wind_speed_ms;
-  float wind_angle;
-  bool connected;
-  bool wifi_connected;
+  SignalKConnectionState state;
+  unsigned long state_entered;
   unsigned long last_data_time;
+  unsigned long last_alive_time;     // Last pong or frame from the server
+  uint8_t idle_resubscribes;         // Resubscribes since the last data
+  unsigned long rate_window_start;
+  uint32_t rate_snapshot[SIGNALK_MAX_PATHS];  // entry.received at window start
+  wifi_event_id_t wifi_event_id;
+  bool websocket_started;
+  bool holds_wifi;                   // Counted in wifi_users
+  bool ever_connected;               // WebSocket connected since begin()
+  uint32_t subscribe_errors;         // Subscribe messages too long to send
+  
+  // Server timestamp handling
+  LatencyHistogram server_latency;   // Server timestamp -> parsed here
+  int64_t last_server_time;          // Epoch ms of the latest wind update
+  int64_t last_recorded_time;        // Avoid recording one update per value
+  const char* ts_cache_ptr;          // Timestamp span already parsed this frame
+  int64_t ts_cache_value;
+  bool ts_cache_ok;
+  
+  // Wind sample being assembled from the current frame
+  bool sample_pending;
+  int64_t sample_source_time;
+  int64_t min_offset;                // Smallest (local millis - server ms) seen
+  bool have_min_offset;
+  unsigned long offset_window_start;
+  
+  // Set from the WiFi event task, consumed in update()
+  volatile bool wifi_associated_event;
+  volatile bool wifi_got_ip_event;
+  volatile bool wifi_lost_event;
+  
+  // The WiFi station and SNTP are shared by all instances
+  static uint8_t wifi_users;
+  static bool sntp_started;
+  static unsigned long wifi_begun_at;  // millis() of the last WiFi.begin(), 0 = none
+  
+  // Runs on the WiFi event task
+  void handleWiFiEvent(arduino_event_id_t event) {
+    switch (event) {
+      case ARDUINO_EVENT_WIFI_STA_CONNECTED:
+        wifi_associated_event = true;
+        break;
+      case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+        wifi_got_ip_event = true;
+        break;
+      case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+      case ARDUINO_EVENT_WIFI_STA_LOST_IP:
+        wifi_lost_event = true;
+        break;
+      default:
+        break;
+    }
+  }
+  
+  static const char* stateName(SignalKConnectionState s) {
+    switch (s) {
+      case SK_STATE_IDLE: return "idle";
+      case SK_STATE_WIFI_ASSOCIATING: return "associating";
+      case SK_STATE_DHCP: return "DHCP";
+      case SK_STATE_WS_HANDSHAKE: return "handshake";
+      case SK_STATE_SUBSCRIBED: return "subscribed";
+      case SK_STATE_STREAMING: return "streaming";
+      case SK_STATE_BACKOFF: return "backoff";
+      default: return "?";
+    }
+  }
+  
+  static unsigned long stateTimeout(SignalKConnectionState s) {
+    switch (s) {
+      case SK_STATE_WIFI_ASSOCIATING: return SK_TIMEOUT_ASSOCIATE;
+      case SK_STATE_DHCP: return SK_TIMEOUT_DHCP;
+      case SK_STATE_WS_HANDSHAKE: return SK_TIMEOUT_HANDSHAKE;
+      case SK_STATE_SUBSCRIBED: return SK_TIMEOUT_SUBSCRIBED;
+      case SK_STATE_BACKOFF: return SK_BACKOFF_TIME;
+      default: return 0;  // No timeout
+    }
+  }
+  
+  void enterState(SignalKConnectionState next) {
+    if (next == state) return;
+    Serial.printf("[SignalK] %s: %s -> %s\n", host, stateName(state), stateName(next));
+    state = next;
+    state_entered = millis();
+  }
+  
+  void startWiFi() {
+    wifi_associated_event = false;
+    wifi_got_ip_event = false;
+    wifi_lost_event = false;
+    enterState(SK_STATE_WIFI_ASSOCIATING);
+    
+    // Another instance already has the station up on this network
+    if (WiFi.status() == WL_CONNECTED && WiFi.SSID() == ssid) {
+      wifi_got_ip_event = true;
+      return;
+    }
+    // Another instance is already associating; its events reach us too
+    unsigned long now = millis();
+    if (wifi_users > 1 && wifi_begun_at && now - wifi_begun_at < SK_TIMEOUT_ASSOCIATE) {
+      return;
+    }
+    Serial.printf("[SignalK] Connecting to WiFi '%s'...\n", ssid);
+    WiFi.mode(WIFI_STA);
+    WiFi.begin(ssid, password);
+    wifi_begun_at = now ? now : 1;
+  }
   
-  static SignalKWindDataSource* instance;  // For static callback
+  // Drop the station only if no other instance is using it
+  void disconnectWiFi() {
+    if (wifi_users <= 1) {
+      WiFi.disconnect();
+    }
+  }
+  
+  void startWebSocket() {
+    Serial.printf("[SignalK] WiFi connected: %s\n", WiFi.localIP().toString().c_str());
+    if (!sntp_started) {
+      configTime(0, 0, host, "pool.ntp.org");
+      sntp_started = true;
+    }
+    Serial.printf("[SignalK] Connecting to server %s:%d\n", host, port);
+    webSocket.begin(host, port, "/signalk/v1/stream?subscribe=none");
+    webSocket.onEvent([this](WStype_t type, uint8_t* payload, size_t length) {
+      handleWebSocketEvent(type, payload, length);
+    });
+    webSocket.setReconnectInterval(5000);
+    webSocket.enableHeartbeat(SK_HEARTBEAT_INTERVAL, SK_HEARTBEAT_TIMEOUT, SK_HEARTBEAT_MISSES);
+    websocket_started = true;
+    if (!snapshot.start(host, port, SK_SNAPSHOT_RESOURCE, millis())) {
+      Serial.println("[SignalK] Snapshot request failed");
+    }
+    enterState(SK_STATE_WS_HANDSHAKE);
+  }
   
-  static void webSocketEvent(WStype_t type, uint8_t * payload, size_t length) {
-    if (instance) {
-      instance->handleWebSocketEvent(type, payload, length);
+  void stopWebSocket() {
+    snapshot.cancel();
+    if (websocket_started) {
+      webSocket.disconnect();
+      websocket_started = false;
+    }
+  }
+  
+  // Apply WiFi events and per-state timeouts
+  void stepStateMachine() {
+    if (wifi_lost_event) {
+      wifi_lost_event = false;
+      if (state >= SK_STATE_DHCP && state != SK_STATE_BACKOFF) {
+        Serial.println("[SignalK] WiFi lost");
+        stopWebSocket();
+        wifi_associated_event = false;
+        wifi_got_ip_event = false;
+        enterState(SK_STATE_WIFI_ASSOCIATING);  // Driver reconnects by itself
+      }
+    }
+    if (wifi_associated_event && state == SK_STATE_WIFI_ASSOCIATING) {
+      wifi_associated_event = false;
+      enterState(SK_STATE_DHCP);
+    }
+    if (wifi_got_ip_event && (state == SK_STATE_WIFI_ASSOCIATING || state == SK_STATE_DHCP)) {
+      wifi_got_ip_event = false;
+      startWebSocket();
+    }
+    
+    unsigned long now = millis();
+    unsigned long timeout = stateTimeout(state);
+    bool timedOut = timeout && (now - state_entered > timeout);
+    
+    switch (state) {
+      case SK_STATE_WIFI_ASSOCIATING:
+      case SK_STATE_DHCP:
+        if (timedOut) {
+          Serial.printf("[SignalK] WiFi %s timeout\n", stateName(state));
+          disconnectWiFi();
+          enterState(SK_STATE_BACKOFF);
+        }
+        break;
+        
+      case SK_STATE_BACKOFF:
+        if (timedOut) startWiFi();
+        break;
+        
+      case SK_STATE_WS_HANDSHAKE:
+        if (timedOut) {
+          Serial.println("[SignalK] Handshake timeout, restarting WebSocket");
+          stopWebSocket();
+          startWebSocket();
+        }
+        break;
+        
+      case SK_STATE_SUBSCRIBED:
+        if (last_data_time > 0 && now - last_data_time < SK_TIMEOUT_DATA) {
+          idle_resubscribes = 0;
+          enterState(SK_STATE_STREAMING);
+        } else if (timedOut) {
+          Serial.println("[SignalK] No data after subscribe, resubscribing");
+          subscribeToWindData();
+          if (idle_resubscribes < SK_IDLE_RESUBSCRIBES) idle_resubscribes++;
+          state_entered = now;
+        }
+        break;
+        
+      case SK_STATE_STREAMING:
+        if (now - last_data_time > SK_TIMEOUT_DATA) {
+          Serial.println("[SignalK] Data timeout");
+          enterState(SK_STATE_SUBSCRIBED);
+        }
+        break;
+        
+      default:
+        break;
     }
   }
   
@@ -38,22 +312,42 @@ private:
     switch(type) {
       case WStype_DISCONNECTED:
         Serial.println("[SignalK] WebSocket disconnected");
-        connected = false;
+        Serial.printf("[SignalK] Frames accepted: %u, rejected: %u\n",
+                      filter.getAccepted(), filter.getRejected());
+        if (state > SK_STATE_WS_HANDSHAKE) {
+          enterState(SK_STATE_WS_HANDSHAKE);  // Library reconnects by itself
+        }
         break;
         
       case WStype_CONNECTED:
         Serial.println("[SignalK] WebSocket connected");
-        connected = true;
+        if (ever_connected) metrics.reconnects++;
+        ever_connected = true;
+        last_alive_time = millis();
+        idle_resubscribes = 0;
+        filter.resetSelf();
         subscribeToWindData();
+        enterState(SK_STATE_SUBSCRIBED);
+        break;
+        
+      case WStype_PONG:
+        last_alive_time = millis();
         break;
         
       case WStype_TEXT:
-        parseSignalKMessage((char*)payload);
+        last_alive_time = millis();
+        metrics.messages++;
+        metrics.bytes += length;
+        // Drop other vessels, notifications etc. before parsing
+        if (filter.accept((const char*)payload, length)) {
+          ts_cache_ptr = nullptr;  // Payload buffer may be reused
+          if (!parser.parse((const char*)payload, length)) metrics.parseErrors++;
+          publishPendingSample();
+        }
         break;
         
       case WStype_ERROR:
         Serial.println("[SignalK] WebSocket error");
-        connected = false;
         break;
         
       default:
@@ -63,145 +357,344 @@ private:
   
   void subscribeToWindData() {
     Serial.println("[SignalK] Subscribing to wind data");
-    StaticJsonDocument<512> doc;
+    StaticJsonDocument<1024> doc;
     doc["context"] = "vessels.self";
     
     JsonArray subscribe = doc.createNestedArray("subscribe");
     
-    JsonObject speed = subscribe.createNestedObject();
-    speed["path"] = "environment.wind.speedApparent";
-    speed["period"] = 1000;
-    
-    JsonObject angle = subscribe.createNestedObject();
-    angle["path"] = "environment.wind.angleApparent";
-    angle["period"] = 1000;
+    // One subscription per distinct path in the table
+    for (uint8_t i = 0; i < paths.size(); i++) {
+      if (paths.isDuplicatePath(i)) continue;
+      const SignalKPathEntry& e = paths.entry(i);
+      JsonObject sub = subscribe.createNestedObject();
+      sub["path"] = e.path;
+      sub["policy"] = signalKPolicyName(e.subscription.policy);
+      sub["period"] = e.subscription.period;
+      if (e.subscription.policy != SK_POLICY_FIXED && e.subscription.minPeriod) {
+        sub["minPeriod"] = e.subscription.minPeriod;
+      }
+    }
     
-    String json;
-    serializeJson(doc, json);
-    webSocket.sendTXT(json);
+    // A truncated subscription would be rejected or half applied
+    char json[SK_SUBSCRIBE_BUFFER];
+    size_t needed = measureJson(doc);
+    if (doc.overflowed() || needed >= sizeof(json)) {
+      subscribe_errors++;
+      Serial.printf("[SignalK] Subscribe message too long (%u bytes), not sent\n", (unsigned)needed);
+      return;
+    }
+    size_t length = serializeJson(doc, json, sizeof(json));
+    webSocket.sendTXT(json, length);
   }
   
-  void parseSignalKMessage(const char* payload) {
-    StaticJsonDocument<1024> doc;
-    DeserializationError error = deserializeJson(doc, payload);
+  static void onDeltaValue(void* context, const SignalKDeltaValue& value) {
+    SignalKWindDataSource* self = (SignalKWindDataSource*)context;
     
-    if (error) {
-      return;
+    // All values of one update share a timestamp span; parse it once
+    if (value.timestamp != self->ts_cache_ptr) {
+      self->ts_cache_ptr = value.timestamp;
+      self->ts_cache_ok = value.timestamp &&
+        signalKParseTimestamp(value.timestamp, value.timestampLength, self->ts_cache_value);
+    }
+    self->paths.dispatch(value);
+  }
+  
+  // Snapshot values only fill quantities no delta has updated since the
+  // request went out, and do not count as live data
+  static void onSnapshotValue(void* context, const SignalKDeltaValue& value) {
+    SignalKWindDataSource* self = (SignalKWindDataSource*)context;
+    SignalKPathEntry* e = self->paths.find(value);
+    if (!e) return;
+    uint32_t age = self->instruments.age(e->quantity, millis());
+    if (age <= millis() - self->snapshot.getStartTime()) return;
+    self->instruments.set(e->quantity, signalKConvert(e->conversion, value.value), millis());
+    if (e->quantity == IQ_APPARENT_WIND_SPEED || e->quantity == IQ_APPARENT_WIND_ANGLE) {
+      int64_t ms;
+      self->sample_pending = true;
+      self->sample_source_time = value.timestamp &&
+        signalKParseTimestamp(value.timestamp, value.timestampLength, ms) ? ms : 0;
     }
+  }
+  
+  static void onPathValue(void* context, InstrumentQuantity quantity, float value) {
+    SignalKWindDataSource* self = (SignalKWindDataSource*)context;
+    self->instruments.set(quantity, value, millis());
+    if (quantity == IQ_APPARENT_WIND_SPEED || quantity == IQ_APPARENT_WIND_ANGLE) {
+      self->last_data_time = millis();
+      self->sample_pending = true;
+      self->sample_source_time = self->ts_cache_ok ? self->ts_cache_value : 0;
+      if (self->ts_cache_ok) {
+        self->last_server_time = self->ts_cache_value;
+        if (self->ts_cache_value != self->last_recorded_time) {
+          self->recordServerLatency(self->ts_cache_value);
+          self->last_recorded_time = self->ts_cache_value;
+        }
+      }
+    }
+  }
+  
+  // One sample per frame that carried apparent wind, so speed and angle
+  // always come from the same update
+  void publishPendingSample() {
+    if (!sample_pending) return;
+    sample_pending = false;
     
-    if (!doc.containsKey("updates")) {
+    uint32_t now = millis();
+    WindSample sample = {};
+    sample.speed = instruments.get(IQ_APPARENT_WIND_SPEED);
+    sample.angle = instruments.get(IQ_APPARENT_WIND_ANGLE);
+    sample.sourceTime = sample_source_time;
+    sample.receivedMs = now;
+    if (instruments.age(IQ_APPARENT_WIND_SPEED, now) < SK_TIMEOUT_DATA) {
+      sample.valid |= WIND_SAMPLE_SPEED_VALID;
+    }
+    if (instruments.age(IQ_APPARENT_WIND_ANGLE, now) < SK_TIMEOUT_DATA) {
+      sample.valid |= WIND_SAMPLE_ANGLE_VALID;
+    }
+    publishSample(sample);
+  }
+  
+  // Wall clock in epoch ms, or 0 while SNTP has not synced
+  static int64_t wallClockMs() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    if (tv.tv_sec < 1700000000) return 0;
+    return (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+  }
+  
+  void recordServerLatency(int64_t serverMs) {
+    int64_t wall = wallClockMs();
+    if (wall) {
+      int64_t delay = wall - serverMs;
+      server_latency.record(delay > 0 ? (uint32_t)delay : 0);
       return;
     }
     
-    JsonArray updates = doc["updates"];
-    for (JsonObject update : updates) {
-      JsonArray values = update["values"];
-      for (JsonObject value : values) {
-        const char* path = value["path"];
-        
-        if (strcmp(path, "environment.wind.speedApparent") == 0) {
-          float val = value["value"];
-          wind_speed_ms = val;
-          last_data_time = millis();
-        }
-        else if (strcmp(path, "environment.wind.angleApparent") == 0) {
-          float val = value["value"];
-          // Signal K angle is in radians, convert to degrees
-          wind_angle = val * 180.0 / PI;
-          // Normalize to 0-360
-          while (wind_angle < 0) wind_angle += 360;
-          while (wind_angle >= 360) wind_angle -= 360;
-          last_data_time = millis();
-        }
+    // No wall clock: measure against the fastest delta in the window
+    unsigned long now = millis();
+    int64_t offset = (int64_t)now - serverMs;
+    if (!have_min_offset || offset < min_offset || now - offset_window_start > SK_OFFSET_WINDOW) {
+      if (!have_min_offset || now - offset_window_start > SK_OFFSET_WINDOW) {
+        offset_window_start = now;
       }
+      min_offset = offset;
+      have_min_offset = true;
     }
+    server_latency.record((uint32_t)(offset - min_offset));
   }
   
 public:
   SignalKWindDataSource(const char* wifi_ssid, const char* wifi_pass, 
                         const char* sk_host, uint16_t sk_port)
-    : ssid(wifi_ssid), password(wifi_pass), host(sk_host), port(sk_port),
-      wind_speed_ms(0), wind_angle(0), connected(false), wifi_connected(false),
-      last_data_time(0) {
-    instance = this;
+    : port(sk_port),
+      state(SK_STATE_IDLE), state_entered(0), last_data_time(0), last_alive_time(0),
+      idle_resubscribes(0), rate_window_start(0), wifi_event_id(0),
+      websocket_started(false), holds_wifi(false), ever_connected(false), subscribe_errors(0), last_server_time(0), last_recorded_time(0),
+      ts_cache_ptr(nullptr), ts_cache_value(0), ts_cache_ok(false), sample_pending(false),
+      sample_source_time(0), min_offset(0),
+      have_min_offset(false), offset_window_start(0), wifi_associated_event(false), wifi_got_ip_event(false),
+      wifi_lost_event(false) {
+    snprintf(ssid, sizeof(ssid), "%s", wifi_ssid ? wifi_ssid : "");
+    snprintf(password, sizeof(password), "%s", wifi_pass ? wifi_pass : "");
+    snprintf(host, sizeof(host), "%s", sk_host ? sk_host : "");
+    parser.setHandler(onDeltaValue, this);
+    snapshot.setHandler(onSnapshotValue, this);
+    snapshot.setPathPrefix(SK_SNAPSHOT_PATH);
+    paths.addAll(SIGNALK_DEFAULT_PATHS, SIGNALK_DEFAULT_PATH_COUNT, onPathValue, this);
+    for (uint8_t i = 0; i < paths.size(); i++) {
+      filter.addPathPrefix(paths.entry(i).path);
+    }
+    memset(rate_snapshot, 0, sizeof(rate_snapshot));
   }
   
   ~SignalKWindDataSource() {
-    Serial.println("[SignalK] Stopped");
-    webSocket.disconnect();
-    WiFi.disconnect();
+    if (state != SK_STATE_IDLE) {
+      stop();
+    }
   }
   
+  // Starts connecting and returns immediately; progress happens in update()
   bool begin() override {
-    Serial.printf("[SignalK] Connecting to WiFi '%s'...\n", ssid.c_str());
-    
-    // Connect to WiFi
-    WiFi.mode(WIFI_STA);
-    WiFi.begin(ssid.c_str(), password.c_str());
-    
-    // Wait up to 10 seconds for connection
-    int attempts = 0;
-    while (WiFi.status() != WL_CONNECTED && attempts < 20) {
-      delay(500);
-      attempts++;
+    if (!ssid[0]) {
+      Serial.println("[SignalK] No WiFi SSID configured");
+      return false;
     }
-    
-    if (WiFi.status() != WL_CONNECTED) {
-      Serial.println("[SignalK] WiFi connection failed");
+    if (!host[0] || port == 0) {
+      Serial.println("[SignalK] No server host/port configured");
       return false;
     }
     
-    wifi_connected = true;
-    Serial.printf("[SignalK] WiFi connected: %s\n", WiFi.localIP().toString().c_str());
-    
-    // Connect to Signal K WebSocket
-    webSocket.begin(host.c_str(), port, "/signalk/v1/stream?subscribe=none");
-    webSocket.onEvent(webSocketEvent);
-    webSocket.setReconnectInterval(5000);
-    
-    Serial.printf("[SignalK] Connecting to server %s:%d\n", host.c_str(), port);
-    
+    last_data_time = 0;
+    last_alive_time = 0;
+    idle_resubscribes = 0;
+    ever_connected = false;
+    rate_window_start = millis();
+    wifi_event_id = WiFi.onEvent([this](arduino_event_id_t event, arduino_event_info_t) {
+      handleWiFiEvent(event);
+    });
+    if (!holds_wifi) {
+      holds_wifi = true;
+      wifi_users++;
+    }
+    startWiFi();
     return true;
   }
   
   void update() override {
-    if (wifi_connected) {
+    if (state == SK_STATE_IDLE) return;
+    
+    if (websocket_started) {
       webSocket.loop();
-      
-      // Check for data timeout (no data for 10 seconds)
-      if (connected && last_data_time > 0 && (millis() - last_data_time > 10000)) {
-        Serial.println("[SignalK] Data timeout");
-        connected = false;
+    }
+    if (snapshot.isActive()) {
+      SignalKSnapshotState result = snapshot.poll(millis());
+      if (result == SK_SNAPSHOT_DONE) {
+        Serial.printf("[SignalK] Snapshot: %u values\n", snapshot.getValuesFound());
+        publishPendingSample();
+      } else if (result == SK_SNAPSHOT_FAILED) {
+        Serial.println("[SignalK] Snapshot failed");
       }
     }
+    stepStateMachine();
   }
   
+  // Streaming, or still connecting with fresh snapshot values
   bool isConnected() override {
-    return wifi_connected && connected && (millis() - last_data_time < 10000);
+    if (state == SK_STATE_STREAMING) return true;
+    if (state != SK_STATE_WS_HANDSHAKE && state != SK_STATE_SUBSCRIBED) return false;
+    return instruments.age(IQ_APPARENT_WIND_SPEED, millis()) < SK_TIMEOUT_DATA;
+  }
+  
+  SignalKConnectionState getState() {
+    return state;
+  }
+  
+  // Subscribed, and the server answered a ping or sent a frame recently
+  bool isAlive(unsigned long now) {
+    if (state != SK_STATE_SUBSCRIBED && state != SK_STATE_STREAMING) return false;
+    if (idle_resubscribes >= SK_IDLE_RESUBSCRIBES) return false;
+    return now - last_alive_time <= SK_ALIVE_WINDOW;
+  }
+  
+  // Deliver a WebSocket event as the library would (for tests, without
+  // a server)
+  void receiveEvent(WStype_t type, uint8_t* payload, size_t length) {
+    handleWebSocketEvent(type, payload, length);
+  }
+  
+  const char* getStatusText() override {
+    switch (state) {
+      case SK_STATE_WIFI_ASSOCIATING: return "WiFi...";
+      case SK_STATE_DHCP: return "DHCP...";
+      case SK_STATE_WS_HANDSHAKE: return "SK conn...";
+      case SK_STATE_SUBSCRIBED: return "SK wait";
+      case SK_STATE_STREAMING: return "SignalK";
+      case SK_STATE_BACKOFF: return "WiFi retry";
+      default: return "Off";
+    }
   }
   
   float getWindSpeed() override {
-    return wind_speed_ms;
+    return instruments.get(IQ_APPARENT_WIND_SPEED);
   }
   
   float getWindAngle() override {
-    return wind_angle;
+    return instruments.get(IQ_APPARENT_WIND_ANGLE);
+  }
+  
+  // Everything received from the subscribed paths
+  const InstrumentState& getInstrumentState() {
+    return instruments;
+  }
+  
+  // Apply per-path subscription settings (indexed like SIGNALK_DEFAULT_PATHS).
+  // Takes effect on the next subscribe.
+  void setSubscriptions(const SignalKSubscription* subs) {
+    for (uint8_t i = 0; i < SIGNALK_DEFAULT_PATH_COUNT; i++) {
+      paths.setSubscription(i, subs[i]);
+    }
+  }
+  
+  // millis() when wind data last arrived
+  unsigned long getLastDataTime() {
+    return last_data_time;
+  }
+  
+  // Epoch ms from the timestamp of the latest wind update (0 if none)
+  int64_t getLastServerTime() {
+    return last_server_time;
+  }
+  
+  // Subscribe messages not sent because they did not fit the buffer
+  uint32_t getSubscribeErrors() { return subscribe_errors; }
+  
+  // Server timestamp to parse latency
+  LatencyHistogram& getServerLatency() {
+    return server_latency;
+  }
+  
+  // True when latency is measured against SNTP rather than relative
+  bool isWallClockSynced() {
+    return wallClockMs() != 0;
+  }
+  
+  // Print delta arrival rate per path since the previous call
+  void printPathRates(Print& out) {
+    unsigned long now = millis();
+    float seconds = (now - rate_window_start) / 1000.0;
+    out.printf("[SignalK] Delta rates over %.1fs:\n", seconds);
+    if (subscribe_errors) {
+      out.printf("  subscribe messages not sent: %lu\n", (unsigned long)subscribe_errors);
+    }
+    for (uint8_t i = 0; i < paths.size(); i++) {
+      const SignalKPathEntry& e = paths.entry(i);
+      uint32_t n = e.received - rate_snapshot[i];
+      out.printf("  %-32s%s%-6s %6.2f Hz  (%s, min %u, period %u)\n",
+                 e.path, e.field ? "." : "", e.field ? e.field : "",
+                 seconds > 0 ? n / seconds : 0.0,
+                 signalKPolicyName(e.subscription.policy),
+                 e.subscription.minPeriod, e.subscription.period);
+      rate_snapshot[i] = e.received;
+    }
+    rate_window_start = now;
+  }
+  
+  // Register an extra path at run time (before begin())
+  bool addPath(const char* path, const char* field, InstrumentQuantity quantity,
+               SignalKConversion conversion) {
+    if (!paths.add(path, field, quantity, conversion, onPathValue, this)) {
+      return false;
+    }
+    filter.addPathPrefix(path);
+    return true;
   }
   
   const char* getSourceName() override {
     return "WiFi/Signal K";
   }
   
+  const char* getHost() {
+    return host;
+  }
+  
   void stop() override {
-    webSocket.disconnect();
-    WiFi.disconnect();
-    connected = false;
-    wifi_connected = false;
+    stopWebSocket();
+    if (wifi_event_id) {
+      WiFi.removeEvent(wifi_event_id);
+      wifi_event_id = 0;
+    }
+    if (holds_wifi) {
+      disconnectWiFi();
+      holds_wifi = false;
+      wifi_users--;
+    }
+    enterState(SK_STATE_IDLE);
     Serial.println("[SignalK] Stopped");
   }
 };
 
-// Initialize static instance pointer
-SignalKWindDataSource* SignalKWindDataSource::instance = nullptr;
+uint8_t SignalKWindDataSource::wifi_users = 0;
+bool SignalKWindDataSource::sntp_started = false;
+unsigned long SignalKWindDataSource::wifi_begun_at = 0;
 
 #endif // SIGNALK_WIND_DATA_SOURCE_H
@@ -0,0 +1,68 @@
+/*
+  SpscQueue.h - Fixed-capacity lock-free single-producer/single-consumer ring
+
+  One task pushes, one task pops; no locks, no allocation. head is only
+  written by the producer and tail only by the consumer, each published
+  with release ordering and read with acquire ordering, so an item is
+  fully written before the consumer can see it.
+
+  When the ring is full the new item is dropped and counted as an
+  overrun (the producer may not move tail). The producer also tracks the
+  deepest the queue has been, which shows how far the consumer lags.
+*/
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stdint.h>
+#include <atomic>
+
+template <typename T, uint32_t Capacity>
+class SpscQueue {
+  static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+private:
+  T items[Capacity];
+  std::atomic<uint32_t> head;   // Next slot to write (producer)
+  std::atomic<uint32_t> tail;   // Next slot to read (consumer)
+  std::atomic<uint32_t> overruns;
+  std::atomic<uint32_t> maxDepth;
+
+public:
+  SpscQueue() : head(0), tail(0), overruns(0), maxDepth(0) {}
+
+  // Producer side. Returns false (and counts an overrun) when full.
+  bool push(const T& item) {
+    uint32_t h = head.load(std::memory_order_relaxed);
+    uint32_t depth = h - tail.load(std::memory_order_acquire);
+    if (depth >= Capacity) {
+      overruns.store(overruns.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      return false;
+    }
+    items[h & (Capacity - 1)] = item;
+    head.store(h + 1, std::memory_order_release);
+    if (depth + 1 > maxDepth.load(std::memory_order_relaxed)) {
+      maxDepth.store(depth + 1, std::memory_order_relaxed);
+    }
+    return true;
+  }
+
+  // Consumer side. Returns false when empty.
+  bool pop(T& item) {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire)) return false;
+    item = items[t & (Capacity - 1)];
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  uint32_t depth() const {
+    return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+  }
+
+  uint32_t capacity() const { return Capacity; }
+  uint32_t getOverruns() const { return overruns.load(std::memory_order_relaxed); }
+  uint32_t getMaxDepth() const { return maxDepth.load(std::memory_order_relaxed); }
+};
+
+#endif // SPSC_QUEUE_H
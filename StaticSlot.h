@@ -0,0 +1,51 @@
+/*
+  StaticSlot.h - Statically reserved storage for one object
+
+  Data sources are rebuilt every time the configuration is saved. With
+  new/delete that churns the heap for the life of the device and, with
+  WiFi and LVGL allocating in between, slowly fragments it. A
+  StaticSlot<T> reserves sizeof(T) bytes up front (in .bss when the slot
+  is a global) and constructs the object there with placement new, so
+  rebuilding a source reuses the same memory every time.
+
+  create() destroys any previous object first; destroy() runs the
+  destructor and leaves the storage for the next create().
+*/
+
+#ifndef STATIC_SLOT_H
+#define STATIC_SLOT_H
+
+#include <stdint.h>
+#include <new>
+
+template <typename T>
+class StaticSlot {
+private:
+  alignas(T) uint8_t storage[sizeof(T)];
+  T* object;
+
+  StaticSlot(const StaticSlot&) = delete;
+  StaticSlot& operator=(const StaticSlot&) = delete;
+
+public:
+  StaticSlot() : object(nullptr) {}
+  ~StaticSlot() { destroy(); }
+
+  template <typename... Args>
+  T* create(Args... args) {
+    destroy();
+    object = new (storage) T(args...);
+    return object;
+  }
+
+  void destroy() {
+    if (object) {
+      object->~T();
+      object = nullptr;
+    }
+  }
+
+  T* get() const { return object; }
+};
+
+#endif // STATIC_SLOT_H
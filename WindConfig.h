@@ -8,6 +8,19 @@
 #define WIND_CONFIG_H
 
 #include <Preferences.h>
+#include "SignalKPathTable.h"
+#include "NMEA0183TalkerFilter.h"
+#include "NMEA0183Output.h"
+#include "WindSimulator.h"
+
+#ifndef SIGNALK_MAX_SERVERS
+#define SIGNALK_MAX_SERVERS 3   // Primary plus backups
+#endif
+
+struct SignalKServer {
+  char host[64];
+  uint16_t port;
+};
 
 enum WindUnits {
   UNITS_KNOTS,
@@ -19,6 +32,8 @@ enum WindUnits {
 struct WindConfiguration {
   // Connection settings
   DataSourceType dataSource;
+  DataSourceType backupSource;   // SOURCE_NONE = no backup
+  uint16_t sourceStaleMs;        // No data for this long switches to the backup
   
   // WiFi settings
   char wifiSSID[32];
@@ -28,12 +43,32 @@ struct WindConfiguration {
   char signalkHost[64];
   uint16_t signalkPort;
   
+  // Backup servers in failover order after the primary above; an empty
+  // host ends the list
+  SignalKServer signalkBackups[SIGNALK_MAX_SERVERS - 1];
+  
+  // Per-path subscription policy, indexed like SIGNALK_DEFAULT_PATHS
+  // (entries sharing a path use the first one)
+  SignalKSubscription signalkSubscriptions[SIGNALK_DEFAULT_PATH_COUNT];
+  
   // NMEA settings
   uint8_t nmeaRxPin;
   uint32_t nmeaBaudRate;
+  char nmeaTalkers[24];         // Talker priority, e.g. "WI,II"; empty = all equal
+  uint16_t nmeaEchoMs;          // Same sentence from another talker within this is dropped
+  NMEAOutputMode nmeaOutMode;   // Repeater output on the same UART
+  uint8_t nmeaTxPin;
+  uint8_t nmeaOutRateHz;        // Generated sentence sets per second
+  uint8_t nmeaOutSentences;     // NMEA_OUT_* bits
+  
+  // Demo (simulator) settings
+  uint16_t demoRateHz;          // Samples per second, up to 50
+  uint32_t demoSeed;            // Same seed, same wind
   
   // Display settings
   WindUnits units;
+  uint16_t displayCoalesceMs;   // Minimum ms between display redraws
+  bool recordSamples;           // Record samples to flash (WindRecorder)
   
   // Version for future compatibility
   uint8_t configVersion;
@@ -47,17 +82,37 @@ private:
   // Default values
   void setDefaults() {
     config.dataSource = SOURCE_DEMO;
+    config.backupSource = SOURCE_NONE;
+    config.sourceStaleMs = WIND_DEFAULT_STALE_MS;
     
     strcpy(config.wifiSSID, "");
     strcpy(config.wifiPassword, "");
     
     strcpy(config.signalkHost, "192.168.1.100");
     config.signalkPort = 3000;
+    for (int i = 0; i < SIGNALK_MAX_SERVERS - 1; i++) {
+      config.signalkBackups[i].host[0] = '\0';
+      config.signalkBackups[i].port = 3000;
+    }
+    for (size_t i = 0; i < SIGNALK_DEFAULT_PATH_COUNT; i++) {
+      config.signalkSubscriptions[i] = signalKDefaultSubscription(SIGNALK_DEFAULT_PATHS[i].quantity);
+    }
     
     config.nmeaRxPin = 10;
     config.nmeaBaudRate = 4800;
+    strcpy(config.nmeaTalkers, "WI,II");
+    config.nmeaEchoMs = NMEA_FILTER_ECHO_MS;
+    config.nmeaOutMode = NMEA_OUTPUT_OFF;
+    config.nmeaTxPin = 11;
+    config.nmeaOutRateHz = 2;
+    config.nmeaOutSentences = NMEA_OUT_MWV_R | NMEA_OUT_MWV_T;
+    
+    config.demoRateHz = 5;
+    config.demoSeed = 1;
     
     config.units = UNITS_KNOTS;
+    config.displayCoalesceMs = 100;
+    config.recordSamples = false;
     config.configVersion = 1;
   }
   
@@ -79,16 +134,49 @@ public:
     
     config.configVersion = prefs.getUChar("version", 1);
     config.dataSource = (DataSourceType)prefs.getUChar("dataSource", SOURCE_DEMO);
+    config.backupSource = (DataSourceType)prefs.getUChar("backupSource", SOURCE_NONE);
+    config.sourceStaleMs = prefs.getUShort("staleMs", WIND_DEFAULT_STALE_MS);
     config.units = (WindUnits)prefs.getUChar("units", UNITS_KNOTS);
+    config.displayCoalesceMs = prefs.getUShort("coalesceMs", 100);
+    config.recordSamples = prefs.getBool("record", false);
+    config.demoRateHz = prefs.getUShort("demoRate", 5);
+    if (config.demoRateHz < 1 || config.demoRateHz > WIND_SIM_MAX_RATE_HZ) config.demoRateHz = 5;
+    config.demoSeed = prefs.getUInt("demoSeed", 1);
     
     prefs.getString("wifiSSID", config.wifiSSID, sizeof(config.wifiSSID));
     prefs.getString("wifiPass", config.wifiPassword, sizeof(config.wifiPassword));
     
     prefs.getString("skHost", config.signalkHost, sizeof(config.signalkHost));
     config.signalkPort = prefs.getUShort("skPort", 3000);
+    for (int i = 0; i < SIGNALK_MAX_SERVERS - 1; i++) {
+      char key[10];
+      snprintf(key, sizeof(key), "skHost%d", i + 1);
+      prefs.getString(key, config.signalkBackups[i].host, sizeof(config.signalkBackups[i].host));
+      snprintf(key, sizeof(key), "skPort%d", i + 1);
+      config.signalkBackups[i].port = prefs.getUShort(key, 3000);
+    }
+    // Keep defaults if the path list changed size since the last save
+    if (prefs.getBytesLength("skSubs") == sizeof(config.signalkSubscriptions)) {
+      prefs.getBytes("skSubs", config.signalkSubscriptions, sizeof(config.signalkSubscriptions));
+      for (size_t i = 0; i < SIGNALK_DEFAULT_PATH_COUNT; i++) {
+        if (!signalKSubscriptionValid(config.signalkSubscriptions[i])) {
+          config.signalkSubscriptions[i] = signalKDefaultSubscription(SIGNALK_DEFAULT_PATHS[i].quantity);
+        }
+      }
+    }
     
     config.nmeaRxPin = prefs.getUChar("nmeaRx", 10);
     config.nmeaBaudRate = prefs.getUInt("nmeaBaud", 4800);
+    if (prefs.isKey("nmeaTalk")) {
+      prefs.getString("nmeaTalk", config.nmeaTalkers, sizeof(config.nmeaTalkers));
+    }
+    config.nmeaEchoMs = prefs.getUShort("nmeaEcho", NMEA_FILTER_ECHO_MS);
+    uint8_t nmeaOut = prefs.getUChar("nmeaOut", NMEA_OUTPUT_OFF);
+    config.nmeaOutMode = (NMEAOutputMode)(nmeaOut > (uint8_t)NMEA_OUTPUT_PASSTHROUGH ?
+                                          (uint8_t)NMEA_OUTPUT_PASSTHROUGH : nmeaOut);
+    config.nmeaTxPin = prefs.getUChar("nmeaTx", 11);
+    config.nmeaOutRateHz = prefs.getUChar("nmeaOutHz", 2);
+    config.nmeaOutSentences = prefs.getUChar("nmeaOutSet", NMEA_OUT_MWV_R | NMEA_OUT_MWV_T);
     
     prefs.end();
     return true;
@@ -102,16 +190,36 @@ public:
     
     prefs.putUChar("version", config.configVersion);
     prefs.putUChar("dataSource", config.dataSource);
+    prefs.putUChar("backupSource", config.backupSource);
+    prefs.putUShort("staleMs", config.sourceStaleMs);
     prefs.putUChar("units", config.units);
+    prefs.putUShort("coalesceMs", config.displayCoalesceMs);
+    prefs.putBool("record", config.recordSamples);
+    prefs.putUShort("demoRate", config.demoRateHz);
+    prefs.putUInt("demoSeed", config.demoSeed);
     
     prefs.putString("wifiSSID", config.wifiSSID);
     prefs.putString("wifiPass", config.wifiPassword);
     
     prefs.putString("skHost", config.signalkHost);
     prefs.putUShort("skPort", config.signalkPort);
+    for (int i = 0; i < SIGNALK_MAX_SERVERS - 1; i++) {
+      char key[10];
+      snprintf(key, sizeof(key), "skHost%d", i + 1);
+      prefs.putString(key, config.signalkBackups[i].host);
+      snprintf(key, sizeof(key), "skPort%d", i + 1);
+      prefs.putUShort(key, config.signalkBackups[i].port);
+    }
+    prefs.putBytes("skSubs", config.signalkSubscriptions, sizeof(config.signalkSubscriptions));
     
     prefs.putUChar("nmeaRx", config.nmeaRxPin);
     prefs.putUInt("nmeaBaud", config.nmeaBaudRate);
+    prefs.putString("nmeaTalk", config.nmeaTalkers);
+    prefs.putUShort("nmeaEcho", config.nmeaEchoMs);
+    prefs.putUChar("nmeaOut", config.nmeaOutMode);
+    prefs.putUChar("nmeaTx", config.nmeaTxPin);
+    prefs.putUChar("nmeaOutHz", config.nmeaOutRateHz);
+    prefs.putUChar("nmeaOutSet", config.nmeaOutSentences);
     
     prefs.end();
     return true;
@@ -131,23 +239,77 @@ public:
   // Getters
   WindConfiguration& get() { return config; }
   DataSourceType getDataSource() { return config.dataSource; }
+  DataSourceType getBackupSource() { return config.backupSource; }
+  uint16_t getSourceStaleMs() { return config.sourceStaleMs; }
   WindUnits getUnits() { return config.units; }
+  uint16_t getDisplayCoalesceMs() { return config.displayCoalesceMs; }
+  bool getRecordSamples() { return config.recordSamples; }
+  uint16_t getDemoRateHz() { return config.demoRateHz; }
+  uint32_t getDemoSeed() { return config.demoSeed; }
   const char* getWifiSSID() { return config.wifiSSID; }
   const char* getWifiPassword() { return config.wifiPassword; }
   const char* getSignalKHost() { return config.signalkHost; }
   uint16_t getSignalKPort() { return config.signalkPort; }
+  
+  // Servers in failover order: 0 is the primary, then the backups
+  uint8_t getSignalKServerCount() {
+    uint8_t n = 1;
+    while (n < SIGNALK_MAX_SERVERS && config.signalkBackups[n - 1].host[0]) n++;
+    return n;
+  }
+  const char* getSignalKHost(uint8_t i) {
+    return i == 0 ? config.signalkHost : config.signalkBackups[i - 1].host;
+  }
+  uint16_t getSignalKPort(uint8_t i) {
+    return i == 0 ? config.signalkPort : config.signalkBackups[i - 1].port;
+  }
+  const SignalKSubscription* getSignalKSubscriptions() { return config.signalkSubscriptions; }
   uint8_t getNMEARxPin() { return config.nmeaRxPin; }
   uint32_t getNMEABaudRate() { return config.nmeaBaudRate; }
+  const char* getNMEATalkerPriority() { return config.nmeaTalkers; }
+  uint16_t getNMEAEchoMs() { return config.nmeaEchoMs; }
+  NMEAOutputMode getNMEAOutputMode() { return config.nmeaOutMode; }
+  uint8_t getNMEATxPin() { return config.nmeaTxPin; }
+  uint8_t getNMEAOutputRateHz() { return config.nmeaOutRateHz; }
+  uint8_t getNMEAOutputSentences() { return config.nmeaOutSentences; }
   
   // Setters
   void setDataSource(DataSourceType source) { config.dataSource = source; }
+  void setBackupSource(DataSourceType source) { config.backupSource = source; }
+  void setSourceStaleMs(uint16_t ms) { config.sourceStaleMs = ms; }
   void setUnits(WindUnits u) { config.units = u; }
+  void setDisplayCoalesceMs(uint16_t ms) { config.displayCoalesceMs = ms; }
+  void setRecordSamples(bool record) { config.recordSamples = record; }
+  void setDemoRateHz(uint16_t hz) {
+    config.demoRateHz = hz < 1 ? 1 : hz > WIND_SIM_MAX_RATE_HZ ? WIND_SIM_MAX_RATE_HZ : hz;
+  }
+  void setDemoSeed(uint32_t seed) { config.demoSeed = seed; }
   void setWifiSSID(const char* ssid) { strncpy(config.wifiSSID, ssid, sizeof(config.wifiSSID) - 1); }
   void setWifiPassword(const char* pass) { strncpy(config.wifiPassword, pass, sizeof(config.wifiPassword) - 1); }
   void setSignalKHost(const char* host) { strncpy(config.signalkHost, host, sizeof(config.signalkHost) - 1); }
   void setSignalKPort(uint16_t port) { config.signalkPort = port; }
+  void setSignalKBackup(uint8_t i, const char* host, uint16_t port) {
+    if (i >= SIGNALK_MAX_SERVERS - 1) return;
+    strncpy(config.signalkBackups[i].host, host, sizeof(config.signalkBackups[i].host) - 1);
+    config.signalkBackups[i].port = port;
+  }
+  // Rejects (returns false) a minPeriod above the period or an out of range value
+  bool setSignalKSubscription(size_t i, const SignalKSubscription& sub) {
+    if (i >= SIGNALK_DEFAULT_PATH_COUNT || !signalKSubscriptionValid(sub)) return false;
+    config.signalkSubscriptions[i] = sub;
+    return true;
+  }
   void setNMEARxPin(uint8_t pin) { config.nmeaRxPin = pin; }
   void setNMEABaudRate(uint32_t baud) { config.nmeaBaudRate = baud; }
+  void setNMEATalkerPriority(const char* talkers) {
+    strncpy(config.nmeaTalkers, talkers, sizeof(config.nmeaTalkers) - 1);
+    config.nmeaTalkers[sizeof(config.nmeaTalkers) - 1] = '\0';
+  }
+  void setNMEAEchoMs(uint16_t ms) { config.nmeaEchoMs = ms; }
+  void setNMEAOutputMode(NMEAOutputMode mode) { config.nmeaOutMode = mode; }
+  void setNMEATxPin(uint8_t pin) { config.nmeaTxPin = pin; }
+  void setNMEAOutputRateHz(uint8_t hz) { config.nmeaOutRateHz = hz; }
+  void setNMEAOutputSentences(uint8_t mask) { config.nmeaOutSentences = mask; }
   
   // Unit conversion helpers
   float convertSpeed(float speed_ms) {
@@ -3,12 +3,37 @@
   
   All wind data sources (Demo, WiFi/Signal K, NMEA, BLE, NMEA2000, etc.)
   must implement this interface.
+  
+  Sources publish each new reading as a WindSample (speed and angle from
+  the same update, timestamped). getLatestSample() hands out the newest
+  one as a single copy; getHistory() exposes the recent ones in place.
+  Subscribers are called with each sample as it is published, from
+  whatever context calls update().
+  
+  Each source keeps a WindSourceMetrics. Samples are counted here;
+  sources add their own message, byte, error and reconnect counts.
 */
 
 #ifndef WIND_DATA_SOURCE_H
 #define WIND_DATA_SOURCE_H
 
+#include "WindSample.h"
+#include "WindSourceMetrics.h"
+
 class WindDataSource {
+protected:
+  WindSampleRing history;
+  WindSampleSubscribers subscribers;
+  WindSourceMetrics metrics;
+  
+  // Record a new reading, assign its sequence number and push it to
+  // the subscribers
+  void publishSample(const WindSample& sample) {
+    history.push(sample);
+    metrics.recordSample(millis());
+    subscribers.notify(history.latest());
+  }
+  
 public:
   virtual ~WindDataSource() {}
   
@@ -30,8 +55,35 @@ public:
   // Get human-readable source name
   virtual const char* getSourceName() = 0;
   
+  // Short connection status for the status label
+  virtual const char* getStatusText() { return getSourceName(); }
+  
   // Clean shutdown
   virtual void stop() = 0;
+  
+  // Newest published sample (sequence 0 if none yet)
+  WindSample getLatestSample() {
+    return history.latest();
+  }
+  
+  // Recent samples, newest first via at(0)
+  const WindSampleRing& getHistory() {
+    return history;
+  }
+  
+  // Health and throughput counters
+  WindSourceMetrics& getMetrics() {
+    return metrics;
+  }
+  
+  // Be called with every new sample
+  bool subscribe(WindSampleCallback callback, void* context) {
+    return subscribers.add(callback, context);
+  }
+  
+  void unsubscribe(WindSampleCallback callback, void* context) {
+    subscribers.remove(callback, context);
+  }
 };
 
 #endif // WIND_DATA_SOURCE_H
@@ -2,6 +2,35 @@
   WindDataSourceManager.h - Manages switching between wind data sources
   
   Handles initialization, cleanup, and switching between different data sources.
+  
+  Sources are held in priority order (primary first, then backups) and
+  all of them run at once. The display is fed by the first source that
+  has published a sample within the staleness budget. When the active
+  source goes quiet for longer than that, the next fresh one takes over
+  at its next sample; a higher-priority source has to keep delivering
+  for WIND_FAILBACK_HOLD before it takes over again.
+  
+  Samples from the active source are forwarded to the manager's own
+  subscribers, so they stay subscribed across source switches. Raw
+  subscribers (e.g. the recorder) get every one of them; for the rest bursts
+  are coalesced: the first sample after a quiet period goes out at
+  once, later ones within the coalescing window are held and only the
+  newest is delivered when the window closes.
+  
+  switchSource() is break-before-make: the old sources stop before the
+  new one begins. beginSwitch() is make-before-break: the new sources
+  start in a second bank while the old ones keep feeding the display,
+  and the banks are swapped inside the callback that carries the first
+  valid sample from the new primary. A new backup only cuts over if no
+  current source is fresh any more, so one that delivers at once (e.g.
+  demo) does not end the switch before the primary has connected. If a
+  new source fails to begin, or
+  none delivers within the switch timeout, the new bank is stopped
+  instead and the old sources carry on. Either way the stopped sources
+  are handed to the retire callback so their owner can free them.
+  
+  update() times each source's update() into its WindSourceMetrics;
+  printMetrics() reports them for every running source.
 */
 
 #ifndef WIND_DATA_SOURCE_MANAGER_H
@@ -9,48 +38,331 @@
 
 #include "WindDataSource.h"
 
+#define WIND_MAX_SOURCES      3      // Primary plus backups
+#define WIND_DEFAULT_STALE_MS 3000   // ms without a sample before a source is stale
+#define WIND_FAILBACK_HOLD    5000   // ms a higher-priority source must deliver before switching back
+#define WIND_SWITCH_TIMEOUT   30000  // ms a make-before-break switch waits for the new source
+
 enum DataSourceType {
   SOURCE_DEMO,
   SOURCE_WIFI_SIGNALK,
   SOURCE_NMEA,
   SOURCE_BLE,
-  SOURCE_NMEA2000
+  SOURCE_NMEA2000,
+  SOURCE_NONE,           // No backup configured
+  SOURCE_REPLAY          // Playing back a recording
+};
+
+class WindDataSourceManager;
+
+// Sources the manager has stopped and no longer references
+typedef void (*WindSourceRetireCallback)(void* context, WindDataSource* source);
+
+struct WindSourceSlot {
+  WindDataSourceManager* manager;
+  WindDataSource* source;
+  DataSourceType type;
+  unsigned long lastSample;   // millis() of the newest sample, 0 = none yet
+  unsigned long freshSince;   // millis() since it has been delivering, 0 = stale
 };
 
 class WindDataSourceManager {
 private:
-  WindDataSource* currentSource;
+  WindSourceSlot banks[2][WIND_MAX_SOURCES];
+  WindSourceSlot* slots;        // Bank feeding the display
+  WindSourceSlot* incoming;     // Bank being started by beginSwitch()
+  uint8_t sourceCount;
+  uint8_t incomingCount;
+  DataSourceType incomingType;
+  unsigned long switchStarted;
+  uint16_t switchTimeout;       // ms
+  uint32_t switchesCompleted;
+  uint32_t switchesAbandoned;
+  WindSourceRetireCallback retireCallback;
+  void* retireContext;
+  uint8_t active;
   DataSourceType currentType;
+  uint16_t staleBudget;         // ms
+  uint16_t failbackHold;        // ms
+  uint32_t sourceSwitches;
   
-public:
-  WindDataSourceManager() : currentSource(nullptr), currentType(SOURCE_DEMO) {}
+  WindSampleSubscribers subscribers;
+  WindSampleSubscribers rawSubscribers;
+  uint16_t coalesceWindow;      // ms, 0 = deliver every sample
+  WindSample pendingSample;
+  bool samplePending;
+  unsigned long lastDelivery;
+  uint32_t samplesReceived;
+  uint32_t samplesDelivered;
   
-  // Switch to a new data source
-  bool switchSource(WindDataSource* newSource, DataSourceType type) {
-    // Stop current source (but don't delete it)
-    if (currentSource) {
-      currentSource->stop();
+  static void onSourceSample(void* context, const WindSample& sample) {
+    WindSourceSlot* slot = (WindSourceSlot*)context;
+    WindDataSourceManager* self = slot->manager;
+    unsigned long now = millis();
+    slot->lastSample = now ? now : 1;
+    if (!slot->freshSince) slot->freshSince = slot->lastSample;
+    
+    // First valid sample from the incoming primary (or from a backup
+    // when the current sources went stale): cut over to it
+    if (self->incomingCount && slot >= self->incoming && slot < self->incoming + WIND_MAX_SOURCES) {
+      if (!sample.hasSpeed() && !sample.hasAngle()) return;
+      uint8_t first = slot - self->incoming;
+      if (first > 0 && self->anyFresh(now)) return;
+      self->cutOver(first);
     }
+    self->selectActive(now);
+    if (slot != &self->slots[self->active]) return;
     
-    // Start new source
-    currentSource = newSource;
-    currentType = type;
+    self->rawSubscribers.notify(sample);
+    self->pendingSample = sample;
+    self->samplePending = true;
+    self->samplesReceived++;
+    self->deliverIfDue();
+  }
+  
+  // Unsubscribe, stop and hand over one bank's sources
+  void retireBank(WindSourceSlot* bank, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+      bank[i].source->unsubscribe(onSourceSample, &bank[i]);
+      bank[i].source->stop();
+      if (retireCallback) retireCallback(retireContext, bank[i].source);
+    }
+  }
+  
+  void cutOver(uint8_t first) {
+    Serial.printf("[Sources] %s -> %s (switched after %lu ms)\n",
+                  sourceCount ? getTypeName(slots[active].type) : "None",
+                  getTypeName(incoming[first].type), millis() - switchStarted);
+    retireBank(slots, sourceCount);
+    WindSourceSlot* old = slots;
+    slots = incoming;
+    incoming = old;
+    sourceCount = incomingCount;
+    incomingCount = 0;
+    active = first;
+    currentType = slots[first].type;
+    samplePending = false;
+    switchesCompleted++;
+  }
+  
+  // Start a source in a bank; false if it did not begin
+  bool startSlot(WindSourceSlot& slot, WindDataSource* source, DataSourceType type) {
+    slot.manager = this;
+    slot.source = source;
+    slot.type = type;
+    slot.lastSample = 0;
+    slot.freshSince = 0;
+    source->subscribe(onSourceSample, &slot);
+    if (!source->begin()) {
+      source->unsubscribe(onSourceSample, &slot);
+      return false;
+    }
+    return true;
+  }
+  
+  bool isFresh(uint8_t i, unsigned long now) {
+    return slots[i].lastSample && now - slots[i].lastSample <= staleBudget;
+  }
+  
+  bool anyFresh(unsigned long now) {
+    for (uint8_t i = 0; i < sourceCount; i++) {
+      if (isFresh(i, now)) return true;
+    }
+    return false;
+  }
+  
+  void activate(uint8_t i, const char* reason) {
+    Serial.printf("[Sources] %s -> %s (%s)\n",
+                  getTypeName(slots[active].type), getTypeName(slots[i].type), reason);
+    active = i;
+    currentType = slots[i].type;
+    samplePending = false;
+    sourceSwitches++;
+  }
+  
+  void selectActive(unsigned long now) {
+    if (sourceCount < 2) return;
+    for (uint8_t i = 0; i < sourceCount; i++) {
+      if (!isFresh(i, now)) slots[i].freshSince = 0;
+    }
     
-    if (currentSource) {
-      bool success = currentSource->begin();
-      if (!success) {
-        currentSource = nullptr;
-        return false;
+    // Active source went quiet: first fresh one in priority order
+    if (!slots[active].freshSince) {
+      for (uint8_t i = 0; i < sourceCount; i++) {
+        if (i != active && slots[i].freshSince) {
+          activate(i, "stale");
+          return;
+        }
       }
-      return true;
+      return;
     }
     
-    return false;
+    // Return to a higher-priority source once it has settled
+    for (uint8_t i = 0; i < active; i++) {
+      if (slots[i].freshSince && now - slots[i].freshSince >= failbackHold) {
+        activate(i, "failback");
+        return;
+      }
+    }
   }
   
-  // Get current source
+  void deliverIfDue() {
+    if (!samplePending) return;
+    unsigned long now = millis();
+    if (coalesceWindow && samplesDelivered && now - lastDelivery < coalesceWindow) return;
+    samplePending = false;
+    lastDelivery = now;
+    samplesDelivered++;
+    subscribers.notify(pendingSample);
+  }
+  
+public:
+  WindDataSourceManager()
+    : slots(banks[0]), incoming(banks[1]), sourceCount(0), incomingCount(0),
+      incomingType(SOURCE_NONE), switchStarted(0), switchTimeout(WIND_SWITCH_TIMEOUT),
+      switchesCompleted(0), switchesAbandoned(0), retireCallback(nullptr), retireContext(nullptr),
+      active(0), currentType(SOURCE_DEMO), staleBudget(WIND_DEFAULT_STALE_MS),
+      failbackHold(WIND_FAILBACK_HOLD), sourceSwitches(0), coalesceWindow(0),
+      samplePending(false), lastDelivery(0), samplesReceived(0), samplesDelivered(0) {}
+  
+  // Replace all sources with a single one (nullptr just stops them).
+  // Break-before-make: the display has no data until it delivers.
+  bool switchSource(WindDataSource* newSource, DataSourceType type) {
+    // Stop current sources (but don't delete them)
+    cancelSwitch();
+    retireBank(slots, sourceCount);
+    sourceCount = 0;
+    active = 0;
+    samplePending = false;
+    currentType = type;
+    
+    // Start new source
+    return newSource && addSource(newSource, type);
+  }
+  
+  // Start new sources in the background and keep the current ones on
+  // the display until one of them delivers a valid sample. With nothing
+  // running yet this is the same as switchSource(). Returns false, and
+  // leaves the current sources running, if the source does not begin.
+  bool beginSwitch(WindDataSource* newSource, DataSourceType type) {
+    if (!sourceCount) return switchSource(newSource, type);
+    cancelSwitch();
+    if (!newSource || !startSlot(incoming[0], newSource, type)) {
+      Serial.printf("[Sources] %s did not start, keeping %s\n",
+                    getTypeName(type), getTypeName(slots[active].type));
+      switchesAbandoned++;
+      return false;
+    }
+    incomingCount = 1;
+    incomingType = type;
+    switchStarted = millis();
+    Serial.printf("[Sources] Starting %s, %s stays on until it delivers\n",
+                  getTypeName(type), getTypeName(slots[active].type));
+    return true;
+  }
+  
+  // Stop the sources of an unfinished beginSwitch(); the current ones
+  // carry on
+  void cancelSwitch() {
+    if (!incomingCount) return;
+    retireBank(incoming, incomingCount);
+    incomingCount = 0;
+    switchesAbandoned++;
+  }
+  
+  // Add and start a backup, after the sources already added. During a
+  // beginSwitch() it joins the incoming sources.
+  bool addSource(WindDataSource* source, DataSourceType type) {
+    WindSourceSlot* bank = incomingCount ? incoming : slots;
+    uint8_t& count = incomingCount ? incomingCount : sourceCount;
+    if (!source || count >= WIND_MAX_SOURCES) return false;
+    if (!startSlot(bank[count], source, type)) return false;
+    if (bank == slots && count == 0) currentType = type;
+    count++;
+    return true;
+  }
+  
+  // Be told about each source the manager stops, once it holds no
+  // reference to it any more (called from update() during a switch)
+  void setRetireCallback(WindSourceRetireCallback callback, void* context) {
+    retireCallback = callback;
+    retireContext = context;
+  }
+  
+  // How long beginSwitch() waits for a valid sample before giving up
+  void setSwitchTimeout(uint16_t ms) { switchTimeout = ms; }
+  bool isSwitching() { return incomingCount > 0; }
+  DataSourceType getIncomingType() { return incomingType; }
+  uint32_t getSwitchesCompleted() { return switchesCompleted; }
+  uint32_t getSwitchesAbandoned() { return switchesAbandoned; }
+  
+  // How long a source may go without a sample before a backup takes over
+  void setStaleBudget(uint16_t ms) { staleBudget = ms; }
+  uint16_t getStaleBudget() { return staleBudget; }
+  void setFailbackHold(uint16_t ms) { failbackHold = ms; }
+  
+  // Be called with samples from whichever source is current
+  bool subscribe(WindSampleCallback callback, void* context) {
+    return subscribers.add(callback, context);
+  }
+  
+  void unsubscribe(WindSampleCallback callback, void* context) {
+    subscribers.remove(callback, context);
+  }
+  
+  // Be called with every sample from the current source, before coalescing
+  bool subscribeRaw(WindSampleCallback callback, void* context) {
+    return rawSubscribers.add(callback, context);
+  }
+  
+  void unsubscribeRaw(WindSampleCallback callback, void* context) {
+    rawSubscribers.remove(callback, context);
+  }
+  
+  // Minimum ms between deliveries; the newest sample wins
+  void setCoalesceWindow(uint16_t ms) {
+    coalesceWindow = ms;
+  }
+  
+  uint32_t getSamplesReceived() { return samplesReceived; }
+  uint32_t getSamplesDelivered() { return samplesDelivered; }
+  
+  // Get the source currently feeding the display
   WindDataSource* getCurrentSource() {
-    return currentSource;
+    return sourceCount ? slots[active].source : nullptr;
+  }
+  
+  uint8_t getSourceCount() { return sourceCount; }
+  DataSourceType getSourceType(uint8_t i) { return i < sourceCount ? slots[i].type : SOURCE_NONE; }
+  uint8_t getActiveIndex() { return active; }
+  bool isOnBackup() { return active > 0; }
+  uint32_t getSourceSwitches() { return sourceSwitches; }
+  
+  WindDataSource* getSource(uint8_t i) {
+    return i < sourceCount ? slots[i].source : nullptr;
+  }
+  
+  // Counters of the i-th running source (nullptr past the end)
+  const WindSourceMetrics* getMetrics(uint8_t i) {
+    return i < sourceCount ? &slots[i].source->getMetrics() : nullptr;
+  }
+  
+  template <class Output>
+  void printMetrics(Output& out) {
+    unsigned long now = millis();
+    out.printf("[Sources] Metrics (%lu switches):\n", (unsigned long)sourceSwitches);
+    for (uint8_t i = 0; i < sourceCount; i++) {
+      char name[32];
+      snprintf(name, sizeof(name), "%u %s%s", i, getTypeName(slots[i].type),
+               i == active ? " (active)" : "");
+      slots[i].source->getMetrics().print(out, name, now);
+    }
+  }
+  
+  void resetMetrics() {
+    for (uint8_t i = 0; i < sourceCount; i++) {
+      slots[i].source->getMetrics().reset();
+    }
   }
   
   // Get current source type
@@ -66,20 +378,40 @@ public:
       case SOURCE_NMEA: return "NMEA 0183";
       case SOURCE_BLE: return "Bluetooth LE";
       case SOURCE_NMEA2000: return "NMEA 2000";
+      case SOURCE_NONE: return "None";
+      case SOURCE_REPLAY: return "Replay";
       default: return "Unknown";
     }
   }
   
-  // Update current source
+  // Update all sources, pick the active one and release a held sample
+  // once its window closes
   void update() {
-    if (currentSource) {
-      currentSource->update();
+    for (uint8_t i = 0; i < sourceCount; i++) {
+      unsigned long start = micros();
+      slots[i].source->update();
+      slots[i].source->getMetrics().recordUpdate(micros() - start);
+    }
+    // Incoming sources may cut over from inside their update()
+    for (uint8_t i = 0; i < incomingCount; i++) {
+      unsigned long start = micros();
+      WindDataSource* source = incoming[i].source;
+      source->update();
+      source->getMetrics().recordUpdate(micros() - start);
+    }
+    if (incomingCount && millis() - switchStarted > switchTimeout) {
+      Serial.printf("[Sources] %s delivered nothing in %u ms, keeping %s\n",
+                    getTypeName(incomingType), switchTimeout, getTypeName(slots[active].type));
+      cancelSwitch();
     }
+    selectActive(millis());
+    deliverIfDue();
   }
   
   // Check if connected
   bool isConnected() {
-    return currentSource && currentSource->isConnected();
+    WindDataSource* source = getCurrentSource();
+    return source && source->isConnected();
   }
 };
 
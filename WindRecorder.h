@@ -0,0 +1,169 @@
+/*
+  WindRecorder.h - Appends every active-source sample to LittleFS
+
+  Subscribes to the manager's raw (uncoalesced) samples and encodes them
+  with WindRecordCodec into a RAM buffer, which is written to
+  WIND_RECORD_FILE when it fills up or WIND_RECORD_FLUSH_MS after the
+  last write. Every start() appends a new segment, so recordings from
+  several boots end up in one file. When the file passes
+  WIND_RECORD_MAX_FILE it is renamed to WIND_RECORD_OLD_FILE and a new
+  one is started, so at most two files' worth of flash is used.
+
+  Samples arrive on whatever task runs the sources and only go into a
+  lock-free queue there; update() encodes and writes them from loop(),
+  so a slow flash write never stalls a source. Samples that arrive while
+  the queue is full are dropped and counted. start() and stop() run with
+  the sources locked.
+
+  If the file cannot be reopened after a rotation, writing stops and
+  update() returns false; the caller then stops the recorder.
+*/
+
+#ifndef WIND_RECORDER_H
+#define WIND_RECORDER_H
+
+#include <LittleFS.h>
+#include "WindDataSourceManager.h"
+#include "WindRecordingFormat.h"
+#include "SpscQueue.h"
+
+#define WIND_RECORD_FILE      "/wind.rec"
+#define WIND_RECORD_OLD_FILE  "/wind.old"
+#define WIND_RECORD_BUFFER    512       // Bytes held in RAM between writes
+#define WIND_RECORD_FLUSH_MS  5000      // Longest time a sample waits in RAM
+#define WIND_RECORD_MAX_FILE  262144    // Rotate after this many bytes
+#define WIND_RECORD_QUEUE     32        // Samples waiting for loop(), power of two
+
+class WindRecorder {
+private:
+  WindDataSourceManager* manager;
+  File file;
+  WindRecordCodec codec;
+  SpscQueue<WindSample, WIND_RECORD_QUEUE> queue;   // Source task -> update()
+  uint8_t buffer[WIND_RECORD_BUFFER];
+  size_t used;
+  unsigned long last_flush;
+  bool recording;
+  volatile bool writing;     // Cleared on a file error; samples are dropped
+  uint32_t samples;
+  uint32_t write_errors;
+  uint32_t open_errors;
+
+  static void onSample(void* context, const WindSample& sample) {
+    WindRecorder* self = (WindRecorder*)context;
+    if (self->writing) self->queue.push(sample);
+  }
+
+  bool openSegment() {
+    file = LittleFS.open(WIND_RECORD_FILE, FILE_APPEND);
+    if (!file) {
+      Serial.println("[Recorder] Cannot open " WIND_RECORD_FILE);
+      return false;
+    }
+    used = codec.writeHeader(buffer);
+    return true;
+  }
+
+  void flush() {
+    if (!file) {
+      used = 0;
+      return;
+    }
+    if (!used) return;
+    if (file.write(buffer, used) != used) write_errors++;
+    file.flush();
+    used = 0;
+    last_flush = millis();
+
+    if (file.size() >= WIND_RECORD_MAX_FILE) {
+      file.close();
+      LittleFS.remove(WIND_RECORD_OLD_FILE);
+      LittleFS.rename(WIND_RECORD_FILE, WIND_RECORD_OLD_FILE);
+      Serial.println("[Recorder] Rotated " WIND_RECORD_FILE);
+      if (!openSegment()) {
+        open_errors++;
+        writing = false;
+        used = 0;
+        Serial.println("[Recorder] Stopped writing after a failed rotation");
+      }
+    }
+  }
+
+  void record(const WindSample& sample) {
+    if (!file) return;
+    if (used + WIND_RECORD_MAX_SIZE > WIND_RECORD_BUFFER) flush();
+    if (!file) return;
+    used += codec.encode(sample, buffer + used);
+    samples++;
+  }
+
+  // Write everything queued so far
+  void drain() {
+    WindSample sample;
+    while (queue.pop(sample)) {
+      if (writing) record(sample);
+    }
+  }
+
+public:
+  WindRecorder()
+    : manager(nullptr), used(0), last_flush(0), recording(false), writing(false), samples(0),
+      write_errors(0), open_errors(0) {}
+
+  bool start(WindDataSourceManager* mgr) {
+    if (recording) return true;
+    if (!LittleFS.begin(true)) {
+      Serial.println("[Recorder] LittleFS mount failed");
+      return false;
+    }
+    if (!openSegment()) {
+      open_errors++;
+      return false;
+    }
+    WindSample stale;
+    while (queue.pop(stale)) {}
+    manager = mgr;
+    writing = true;
+    manager->subscribeRaw(onSample, this);
+    last_flush = millis();
+    recording = true;
+    Serial.println("[Recorder] Recording to " WIND_RECORD_FILE);
+    return true;
+  }
+
+  void stop() {
+    if (!recording) return;
+    manager->unsubscribeRaw(onSample, this);
+    drain();
+    flush();
+    file.close();
+    writing = false;
+    recording = false;
+    Serial.printf("[Recorder] Stopped, %lu samples, %lu dropped\n", (unsigned long)samples,
+                  (unsigned long)queue.getOverruns());
+  }
+
+  // Encode and write queued samples; call from loop() without the source
+  // lock. Returns false if writing stopped on a file error: call stop()
+  // then, with the sources locked.
+  bool update() {
+    if (!recording) return true;
+    drain();
+    if (writing && millis() - last_flush >= WIND_RECORD_FLUSH_MS) flush();
+    return writing;
+  }
+
+  bool isRecording() { return recording; }
+  uint32_t getSamples() { return samples; }
+  uint32_t getDropped() { return queue.getOverruns(); }
+  uint32_t getWriteErrors() { return write_errors; }
+  uint32_t getOpenErrors() { return open_errors; }
+  size_t getFileSize() { return file ? file.size() + used : 0; }
+};
+
+// Read callback for ReplayWindDataSource over a LittleFS file
+inline size_t windRecordFileRead(void* context, uint8_t* buffer, size_t length) {
+  return ((File*)context)->read(buffer, length);
+}
+
+#endif // WIND_RECORDER_H
@@ -0,0 +1,207 @@
+/*
+  WindRecordingFormat.h - Compact binary encoding of WindSample streams
+
+  Used by WindRecorder on the device and ReplayWindDataSource on both the
+  device and the desktop. Plain C++, no Arduino dependencies.
+
+  A recording is one or more segments. Each segment is an 8-byte header
+  ("WREC", version, 3 reserved bytes) followed by records, and starts
+  the delta state from zero, so a new segment can simply be appended
+  after a reboot.
+
+  Record:
+    flags       1 byte   WIND_SAMPLE_* valid bits, WIND_RECORD_HAS_SOURCE_TIME
+    dt          varint   receivedMs - previous receivedMs
+    speed       zigzag   delta in cm/s          (if speed valid)
+    angle       zigzag   delta in 0.1 degrees, shortest way round (if angle valid)
+    sourceTime  zigzag   delta in ms            (if WIND_RECORD_HAS_SOURCE_TIME)
+
+  Only apparent wind is recorded; true wind fields are left out.
+  A steady 10 Hz stream costs about 5 bytes per sample. Speed and angle
+  are quantized to 0.01 m/s and 0.1 degrees; decoding is exact and
+  deterministic from there on.
+*/
+
+#ifndef WIND_RECORDING_FORMAT_H
+#define WIND_RECORDING_FORMAT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "WindSample.h"
+
+#define WIND_RECORD_MAGIC           "WREC"
+#define WIND_RECORD_VERSION         1
+#define WIND_RECORD_HEADER_SIZE     8
+#define WIND_RECORD_MAX_SIZE        32     // Longest possible record
+
+#define WIND_RECORD_HAS_SOURCE_TIME 0x80
+#define WIND_RECORD_FLAG_MASK       (WIND_SAMPLE_SPEED_VALID | WIND_SAMPLE_ANGLE_VALID | WIND_RECORD_HAS_SOURCE_TIME)
+
+enum WindRecordResult {
+  WIND_RECORD_SAMPLE,      // A sample was decoded
+  WIND_RECORD_SEGMENT,     // A segment header was read, state reset
+  WIND_RECORD_NEED_MORE,   // Record continues past the end of the data
+  WIND_RECORD_CORRUPT      // Unknown flags, version or overlong varint
+};
+
+class WindRecordCodec {
+private:
+  uint32_t prev_received;
+  int32_t prev_speed;      // cm/s
+  int32_t prev_angle;      // 0.1 degrees, 0-3599
+  int64_t prev_source;
+
+  static uint8_t putVarint(uint8_t* out, uint64_t v) {
+    uint8_t n = 0;
+    while (v >= 0x80) {
+      out[n++] = (uint8_t)(v | 0x80);
+      v >>= 7;
+    }
+    out[n++] = (uint8_t)v;
+    return n;
+  }
+
+  static uint8_t putZigzag(uint8_t* out, int64_t v) {
+    return putVarint(out, ((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+  }
+
+  // Returns bytes used, 0 if the data ends first, -1 if overlong
+  static int getVarint(const uint8_t* in, size_t length, uint64_t& v) {
+    v = 0;
+    for (size_t i = 0; i < length; i++) {
+      if (i == 10) return -1;
+      v |= (uint64_t)(in[i] & 0x7F) << (7 * i);
+      if (!(in[i] & 0x80)) return (int)i + 1;
+    }
+    return length >= 10 ? -1 : 0;
+  }
+
+  static int getZigzag(const uint8_t* in, size_t length, int64_t& v) {
+    uint64_t u;
+    int n = getVarint(in, length, u);
+    v = (int64_t)(u >> 1) ^ -(int64_t)(u & 1);
+    return n;
+  }
+
+  static int32_t quantizeSpeed(float speed) {
+    return (int32_t)(speed * 100.0f + (speed < 0 ? -0.5f : 0.5f));
+  }
+
+  static int32_t quantizeAngle(float angle) {
+    int32_t a = (int32_t)(angle * 10.0f + (angle < 0 ? -0.5f : 0.5f)) % 3600;
+    return a < 0 ? a + 3600 : a;
+  }
+
+public:
+  WindRecordCodec() { reset(); }
+
+  void reset() {
+    prev_received = 0;
+    prev_speed = 0;
+    prev_angle = 0;
+    prev_source = 0;
+  }
+
+  // Writes a segment header and resets the delta state
+  size_t writeHeader(uint8_t* out) {
+    memcpy(out, WIND_RECORD_MAGIC, 4);
+    out[4] = WIND_RECORD_VERSION;
+    out[5] = out[6] = out[7] = 0;
+    reset();
+    return WIND_RECORD_HEADER_SIZE;
+  }
+
+  // Appends one record (at most WIND_RECORD_MAX_SIZE bytes)
+  size_t encode(const WindSample& sample, uint8_t* out) {
+    uint8_t flags = sample.valid & (WIND_SAMPLE_SPEED_VALID | WIND_SAMPLE_ANGLE_VALID);
+    if (sample.sourceTime) flags |= WIND_RECORD_HAS_SOURCE_TIME;
+
+    size_t n = 0;
+    out[n++] = flags;
+    n += putVarint(out + n, (uint32_t)(sample.receivedMs - prev_received));
+    prev_received = sample.receivedMs;
+
+    if (flags & WIND_SAMPLE_SPEED_VALID) {
+      int32_t speed = quantizeSpeed(sample.speed);
+      n += putZigzag(out + n, speed - prev_speed);
+      prev_speed = speed;
+    }
+    if (flags & WIND_SAMPLE_ANGLE_VALID) {
+      int32_t angle = quantizeAngle(sample.angle);
+      int32_t delta = angle - prev_angle;
+      if (delta > 1800) delta -= 3600;
+      if (delta < -1800) delta += 3600;
+      n += putZigzag(out + n, delta);
+      prev_angle = angle;
+    }
+    if (flags & WIND_RECORD_HAS_SOURCE_TIME) {
+      n += putZigzag(out + n, sample.sourceTime - prev_source);
+      prev_source = sample.sourceTime;
+    }
+    return n;
+  }
+
+  // Reads one header or record from data; used is set to the bytes
+  // consumed. State only changes when a full record was available.
+  WindRecordResult decode(const uint8_t* data, size_t length, size_t& used, WindSample& sample) {
+    used = 0;
+    if (length == 0) return WIND_RECORD_NEED_MORE;
+
+    if (data[0] == (uint8_t)WIND_RECORD_MAGIC[0]) {
+      if (length < WIND_RECORD_HEADER_SIZE) return WIND_RECORD_NEED_MORE;
+      if (memcmp(data, WIND_RECORD_MAGIC, 4) != 0 || data[4] != WIND_RECORD_VERSION) {
+        return WIND_RECORD_CORRUPT;
+      }
+      reset();
+      used = WIND_RECORD_HEADER_SIZE;
+      return WIND_RECORD_SEGMENT;
+    }
+
+    uint8_t flags = data[0];
+    if (flags & ~WIND_RECORD_FLAG_MASK) return WIND_RECORD_CORRUPT;
+
+    size_t n = 1;
+    uint64_t dt;
+    int64_t speed_delta = 0, angle_delta = 0, source_delta = 0;
+    int r = getVarint(data + n, length - n, dt);
+    if (r <= 0) return r ? WIND_RECORD_CORRUPT : WIND_RECORD_NEED_MORE;
+    n += r;
+    if (flags & WIND_SAMPLE_SPEED_VALID) {
+      r = getZigzag(data + n, length - n, speed_delta);
+      if (r <= 0) return r ? WIND_RECORD_CORRUPT : WIND_RECORD_NEED_MORE;
+      n += r;
+    }
+    if (flags & WIND_SAMPLE_ANGLE_VALID) {
+      r = getZigzag(data + n, length - n, angle_delta);
+      if (r <= 0) return r ? WIND_RECORD_CORRUPT : WIND_RECORD_NEED_MORE;
+      n += r;
+    }
+    if (flags & WIND_RECORD_HAS_SOURCE_TIME) {
+      r = getZigzag(data + n, length - n, source_delta);
+      if (r <= 0) return r ? WIND_RECORD_CORRUPT : WIND_RECORD_NEED_MORE;
+      n += r;
+    }
+
+    prev_received += (uint32_t)dt;
+    sample = WindSample();
+    sample.receivedMs = prev_received;
+    sample.valid = flags & (WIND_SAMPLE_SPEED_VALID | WIND_SAMPLE_ANGLE_VALID);
+    if (flags & WIND_SAMPLE_SPEED_VALID) {
+      prev_speed += (int32_t)speed_delta;
+      sample.speed = prev_speed / 100.0f;
+    }
+    if (flags & WIND_SAMPLE_ANGLE_VALID) {
+      prev_angle = (prev_angle + (int32_t)angle_delta + 3600) % 3600;
+      sample.angle = prev_angle / 10.0f;
+    }
+    if (flags & WIND_RECORD_HAS_SOURCE_TIME) {
+      prev_source += source_delta;
+      sample.sourceTime = prev_source;
+    }
+    used = n;
+    return WIND_RECORD_SAMPLE;
+  }
+};
+
+#endif // WIND_RECORDING_FORMAT_H
@@ -0,0 +1,126 @@
+/*
+  WindSample.h - Timestamped wind reading and fixed-size sample history
+
+  A WindSample carries speed and angle from the same update together
+  with where it came from in time: the source's own timestamp (e.g. the
+  Signal K update timestamp) and the local receive time. Each field has
+  its own validity bit so a source that only knows one of them can
+  still publish. Sources that also know true wind (speed and angle
+  relative to the bow, corrected for boat motion) add it with
+  WIND_SAMPLE_TRUE_VALID.
+
+  WindSampleRing keeps the most recent WIND_SAMPLE_HISTORY samples in a
+  static array. Consumers read entries in place by age (0 = newest)
+  instead of copying the history out.
+
+  WindSampleSubscribers is the fixed-size callback list used to push
+  samples to the display, filters and loggers as they are published.
+*/
+
+#ifndef WIND_SAMPLE_H
+#define WIND_SAMPLE_H
+
+#include <stdint.h>
+
+#define WIND_SAMPLE_HISTORY 32   // Samples kept per source, power of two
+#define WIND_MAX_SUBSCRIBERS 4   // Callbacks per source / manager
+
+// WindSample::valid bits
+#define WIND_SAMPLE_SPEED_VALID  0x01
+#define WIND_SAMPLE_ANGLE_VALID  0x02
+#define WIND_SAMPLE_TRUE_VALID   0x04   // trueSpeed and trueAngle set
+
+struct WindSample {
+  float speed;          // m/s
+  float angle;          // degrees 0-359, relative to bow
+  float trueSpeed;      // m/s
+  float trueAngle;      // degrees 0-359, relative to bow
+  int64_t sourceTime;   // Epoch ms stamped by the source, 0 if unknown
+  uint32_t receivedMs;  // millis() when the data arrived
+  uint32_t sequence;    // Set on publish, 0 = no sample yet
+  uint8_t valid;        // WIND_SAMPLE_* bits
+
+  bool hasSpeed() const { return valid & WIND_SAMPLE_SPEED_VALID; }
+  bool hasAngle() const { return valid & WIND_SAMPLE_ANGLE_VALID; }
+  bool hasTrue() const { return valid & WIND_SAMPLE_TRUE_VALID; }
+};
+
+class WindSampleRing {
+private:
+  WindSample samples[WIND_SAMPLE_HISTORY];
+  uint32_t published;   // Total samples pushed
+
+public:
+  WindSampleRing() { clear(); }
+
+  void clear() {
+    published = 0;
+    samples[0] = WindSample();
+  }
+
+  // Stores the sample and returns its sequence number (1-based)
+  uint32_t push(const WindSample& sample) {
+    WindSample& slot = samples[published & (WIND_SAMPLE_HISTORY - 1)];
+    slot = sample;
+    slot.sequence = ++published;
+    return published;
+  }
+
+  // Number of samples held (at most WIND_SAMPLE_HISTORY)
+  uint8_t size() const {
+    return published < WIND_SAMPLE_HISTORY ? published : WIND_SAMPLE_HISTORY;
+  }
+
+  uint32_t getPublished() const { return published; }
+
+  // age 0 is the newest sample; age must be < size()
+  const WindSample& at(uint8_t age) const {
+    return samples[(published - 1 - age) & (WIND_SAMPLE_HISTORY - 1)];
+  }
+
+  // Newest sample, or an all-zero one (sequence 0) before the first push
+  const WindSample& latest() const {
+    return published ? at(0) : samples[0];
+  }
+};
+
+typedef void (*WindSampleCallback)(void* context, const WindSample& sample);
+
+class WindSampleSubscribers {
+private:
+  WindSampleCallback callbacks[WIND_MAX_SUBSCRIBERS];
+  void* contexts[WIND_MAX_SUBSCRIBERS];
+  uint8_t count;
+
+public:
+  WindSampleSubscribers() : count(0) {}
+
+  bool add(WindSampleCallback callback, void* context) {
+    if (count >= WIND_MAX_SUBSCRIBERS) return false;
+    callbacks[count] = callback;
+    contexts[count] = context;
+    count++;
+    return true;
+  }
+
+  void remove(WindSampleCallback callback, void* context) {
+    for (uint8_t i = 0; i < count; i++) {
+      if (callbacks[i] == callback && contexts[i] == context) {
+        count--;
+        callbacks[i] = callbacks[count];
+        contexts[i] = contexts[count];
+        return;
+      }
+    }
+  }
+
+  void notify(const WindSample& sample) {
+    for (uint8_t i = 0; i < count; i++) {
+      callbacks[i](contexts[i], sample);
+    }
+  }
+
+  uint8_t size() const { return count; }
+};
+
+#endif // WIND_SAMPLE_H
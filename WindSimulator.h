@@ -0,0 +1,228 @@
+/*
+  WindSimulator.h - Seedable model of a boat beating to windward
+
+  Drives the demo source and the host tools. The model, advanced in
+  fixed steps of 1/rateHz seconds:
+
+    true wind speed  mean plus three Ornstein-Uhlenbeck gust components
+                     (3, 15 and 60 s time constants), so gusts have a
+                     spread of durations rather than white noise
+    true wind dir    mean plus a sine oscillation (shiftAmplitude,
+                     shiftPeriod) and a slow random shift
+    heading          helmsman holds tackAngle off a lagged view of the
+                     wind, with some steering noise; every tackInterval
+                     the boat tacks through the wind in tackDuration
+    boat speed       scales with wind speed, slows through a tack and
+                     accelerates out of it
+
+  Apparent wind is the vector sum of true wind and boat motion.
+  Everything comes from a xorshift generator seeded with config.seed
+  and integer step counts, never the clock, so the same seed and rate
+  give the same sequence on every run. Plain C++, no Arduino
+  dependencies.
+*/
+
+#ifndef WIND_SIMULATOR_H
+#define WIND_SIMULATOR_H
+
+#include <stdint.h>
+#include <math.h>
+#include "WindSample.h"
+
+#define WIND_SIM_MAX_RATE_HZ 50
+#define WIND_SIM_GUSTS       3
+
+struct WindSimulatorConfig {
+  uint32_t seed;
+  uint16_t rateHz;          // Steps per second, 1-WIND_SIM_MAX_RATE_HZ
+  float meanSpeed;          // True wind, m/s
+  float meanDirection;      // True wind, degrees
+  float gustiness;          // Gust standard deviation as a fraction of meanSpeed
+  float shiftAmplitude;     // Oscillating shift, degrees either side
+  float shiftPeriod;        // s
+  float boatSpeed;          // m/s at meanSpeed
+  float tackAngle;          // True wind angle sailed, degrees
+  float tackInterval;       // s between tacks, 0 = never tack
+  float tackDuration;       // s to turn through the wind
+
+  WindSimulatorConfig()
+    : seed(1), rateHz(5), meanSpeed(6.5f), meanDirection(220.0f), gustiness(0.15f),
+      shiftAmplitude(8.0f), shiftPeriod(240.0f), boatSpeed(3.0f), tackAngle(42.0f),
+      tackInterval(300.0f), tackDuration(8.0f) {}
+};
+
+class WindSimulator {
+private:
+  WindSimulatorConfig config;
+  uint32_t rng;
+  uint32_t steps;
+  float dt;
+
+  float gust[WIND_SIM_GUSTS];
+  float shift_noise;        // degrees
+  float helm_noise;         // degrees
+  float shift_phase;        // radians
+  float lagged_direction;   // Wind direction the helmsman steers by
+  int8_t tack;              // +1 starboard (wind from the right), -1 port
+  float tack_progress;      // 0-1 through a tack, 1 = not tacking
+  float since_tack;         // s
+
+  // Outputs
+  float true_speed;
+  float true_direction;
+  float heading;
+  float boat_speed;
+  float true_angle;         // Relative to the bow, -180..180
+  float apparent_speed;
+  float apparent_angle;     // Relative to the bow, -180..180
+
+  static float wrap180(float a) {
+    while (a > 180.0f) a -= 360.0f;
+    while (a <= -180.0f) a += 360.0f;
+    return a;
+  }
+
+  static float wrap360(float a) {
+    while (a >= 360.0f) a -= 360.0f;
+    while (a < 0.0f) a += 360.0f;
+    return a;
+  }
+
+  float uniform() {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return (rng >> 8) * (1.0f / 16777216.0f);
+  }
+
+  // Standard normal (Box-Muller, one value per call)
+  float gaussian() {
+    float u = uniform();
+    if (u < 1e-7f) u = 1e-7f;
+    return sqrtf(-2.0f * logf(u)) * cosf(6.2831853f * uniform());
+  }
+
+  // One Ornstein-Uhlenbeck step with stationary standard deviation sigma
+  float ou(float x, float tau, float sigma) {
+    return x - x * dt / tau + sigma * sqrtf(2.0f * dt / tau) * gaussian();
+  }
+
+  void updateOutputs() {
+    true_angle = wrap180(true_direction - heading);
+    float rad = true_angle * 0.017453293f;
+    float along = true_speed * cosf(rad) + boat_speed;
+    float across = true_speed * sinf(rad);
+    apparent_speed = sqrtf(along * along + across * across);
+    apparent_angle = atan2f(across, along) * 57.29578f;
+  }
+
+public:
+  WindSimulator(const WindSimulatorConfig& cfg = WindSimulatorConfig()) : config(cfg) {
+    reset();
+  }
+
+  void configure(const WindSimulatorConfig& cfg) {
+    config = cfg;
+    reset();
+  }
+
+  // Back to step 0 of the configured seed
+  void reset() {
+    if (config.rateHz < 1) config.rateHz = 1;
+    if (config.rateHz > WIND_SIM_MAX_RATE_HZ) config.rateHz = WIND_SIM_MAX_RATE_HZ;
+    rng = config.seed ? config.seed : 1;
+    steps = 0;
+    dt = 1.0f / config.rateHz;
+    for (uint8_t i = 0; i < WIND_SIM_GUSTS; i++) gust[i] = 0;
+    shift_noise = 0;
+    helm_noise = 0;
+    shift_phase = 6.2831853f * uniform();
+    lagged_direction = config.meanDirection;
+    tack = 1;
+    tack_progress = 1.0f;
+    since_tack = config.tackInterval * uniform();  // Don't tack at the same time every run
+    true_speed = config.meanSpeed;
+    true_direction = config.meanDirection;
+    boat_speed = config.boatSpeed;
+    heading = wrap360(true_direction - tack * config.tackAngle);
+    updateOutputs();
+  }
+
+  // Advance by one sample period
+  void step() {
+    steps++;
+    float t = steps * dt;
+
+    // True wind
+    static const float gust_tau[WIND_SIM_GUSTS] = {3.0f, 15.0f, 60.0f};
+    float sigma = config.gustiness * config.meanSpeed / sqrtf((float)WIND_SIM_GUSTS);
+    float speed = config.meanSpeed;
+    for (uint8_t i = 0; i < WIND_SIM_GUSTS; i++) {
+      gust[i] = ou(gust[i], gust_tau[i], sigma);
+      speed += gust[i];
+    }
+    true_speed = speed > 0 ? speed : 0;
+    shift_noise = ou(shift_noise, 120.0f, 3.0f);
+    float shift = config.shiftPeriod > 0
+      ? config.shiftAmplitude * sinf(6.2831853f * t / config.shiftPeriod + shift_phase) : 0;
+    true_direction = wrap360(config.meanDirection + shift + shift_noise);
+
+    // Helmsman follows the wind with a lag of about 10 s
+    lagged_direction = wrap360(lagged_direction + wrap180(true_direction - lagged_direction) * dt / 10.0f);
+    helm_noise = ou(helm_noise, 4.0f, 2.0f);
+
+    // Tacks: swing through the wind, losing speed on the way
+    since_tack += dt;
+    if (tack_progress >= 1.0f && config.tackInterval > 0 && since_tack >= config.tackInterval) {
+      tack = -tack;
+      tack_progress = 0;
+      since_tack = 0;
+    }
+    float target = wrap360(lagged_direction - tack * config.tackAngle);
+    if (tack_progress < 1.0f) {
+      tack_progress += config.tackDuration > 0 ? dt / config.tackDuration : 1.0f;
+      if (tack_progress > 1.0f) tack_progress = 1.0f;
+      // Turn from the old course through the wind to the new one
+      float from = wrap360(lagged_direction + tack * config.tackAngle);
+      heading = wrap360(from - tack * 2.0f * config.tackAngle * tack_progress);
+    } else {
+      heading = wrap360(target + helm_noise);
+    }
+
+    float ratio = config.meanSpeed > 0 ? true_speed / config.meanSpeed : 0;
+    if (ratio < 0.3f) ratio = 0.3f;
+    if (ratio > 1.3f) ratio = 1.3f;
+    float target_speed = config.boatSpeed * ratio * (tack_progress < 1.0f ? 0.4f : 1.0f);
+    boat_speed += (target_speed - boat_speed) * dt / (tack_progress < 1.0f ? 2.0f : 8.0f);
+
+    updateOutputs();
+  }
+
+  // Apparent and true wind of the current step; receivedMs is the caller's
+  WindSample sample() const {
+    WindSample s = {};
+    s.speed = apparent_speed;
+    s.angle = wrap360(apparent_angle);
+    s.trueSpeed = true_speed;
+    s.trueAngle = wrap360(true_angle);
+    s.valid = WIND_SAMPLE_SPEED_VALID | WIND_SAMPLE_ANGLE_VALID | WIND_SAMPLE_TRUE_VALID;
+    return s;
+  }
+
+  const WindSimulatorConfig& getConfig() const { return config; }
+  uint16_t getRateHz() const { return config.rateHz; }
+  uint32_t getSteps() const { return steps; }
+  float getTime() const { return steps * dt; }
+
+  float getApparentSpeed() const { return apparent_speed; }
+  float getApparentAngle() const { return wrap360(apparent_angle); }   // 0-359, relative to bow
+  float getTrueSpeed() const { return true_speed; }
+  float getTrueAngle() const { return wrap360(true_angle); }           // 0-359, relative to bow
+  float getTrueDirection() const { return true_direction; }            // degrees true
+  float getHeading() const { return heading; }                         // degrees true
+  float getBoatSpeed() const { return boat_speed; }
+  bool isStarboardTack() const { return tack > 0; }
+  bool isTacking() const { return tack_progress < 1.0f; }
+};
+
+#endif // WIND_SIMULATOR_H
@@ -0,0 +1,87 @@
+/*
+  WindSourceMetrics.h - Health and throughput counters for one data source
+
+  Every WindDataSource keeps one of these. The base class counts samples
+  and their inter-arrival times as they are published, the manager times
+  each update() call, and each source adds what only it can see: messages
+  and bytes off the wire, parse errors and reconnects. Fixed size, no
+  allocation; read through WindDataSourceManager::getMetrics().
+*/
+
+#ifndef WIND_SOURCE_METRICS_H
+#define WIND_SOURCE_METRICS_H
+
+#include <stdint.h>
+#include "LatencyHistogram.h"
+
+struct WindSourceMetrics {
+  uint32_t messages;            // Frames, sentences or records received
+  uint32_t bytes;               // Payload bytes received
+  uint32_t parseErrors;         // Messages that could not be decoded
+  uint32_t reconnects;          // Link re-established after the first connect
+  uint32_t samples;             // Samples published
+  uint32_t lastSampleMs;        // millis() of the newest sample, 0 = none yet
+  LatencyHistogram interArrival;  // ms between consecutive samples
+  uint32_t updates;             // update() calls timed
+  uint32_t updateMaxUs;
+  uint64_t updateTotalUs;
+
+  WindSourceMetrics() { reset(); }
+
+  void reset() {
+    messages = 0;
+    bytes = 0;
+    parseErrors = 0;
+    reconnects = 0;
+    samples = 0;
+    lastSampleMs = 0;
+    interArrival.reset();
+    updates = 0;
+    updateMaxUs = 0;
+    updateTotalUs = 0;
+  }
+
+  void recordSample(uint32_t now) {
+    if (lastSampleMs) interArrival.record(now - lastSampleMs);
+    lastSampleMs = now ? now : 1;
+    samples++;
+  }
+
+  void recordUpdate(uint32_t us) {
+    updates++;
+    updateTotalUs += us;
+    if (us > updateMaxUs) updateMaxUs = us;
+  }
+
+  // Add another source's wire counters (for sources built from links)
+  void addCounters(const WindSourceMetrics& other) {
+    messages += other.messages;
+    bytes += other.bytes;
+    parseErrors += other.parseErrors;
+    reconnects += other.reconnects;
+  }
+
+  // ms since the newest sample, UINT32_MAX if there has been none
+  uint32_t sinceLastSample(uint32_t now) const {
+    return lastSampleMs ? now - lastSampleMs : UINT32_MAX;
+  }
+
+  uint32_t getUpdateMeanUs() const {
+    return updates ? (uint32_t)(updateTotalUs / updates) : 0;
+  }
+
+  template <class Output>
+  void print(Output& out, const char* name, uint32_t now) const {
+    uint32_t age = sinceLastSample(now);
+    out.printf("  %s: msgs=%lu bytes=%lu errors=%lu reconnects=%lu samples=%lu last=",
+               name, (unsigned long)messages, (unsigned long)bytes, (unsigned long)parseErrors,
+               (unsigned long)reconnects, (unsigned long)samples);
+    if (age == UINT32_MAX) out.printf("never\n");
+    else out.printf("%lu ms ago\n", (unsigned long)age);
+    out.printf("    update: n=%lu avg=%lu max=%lu us\n", (unsigned long)updates,
+               (unsigned long)getUpdateMeanUs(), (unsigned long)updateMaxUs);
+    interArrival.print(out, "inter-arrival");
+  }
+};
+
+#endif // WIND_SOURCE_METRICS_H
@@ -0,0 +1,196 @@
+/*
+  WindSourceRegistry.h - Compile-time selection of the wind data sources
+
+  Which sources a build contains is decided by the WIND_ENABLE_* flags
+  (all on by default). A disabled source's header is never included, so
+  its libraries are not linked: a build with WIND_ENABLE_SIGNALK=0 has
+  no WiFi, WebSockets or ArduinoJson, one with WIND_ENABLE_NMEA=0 leaves
+  the UART alone. WIND_ENABLE_RECORDER adds the
+  LittleFS recorder and the replay source.
+
+  WindSources is a WindSourceRegistry over the enabled source classes.
+  It holds WIND_SOURCE_INSTANCES StaticSlots per class, so a new source
+  can start while the one it replaces is still running (make-before-
+  break switching). create<T>() / get<T>() pick the class at compile
+  time and fail to compile for a class that is not in the build.
+  find() maps a configured DataSourceType to a live source, destroy()
+  frees a source by pointer.
+
+  Set the flags with build flags, e.g.
+    arduino-cli compile --build-property "compiler.cpp.extra_flags=-DWIND_ENABLE_SIGNALK=0"
+*/
+
+#ifndef WIND_SOURCE_REGISTRY_H
+#define WIND_SOURCE_REGISTRY_H
+
+#ifndef WIND_ENABLE_DEMO
+#define WIND_ENABLE_DEMO 1
+#endif
+
+#ifndef WIND_ENABLE_SIGNALK
+#define WIND_ENABLE_SIGNALK 1
+#endif
+
+#ifndef WIND_ENABLE_NMEA
+#define WIND_ENABLE_NMEA 1
+#endif
+
+#ifndef WIND_ENABLE_RECORDER
+#define WIND_ENABLE_RECORDER 1
+#endif
+
+#ifndef WIND_SOURCE_INSTANCES
+#define WIND_SOURCE_INSTANCES 2   // Old and new source during a switch
+#endif
+
+#if !WIND_ENABLE_DEMO && !WIND_ENABLE_SIGNALK && !WIND_ENABLE_NMEA
+#error "At least one WIND_ENABLE_* source must be enabled"
+#endif
+
+#include "WindDataSourceManager.h"
+#include "StaticSlot.h"
+
+#if WIND_ENABLE_DEMO
+#include "DemoWindDataSource.h"
+#endif
+#if WIND_ENABLE_SIGNALK
+#include "SignalKFailoverSource.h"
+#endif
+#if WIND_ENABLE_NMEA
+#include "NMEA0183WindDataSource.h"
+#endif
+#if WIND_ENABLE_RECORDER
+#include "ReplayWindDataSource.h"
+#endif
+
+// Placeholder for a disabled source; skipped by the registry
+struct WindSourceNone {};
+
+// DataSourceType served by each source class
+template <typename T> struct WindSourceTraits;
+
+#if WIND_ENABLE_DEMO
+template <> struct WindSourceTraits<DemoWindDataSource> {
+  static constexpr DataSourceType type = SOURCE_DEMO;
+};
+#define WIND_REGISTRY_DEMO DemoWindDataSource
+#else
+#define WIND_REGISTRY_DEMO WindSourceNone
+#endif
+
+#if WIND_ENABLE_SIGNALK
+template <> struct WindSourceTraits<SignalKFailoverSource> {
+  static constexpr DataSourceType type = SOURCE_WIFI_SIGNALK;
+};
+#define WIND_REGISTRY_SIGNALK SignalKFailoverSource
+#else
+#define WIND_REGISTRY_SIGNALK WindSourceNone
+#endif
+
+#if WIND_ENABLE_NMEA
+template <> struct WindSourceTraits<NMEA0183WindDataSource> {
+  static constexpr DataSourceType type = SOURCE_NMEA;
+};
+#define WIND_REGISTRY_NMEA NMEA0183WindDataSource
+#else
+#define WIND_REGISTRY_NMEA WindSourceNone
+#endif
+
+#if WIND_ENABLE_RECORDER
+template <> struct WindSourceTraits<ReplayWindDataSource> {
+  static constexpr DataSourceType type = SOURCE_REPLAY;
+};
+#define WIND_REGISTRY_REPLAY ReplayWindDataSource
+#else
+#define WIND_REGISTRY_REPLAY WindSourceNone
+#endif
+
+template <typename T> struct WindSourceTag {};
+
+template <typename... Sources>
+class WindSourceRegistry;
+
+template <>
+class WindSourceRegistry<> {
+protected:
+  void slotOf() {}
+
+public:
+  static constexpr bool has(DataSourceType) { return false; }
+  static constexpr uint8_t size() { return 0; }
+  WindDataSource* find(DataSourceType) { return nullptr; }
+  bool destroy(WindDataSource*) { return false; }
+  void destroyAll() {}
+};
+
+template <typename... Rest>
+class WindSourceRegistry<WindSourceNone, Rest...> : public WindSourceRegistry<Rest...> {};
+
+template <typename Source, typename... Rest>
+class WindSourceRegistry<Source, Rest...> : public WindSourceRegistry<Rest...> {
+  typedef WindSourceRegistry<Rest...> Next;
+
+  StaticSlot<Source> slots[WIND_SOURCE_INSTANCES];
+
+protected:
+  using Next::slotOf;
+  StaticSlot<Source>* slotOf(WindSourceTag<Source>) { return slots; }
+
+public:
+  static constexpr bool has(DataSourceType type) {
+    return type == WindSourceTraits<Source>::type || Next::has(type);
+  }
+
+  static constexpr uint8_t size() { return 1 + Next::size(); }
+
+  // First live source for a type, nullptr if none or not in this build
+  WindDataSource* find(DataSourceType type) {
+    if (type != WindSourceTraits<Source>::type) return Next::find(type);
+    for (uint8_t i = 0; i < WIND_SOURCE_INSTANCES; i++) {
+      if (slots[i].get()) return slots[i].get();
+    }
+    return nullptr;
+  }
+
+  // Construct in a free slot; nullptr if all instances are in use
+  template <typename T, typename... Args>
+  T* create(Args... args) {
+    StaticSlot<T>* s = slotOf(WindSourceTag<T>());
+    for (uint8_t i = 0; i < WIND_SOURCE_INSTANCES; i++) {
+      if (!s[i].get()) return s[i].create(args...);
+    }
+    return nullptr;
+  }
+
+  template <typename T>
+  T* get() {
+    StaticSlot<T>* s = slotOf(WindSourceTag<T>());
+    for (uint8_t i = 0; i < WIND_SOURCE_INSTANCES; i++) {
+      if (s[i].get()) return s[i].get();
+    }
+    return nullptr;
+  }
+
+  // Destroy the source at this address; false if it is not one of ours
+  bool destroy(WindDataSource* source) {
+    for (uint8_t i = 0; i < WIND_SOURCE_INSTANCES; i++) {
+      if (source && slots[i].get() == source) {
+        slots[i].destroy();
+        return true;
+      }
+    }
+    return Next::destroy(source);
+  }
+
+  void destroyAll() {
+    for (uint8_t i = 0; i < WIND_SOURCE_INSTANCES; i++) {
+      slots[i].destroy();
+    }
+    Next::destroyAll();
+  }
+};
+
+typedef WindSourceRegistry<WIND_REGISTRY_DEMO, WIND_REGISTRY_SIGNALK, WIND_REGISTRY_NMEA,
+                           WIND_REGISTRY_REPLAY> WindSources;
+
+#endif // WIND_SOURCE_REGISTRY_H
@@ -0,0 +1,104 @@
+/*
+  WindSourceTask.h - Runs the data source manager in its own FreeRTOS task
+
+  With the source in loop(), a slow WebSocket read or WiFi reconnect
+  holds up LVGL. WindSourceTask moves sourceManager.update() into a
+  separate task and hands the (coalesced) samples back to the UI task
+  through a lock-free SPSC queue, which loop() drains.
+
+  The queue never blocks the source: when the UI falls behind, new
+  samples are dropped and counted as overruns. Source switching and
+  anything else that touches source internals from the UI task must be
+  wrapped in lock()/unlock(), which is held by the task for each update.
+*/
+
+#ifndef WIND_SOURCE_TASK_H
+#define WIND_SOURCE_TASK_H
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include "WindDataSourceManager.h"
+#include "SpscQueue.h"
+
+#define WIND_SOURCE_QUEUE_DEPTH   16     // Samples, power of two
+#define WIND_SOURCE_TASK_STACK    8192   // Bytes (WiFi, WebSocket, JSON)
+#define WIND_SOURCE_TASK_PRIORITY 2      // Above loopTask (1)
+#define WIND_SOURCE_TASK_PERIOD   2      // ms between manager updates
+
+typedef SpscQueue<WindSample, WIND_SOURCE_QUEUE_DEPTH> WindSampleQueue;
+
+class WindSourceTask {
+private:
+  WindDataSourceManager* manager;
+  WindSampleQueue queue;
+  SemaphoreHandle_t mutex;
+  TaskHandle_t handle;
+
+  // Runs in the source task (producer side)
+  static void onSample(void* context, const WindSample& sample) {
+    ((WindSourceTask*)context)->queue.push(sample);
+  }
+
+  static void run(void* context) {
+    WindSourceTask* self = (WindSourceTask*)context;
+    for (;;) {
+      self->lock();
+      self->manager->update();
+      self->unlock();
+      vTaskDelay(pdMS_TO_TICKS(WIND_SOURCE_TASK_PERIOD));
+    }
+  }
+
+public:
+  WindSourceTask() : manager(nullptr), mutex(nullptr), handle(nullptr) {}
+
+  // Subscribe to the manager and start the task
+  bool begin(WindDataSourceManager* mgr) {
+    if (handle) return true;
+    manager = mgr;
+    mutex = xSemaphoreCreateMutex();
+    if (!mutex || !manager->subscribe(onSample, this)) {
+      Serial.println("[SourceTask] Setup failed");
+      return false;
+    }
+    if (xTaskCreate(run, "wind_source", WIND_SOURCE_TASK_STACK, this,
+                    WIND_SOURCE_TASK_PRIORITY, &handle) != pdPASS) {
+      Serial.println("[SourceTask] Task create failed");
+      manager->unsubscribe(onSample, this);
+      handle = nullptr;
+      return false;
+    }
+    Serial.println("[SourceTask] Started");
+    return true;
+  }
+
+  bool isRunning() { return handle != nullptr; }
+
+  // UI task side: next queued sample, false when empty
+  bool receive(WindSample& sample) {
+    return queue.pop(sample);
+  }
+
+  // Serialize with the task's manager update
+  void lock() {
+    if (mutex) xSemaphoreTake(mutex, portMAX_DELAY);
+  }
+
+  void unlock() {
+    if (mutex) xSemaphoreGive(mutex);
+  }
+
+  uint32_t getQueueDepth() { return queue.depth(); }
+  uint32_t getMaxQueueDepth() { return queue.getMaxDepth(); }
+  uint32_t getOverruns() { return queue.getOverruns(); }
+
+  void printStats(Print& out) {
+    out.printf("[SourceTask] queue %lu/%lu, max depth %lu, overruns %lu, stack free %lu\n",
+               (unsigned long)queue.depth(), (unsigned long)queue.capacity(),
+               (unsigned long)queue.getMaxDepth(), (unsigned long)queue.getOverruns(),
+               handle ? (unsigned long)uxTaskGetStackHighWaterMark(handle) : 0UL);
+  }
+};
+
+#endif // WIND_SOURCE_TASK_H
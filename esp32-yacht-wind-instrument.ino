@@ -6,6 +6,13 @@
 */
 #define VERSION "0.1.0"
 
+// 1 = run the data source in its own FreeRTOS task so a slow WebSocket
+// read or WiFi reconnect cannot delay rendering; samples reach loop()
+// through a lock-free queue. 0 = update the source from loop().
+#ifndef WIND_SOURCE_TASK
+#define WIND_SOURCE_TASK 0
+#endif
+
 #include <lvgl.h>
 #include <Adafruit_GFX.h>
 #include <Adafruit_ILI9341.h>
@@ -15,10 +22,16 @@
 // Wind data source abstraction
 #include "WindDataSource.h"
 #include "WindDataSourceManager.h"
-#include "DemoWindDataSource.h"
-#include "SignalKWindDataSource.h"
+#include "WindSourceRegistry.h"   // Sources in this build (WIND_ENABLE_*)
 #include "WindConfig.h"
 #include "ConfigScreen.h"
+#include "LatencyHistogram.h"
+#if WIND_SOURCE_TASK
+#include "WindSourceTask.h"
+#endif
+#if WIND_ENABLE_RECORDER
+#include "WindRecorder.h"
+#endif
 
 // Declare custom fonts (defined in roboto_mono_semibold_*.c)
 LV_FONT_DECLARE(roboto_mono_semibold_24);
@@ -62,17 +75,95 @@ static lv_obj_t *status_label;  // Connection status
 static lv_obj_t *main_screen;  // Store main screen reference
 static lv_point_precise_t arrow_points[2];  // Just 2 points for a line
 
-// Wind data source
+// Wind data sources, rebuilt in place on every config change so
+// reconfiguring never allocates
 WindDataSourceManager sourceManager;
-DemoWindDataSource* demoSource = nullptr;
-SignalKWindDataSource* signalKSource = nullptr;
+WindSources sources;
+#if WIND_ENABLE_SIGNALK
+SignalKFailoverSource* signalKSource = nullptr;
+#endif
 WindConfig windConfig;
 ConfigScreen *configScreen = nullptr;
+#if WIND_SOURCE_TASK
+WindSourceTask sourceTask;
+#endif
+#if WIND_ENABLE_RECORDER
+WindRecorder recorder;
+File replay_file;
+#endif
+#if WIND_ENABLE_NMEA
+NMEA0183Output nmeaOutput;   // Repeater on Serial1 TX
+#endif
+
+// Sources the manager has stopped, freed by release_retired_sources().
+// Retiring can happen on the source task (when a switch cuts over), so
+// freeing waits for loop(), where signalKSource is also read. Every
+// registry slot can be waiting at once, never more.
+#define WIND_RETIRED_MAX (WindSources::size() * WIND_SOURCE_INSTANCES)
+WindDataSource* retired_sources[WIND_RETIRED_MAX];
+volatile uint8_t retired_count = 0;
+
+void on_source_retired(void* context, WindDataSource* source) {
+  if (retired_count < WIND_RETIRED_MAX) {
+    retired_sources[retired_count++] = source;
+  } else {
+    Serial.println("[Sources] Retired list full, source slot leaked");
+  }
+}
+
+// Held while the UI task touches source internals (no-op without the task)
+void lock_sources() {
+#if WIND_SOURCE_TASK
+  sourceTask.lock();
+#endif
+}
+
+void unlock_sources() {
+#if WIND_SOURCE_TASK
+  sourceTask.unlock();
+#endif
+}
+
+// Point signalKSource at the Signal K source feeding the display, if any
+void refresh_signalk_source() {
+#if WIND_ENABLE_SIGNALK
+  signalKSource = nullptr;
+  for (uint8_t i = 0; i < sourceManager.getSourceCount(); i++) {
+    if (sourceManager.getSourceType(i) == SOURCE_WIFI_SIGNALK) {
+      signalKSource = (SignalKFailoverSource*)sourceManager.getSource(i);
+      break;
+    }
+  }
+#endif
+}
+
+// Free the sources the manager has stopped; call with the source lock
+// held, before creating new ones (their slots get reused)
+void release_retired_sources() {
+  for (uint8_t i = 0; i < retired_count; i++) {
+#if WIND_ENABLE_RECORDER
+    if (retired_sources[i] == sources.get<ReplayWindDataSource>() && replay_file) {
+      replay_file.close();
+    }
+#endif
+    sources.destroy(retired_sources[i]);
+  }
+  retired_count = 0;
+  refresh_signalk_source();
+}
 
 // Current wind data (in internal units: m/s and degrees)
 float wind_speed_ms = 0.0;   // m/s
 float wind_direction = 0.0;  // degrees
 
+// Latency from a Signal K wind delta being parsed to it being drawn.
+// Server-to-parse latency is kept by the Signal K source.
+LatencyHistogram parse_to_display;   // Parsed -> labels/arrow updated
+LatencyHistogram parse_to_flush;     // Parsed -> LVGL flush finished
+unsigned long last_displayed_rx = 0;
+unsigned long flush_pending_rx = 0;  // Parse time awaiting its flush
+static lv_obj_t *diag_label;         // Latency overlay, toggled from status label
+
 void my_disp_flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_map) {
   uint32_t w = lv_area_get_width(area);
   uint32_t h = lv_area_get_height(area);
@@ -82,6 +173,11 @@ void my_disp_flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_map
   tft.writePixels((uint16_t *)px_map, w * h);
   tft.endWrite();
   
+  if (flush_pending_rx && lv_display_flush_is_last(display)) {
+    parse_to_flush.record(millis() - flush_pending_rx);
+    flush_pending_rx = 0;
+  }
+  
   lv_display_flush_ready(display);
 }
 
@@ -195,27 +291,36 @@ void draw_compass_marks(lv_obj_t *parent, lv_obj_t *circle) {
   }
 }
 
+// Redraw from wind_speed_ms / wind_direction. Labels are only touched
+// when their text changes, so a steady wind causes no redraw.
 void update_wind_display() {
-  // Get data from current source
-  WindDataSource* dataSource = sourceManager.getCurrentSource();
-  if (dataSource && dataSource->isConnected()) {
-    wind_speed_ms = dataSource->getWindSpeed();
-    wind_direction = dataSource->getWindAngle();
-  }
+  static char last_speed[8] = "";
+  static const char* last_units = nullptr;
+  static int last_direction = -1;
   
   // Convert speed using configured units
   float wind_speed_display = windConfig.convertSpeed(wind_speed_ms);
   
   // Update wind speed with fixed-width formatting (right-aligned)
-  char speed_buf[32];
+  char speed_buf[8];
   snprintf(speed_buf, sizeof(speed_buf), "%4.1f", wind_speed_display);
-  lv_label_set_text(wind_speed_label, speed_buf);
+  if (strcmp(speed_buf, last_speed) != 0) {
+    lv_label_set_text(wind_speed_label, speed_buf);
+    strcpy(last_speed, speed_buf);
+  }
   
   // Update units label
-  lv_label_set_text(wind_speed_units_label, windConfig.getUnitsLabel());
+  const char* units = windConfig.getUnitsLabel();
+  if (units != last_units) {
+    lv_label_set_text(wind_speed_units_label, units);
+    last_units = units;
+  }
   
   // Update wind direction angle with fixed-width formatting
-  lv_label_set_text_fmt(wind_dir_label, "%3d°", (int)wind_direction);
+  int direction = (int)wind_direction;
+  if (direction == last_direction) return;
+  last_direction = direction;
+  lv_label_set_text_fmt(wind_dir_label, "%3d°", direction);
   
   // Calculate arrow line - center at 120,120 in the 240x240 container
   int cx = 120, cy = 120;
@@ -231,71 +336,405 @@ void update_wind_display() {
   lv_line_set_points(wind_arrow, arrow_points, 2);
 }
 
-// Restart data source after config change
-void restartDataSource() {
-  Serial.println("[Restart] Starting data source restart");
-  DataSourceType sourceType = windConfig.getDataSource();
-  Serial.printf("[Restart] Target source type: %d\n", sourceType);
-  
-  // Reset display values
-  wind_speed_ms = 0.0;
-  wind_direction = 0.0;
-  
-  if (sourceType == SOURCE_WIFI_SIGNALK) {
-    Serial.println("[Restart] Switching to SignalK");
-    // Clean up demo source if it exists
-    if (demoSource) {
-      Serial.println("[Restart] Cleaning up demo source");
-      if (sourceManager.getCurrentSource() == demoSource) {
-        sourceManager.switchSource(nullptr, SOURCE_DEMO);
-      }
-      delete demoSource;
-      demoSource = nullptr;
+// Called by sourceManager with each (coalesced) sample from the active
+// source. Speed and angle come from one sample, never from different updates.
+void on_wind_sample(void* context, const WindSample& sample) {
+  if (sample.hasSpeed()) wind_speed_ms = sample.speed;
+  if (sample.hasAngle()) wind_direction = sample.angle;
+  update_wind_display();
+#if WIND_ENABLE_NMEA
+  nmeaOutput.onSample(sample);
+#endif
+  
+  // Measure receive-to-display latency for new Signal K data
+  if (sourceManager.getCurrentType() == SOURCE_WIFI_SIGNALK) {
+    unsigned long rx = sample.receivedMs;
+    if (rx && rx != last_displayed_rx) {
+      parse_to_display.record(millis() - rx);
+      flush_pending_rx = rx;
+      last_displayed_rx = rx;
     }
-    
-    // Clean up old Signal K source
-    if (signalKSource) {
-      Serial.println("[Restart] Cleaning up old SignalK source");
-      if (sourceManager.getCurrentSource() == signalKSource) {
-        sourceManager.switchSource(nullptr, SOURCE_WIFI_SIGNALK);
-      }
-      delete signalKSource;
+  }
+}
+
+void print_latency() {
+  Serial.println("[Latency] Wind update stages:");
+  bool synced = true;
+#if WIND_ENABLE_SIGNALK
+  lock_sources();
+  if (signalKSource) {
+    signalKSource->getServerLatency().print(Serial,
+      signalKSource->isWallClockSynced() ? "server>parse" : "server>parse*");
+    synced = signalKSource->isWallClockSynced();
+  }
+  unlock_sources();
+#endif
+  parse_to_display.print(Serial, "parse>display");
+  parse_to_flush.print(Serial, "parse>flush");
+  if (!synced) {
+    Serial.println("  * no SNTP: relative to the fastest delta seen");
+  }
+}
+
+// Refresh the latency overlay (p50/p95 per stage)
+void update_diag_overlay() {
+  if (lv_obj_has_flag(diag_label, LV_OBJ_FLAG_HIDDEN)) return;
+  
+  // Unlocked: a torn histogram read only skews one overlay refresh, and
+  // waiting here for a slow source update would stall rendering
+  uint32_t s50 = 0, s95 = 0;
+#if WIND_ENABLE_SIGNALK
+  if (signalKSource) {
+    s50 = signalKSource->getServerLatency().percentile(50);
+    s95 = signalKSource->getServerLatency().percentile(95);
+  }
+#endif
+  lv_label_set_text_fmt(diag_label, "srv>parse %lu/%lu\nparse>disp %lu/%lu\nparse>flush %lu/%lu",
+                        (unsigned long)s50, (unsigned long)s95,
+                        (unsigned long)parse_to_display.percentile(50),
+                        (unsigned long)parse_to_display.percentile(95),
+                        (unsigned long)parse_to_flush.percentile(50),
+                        (unsigned long)parse_to_flush.percentile(95));
+}
+
+void status_label_clicked(lv_event_t * e) {
+  if (lv_obj_has_flag(diag_label, LV_OBJ_FLAG_HIDDEN)) {
+    lv_obj_clear_flag(diag_label, LV_OBJ_FLAG_HIDDEN);
+    update_diag_overlay();
+  } else {
+    lv_obj_add_flag(diag_label, LV_OBJ_FLAG_HIDDEN);
+  }
+}
+
+#if WIND_ENABLE_RECORDER
+// Start or stop recording samples to flash; remembered across reboots
+void toggle_recording() {
+  lock_sources();
+  if (recorder.isRecording()) {
+    recorder.stop();
+  } else {
+    recorder.start(&sourceManager);
+  }
+  unlock_sources();
+  windConfig.setRecordSamples(recorder.isRecording());
+  windConfig.save();
+}
+
+// Replace the configured sources with a replay of the recording until
+// the next config save or reboot
+void start_replay(float speed) {
+  lock_sources();
+  recorder.stop();  // Don't record the replay into the file being read
+  sourceManager.switchSource(nullptr, SOURCE_REPLAY);
+  release_retired_sources();
+  LittleFS.begin(true);
+  replay_file = LittleFS.open(WIND_RECORD_FILE, FILE_READ);
+  ReplayWindDataSource* replay = sources.create<ReplayWindDataSource>(
+    windRecordFileRead, (void*)&replay_file, speed);
+  if (!replay_file || !sourceManager.switchSource(replay, SOURCE_REPLAY)) {
+    Serial.println("[Replay] No recording to play");
+    sources.destroy(replay);
+  }
+  unlock_sources();
+}
+#endif
+
+// Single-character commands on the serial console
+void handle_serial_commands() {
+  while (Serial.available()) {
+    char c = Serial.read();
+    switch (c) {
+#if WIND_ENABLE_SIGNALK
+      case 'r':
+        lock_sources();
+        if (signalKSource) {
+          signalKSource->printPathRates(Serial);
+        }
+        unlock_sources();
+        break;
+#endif
+      case 'l':
+        print_latency();
+        break;
+      case 'L':
+#if WIND_ENABLE_SIGNALK
+        lock_sources();
+        if (signalKSource) signalKSource->getServerLatency().reset();
+        unlock_sources();
+#endif
+        parse_to_display.reset();
+        parse_to_flush.reset();
+        Serial.println("[Latency] Reset");
+        break;
+      case 'm':
+        lock_sources();
+        sourceManager.printMetrics(Serial);
+#if WIND_ENABLE_SIGNALK
+        if (signalKSource) signalKSource->printLinkMetrics(Serial);
+#endif
+        unlock_sources();
+        break;
+      case 'M':
+        lock_sources();
+        sourceManager.resetMetrics();
+#if WIND_ENABLE_SIGNALK
+        for (uint8_t i = 0; signalKSource && i < signalKSource->getLinkCount(); i++) {
+          signalKSource->getLink(i)->getMetrics().reset();
+        }
+#endif
+        unlock_sources();
+        Serial.println("[Sources] Metrics reset");
+        break;
+#if WIND_ENABLE_NMEA
+      case 'n':
+        lock_sources();
+        for (uint8_t i = 0; i < sourceManager.getSourceCount(); i++) {
+          if (sourceManager.getSourceType(i) == SOURCE_NMEA) {
+            ((NMEA0183WindDataSource*)sourceManager.getSource(i))->printStats(Serial);
+          }
+        }
+        nmeaOutput.printStats(Serial);
+        unlock_sources();
+        break;
+#endif
+#if WIND_SOURCE_TASK
+      case 'q':
+        sourceTask.printStats(Serial);
+        break;
+#endif
+#if WIND_ENABLE_RECORDER
+      case 'w':
+        toggle_recording();
+        break;
+      case 'p':
+        start_replay(1.0f);
+        break;
+      case 'P':
+        start_replay(WIND_REPLAY_AS_FAST_AS_POSSIBLE);
+        break;
+#endif
+      case '?':
+        Serial.println("Commands: r = Signal K delta rates, l = latency histograms, L = reset latency"
+                       ", m = source metrics, M = reset metrics"
+#if WIND_ENABLE_NMEA
+                       ", n = NMEA 0183 input/output counters"
+#endif
+#if WIND_SOURCE_TASK
+                       ", q = source task queue"
+#endif
+#if WIND_ENABLE_RECORDER
+                       ", w = record on/off, p/P = replay recording at 1x/full speed"
+#endif
+                       );
+        break;
+      default:
+        break;
     }
-    
-    // Create new Signal K source with updated settings
+  }
+}
+
+// Show the current source's connection state, or which backup is
+// feeding the display (only touches LVGL on change)
+void update_status_label() {
+  static const char* last_status = nullptr;
+  WindDataSource* dataSource = sourceManager.getCurrentSource();
+  const char* status = dataSource ? dataSource->getStatusText() : "No source";
+  if (sourceManager.isOnBackup()) {
+    status = sourceManager.getTypeName(sourceManager.getCurrentType());
+  }
+  if (status != last_status) {
+    if (sourceManager.isOnBackup()) {
+      lv_label_set_text_fmt(status_label, "Backup: %s", status);
+    } else {
+      lv_label_set_text(status_label, status);
+    }
+    last_status = status;
+  }
+}
+
+#if WIND_ENABLE_NMEA
+// Start or stop the NMEA output on Serial1 TX; the UART is shared with
+// an NMEA source through NMEA0183Port. Call with the sources locked.
+void configure_nmea_output() {
+  NMEAOutputMode mode = windConfig.getNMEAOutputMode();
+  if (mode == NMEA_OUTPUT_OFF) {
+    nmeaOutput.begin(nullptr, NMEA_OUTPUT_OFF);
+    NMEA0183Port::detachWriter();
+  } else {
+    NMEA0183Port::attachWriter(&Serial1, (int8_t)windConfig.getNMEATxPin(),
+                               windConfig.getNMEABaudRate(), NMEA_OUTPUT_BUFFER);
+    nmeaOutput.begin(&Serial1, mode);
+    nmeaOutput.setRate(windConfig.getNMEAOutputRateHz());
+    nmeaOutput.setSentences(windConfig.getNMEAOutputSentences());
+  }
+  Serial.printf("[NMEA out] Mode %d, TX pin %u\n", mode, windConfig.getNMEATxPin());
+}
+
+// Send due NMEA output; MWD takes the true wind direction from the
+// active source's instruments
+void update_nmea_output() {
+  if (nmeaOutput.getMode() == NMEA_OUTPUT_PASSTHROUGH) {
+    // Sentences are queued where the sources run; write the rest of a burst
+    if (nmeaOutput.getPending()) {
+      lock_sources();
+      nmeaOutput.update(millis());
+      unlock_sources();
+    }
+    return;
+  }
+  if (nmeaOutput.getMode() != NMEA_OUTPUT_GENERATE) return;
+  if (windConfig.getNMEAOutputSentences() & NMEA_OUT_MWD) {
+    lock_sources();
+    const InstrumentState* state = nullptr;
+    DataSourceType type = sourceManager.getCurrentType();
+    if (type == SOURCE_NMEA) {
+      state = &((NMEA0183WindDataSource*)sourceManager.getCurrentSource())->getInstrumentState();
+    }
+#if WIND_ENABLE_SIGNALK
+    if (type == SOURCE_WIFI_SIGNALK && signalKSource && signalKSource->getActiveLink()) {
+      state = &signalKSource->getActiveLink()->getInstrumentState();
+    }
+#endif
+    if (state && state->has(IQ_TRUE_WIND_DIRECTION)) {
+      nmeaOutput.setTrueDirection(state->get(IQ_TRUE_WIND_DIRECTION),
+                                  state->updatedMs[IQ_TRUE_WIND_DIRECTION]);
+    }
+    unlock_sources();
+  }
+  nmeaOutput.update(millis());
+}
+#endif
+
+// Create the source for a configured type in a free registry slot
+// (nullptr if none). Types without an implementation, or left out of
+// this build, run the demo source (or Signal K, then NMEA 0183, in a
+// build without demo);
+// type is updated to match.
+WindDataSource* create_source(DataSourceType& type) {
+#if WIND_ENABLE_SIGNALK
+  if (type == SOURCE_WIFI_SIGNALK) {
     Serial.println("[Restart] Creating new SignalK source");
-    signalKSource = new SignalKWindDataSource(
+    SignalKFailoverSource* sk = sources.create<SignalKFailoverSource>(
       windConfig.getWifiSSID(),
-      windConfig.getWifiPassword(),
-      windConfig.getSignalKHost(),
-      windConfig.getSignalKPort()
+      windConfig.getWifiPassword()
     );
-    
-    if (!sourceManager.switchSource(signalKSource, SOURCE_WIFI_SIGNALK)) {
-      Serial.println("[Restart] SignalK failed, falling back to demo");
-      // Fallback to demo
-      demoSource = new DemoWindDataSource();
-      sourceManager.switchSource(demoSource, SOURCE_DEMO);
+    if (!sk) return nullptr;
+    for (uint8_t i = 0; i < windConfig.getSignalKServerCount(); i++) {
+      sk->addServer(windConfig.getSignalKHost(i), windConfig.getSignalKPort(i));
     }
-  } else {
-    Serial.println("[Restart] Switching to Demo");
-    // Clean up Signal K source if it exists
-    if (signalKSource) {
-      Serial.println("[Restart] Cleaning up SignalK source");
-      if (sourceManager.getCurrentSource() == signalKSource) {
-        sourceManager.switchSource(nullptr, SOURCE_WIFI_SIGNALK);
-      }
-      delete signalKSource;
-      signalKSource = nullptr;
+    sk->setSubscriptions(windConfig.getSignalKSubscriptions());
+    return sk;
+  }
+#endif
+#if WIND_ENABLE_NMEA
+  if (type == SOURCE_NMEA) {
+    Serial.println("[Restart] Creating new NMEA 0183 source");
+    NMEA0183WindDataSource* nmea = sources.create<NMEA0183WindDataSource>(
+      &Serial1,
+      (int8_t)windConfig.getNMEARxPin(),
+      windConfig.getNMEABaudRate()
+    );
+    if (!nmea) return nullptr;
+    nmea->getFilter().setPriority(windConfig.getNMEATalkerPriority());
+    nmea->getFilter().setEchoWindowMs(windConfig.getNMEAEchoMs());
+    // Repeated only in passthrough mode, so with another source active
+    // nothing is sent
+    nmea->setSentenceTap(NMEA0183Output::passthrough, &nmeaOutput);
+    return nmea;
+  }
+#endif
+  if (!WindSources::has(type)) {
+    Serial.printf("[Restart] %s not in this build\n", sourceManager.getTypeName(type));
+  }
+#if WIND_ENABLE_DEMO
+  type = SOURCE_DEMO;
+  Serial.println("[Restart] Creating new demo source");
+  WindSimulatorConfig sim;
+  sim.rateHz = windConfig.getDemoRateHz();
+  sim.seed = windConfig.getDemoSeed();
+  return sources.create<DemoWindDataSource>(sim);
+#elif WIND_ENABLE_SIGNALK
+  if (type == SOURCE_WIFI_SIGNALK) return nullptr;
+  type = SOURCE_WIFI_SIGNALK;
+  return create_source(type);
+#else
+  if (type == SOURCE_NMEA) return nullptr;
+  type = SOURCE_NMEA;
+  return create_source(type);
+#endif
+}
+
+// Restart data sources after config change. The current sources keep
+// the display going until the new primary (or its backup) delivers.
+void restartDataSource() {
+  Serial.println("[Restart] Starting data source restart");
+  DataSourceType sourceType = windConfig.getDataSource();
+  DataSourceType backupType = windConfig.getBackupSource();
+  Serial.printf("[Restart] Target source type: %d, backup: %d\n", sourceType, backupType);
+  
+  lock_sources();
+  sourceManager.setCoalesceWindow(windConfig.getDisplayCoalesceMs());
+  sourceManager.setStaleBudget(windConfig.getSourceStaleMs());
+  
+  // A switch still waiting for its first sample is dropped
+  sourceManager.cancelSwitch();
+  release_retired_sources();
+  
+  Serial.printf("[Restart] Switching to %s\n", sourceManager.getTypeName(sourceType));
+  WindDataSource* primary = create_source(sourceType);
+  if (!primary) {
+    // No free slot for this class (WIND_SOURCE_INSTANCES 1): break before make
+    sourceManager.switchSource(nullptr, sourceType);
+    release_retired_sources();
+    primary = create_source(sourceType);
+  }
+  bool started = primary && sourceManager.beginSwitch(primary, sourceType);
+  if (!started) {
+    sources.destroy(primary);
+    if (sourceManager.getSourceCount()) {
+      Serial.println("[Restart] New source failed, keeping the current one");
+    } else {
+      // begin() fails only on configuration errors (no SSID, server or
+      // port); connection failures are retried by the source itself
+#if WIND_ENABLE_DEMO
+      Serial.printf("[Restart] %s failed, falling back to demo\n", sourceManager.getTypeName(sourceType));
+      sourceType = SOURCE_DEMO;
+      primary = create_source(sourceType);
+      started = sourceManager.switchSource(primary, sourceType);
+#else
+      Serial.printf("[Restart] %s failed, no other source in this build\n", sourceManager.getTypeName(sourceType));
+#endif
     }
-    
-    // Create demo source if needed
-    if (!demoSource) {
-      Serial.println("[Restart] Creating new demo source");
-      demoSource = new DemoWindDataSource();
+  }
+  
+  // Backup runs alongside and takes over when the primary goes stale;
+  // during a switch it starts with the new primary. A type not in this
+  // build is refused rather than replaced by simulated wind.
+  if (started && backupType != SOURCE_NONE && !WindSources::has(backupType)) {
+    Serial.printf("[Restart] Backup %s not in this build, ignored\n", sourceManager.getTypeName(backupType));
+  } else if (started && backupType != SOURCE_NONE) {
+    WindDataSource* backup = create_source(backupType);
+    if (backupType == sourceType) {
+      Serial.println("[Restart] Backup is the same as the primary, ignored");
+      sources.destroy(backup);
+    } else if (sourceManager.addSource(backup, backupType)) {
+      Serial.printf("[Restart] Backup: %s\n", sourceManager.getTypeName(backupType));
+    } else {
+      Serial.println("[Restart] Backup source failed");
+      sources.destroy(backup);
     }
-    sourceManager.switchSource(demoSource, SOURCE_DEMO);
   }
+  refresh_signalk_source();
+#if WIND_ENABLE_NMEA
+  configure_nmea_output();
+#endif
+#if WIND_ENABLE_RECORDER
+  if (windConfig.getRecordSamples()) {
+    recorder.start(&sourceManager);  // No-op if already recording
+  }
+#endif
+  unlock_sources();
+  update_wind_display();  // Show any new units
   Serial.println("[Restart] Data source restart complete");
 }
 
@@ -406,6 +845,19 @@ void setup() {
   lv_obj_set_style_text_color(status_label, lv_color_hex(0x808080), 0);
   lv_obj_set_style_text_font(status_label, &lv_font_montserrat_14, 0);
   lv_obj_align(status_label, LV_ALIGN_TOP_LEFT, 5, 2);
+  lv_obj_add_flag(status_label, LV_OBJ_FLAG_CLICKABLE);
+  lv_obj_add_event_cb(status_label, status_label_clicked, LV_EVENT_CLICKED, NULL);
+  
+  // Latency overlay (p50/p95 ms per stage), hidden until status is tapped
+  diag_label = lv_label_create(lv_screen_active());
+  lv_label_set_text(diag_label, "");
+  lv_obj_set_style_text_color(diag_label, lv_color_white(), 0);
+  lv_obj_set_style_text_font(diag_label, &lv_font_montserrat_14, 0);
+  lv_obj_set_style_bg_color(diag_label, lv_color_black(), 0);
+  lv_obj_set_style_bg_opa(diag_label, LV_OPA_70, 0);
+  lv_obj_set_style_pad_all(diag_label, 3, 0);
+  lv_obj_align(diag_label, LV_ALIGN_TOP_LEFT, 5, 22);
+  lv_obj_add_flag(diag_label, LV_OBJ_FLAG_HIDDEN);
   
   // Menu button (three dots in top right corner)
   menu_btn = lv_button_create(lv_screen_active());
@@ -424,39 +876,61 @@ void setup() {
   
   // Load configuration and start data source
   windConfig.load();
+  sourceManager.setRetireCallback(on_source_retired, nullptr);
+#if WIND_SOURCE_TASK
+  // Samples arrive through the task's queue, drained in loop()
+  if (!sourceTask.begin(&sourceManager)) {
+    Serial.println("[Init] Source task failed, updating source from loop()");
+    sourceManager.subscribe(on_wind_sample, nullptr);
+  }
+#else
+  sourceManager.subscribe(on_wind_sample, nullptr);
+#endif
   restartDataSource();
   
-  update_wind_display();
-  
   // Create config screen
   configScreen = new ConfigScreen(main_screen, &windConfig, &sourceManager, restartDataSource);
 }
 
 void loop() {
-  // Update data source
+#if WIND_SOURCE_TASK
+  // Source runs in its own task; draw only the newest queued sample
+  if (sourceTask.isRunning()) {
+    WindSample sample;
+    bool received = false;
+    while (sourceTask.receive(sample)) received = true;
+    if (received) on_wind_sample(nullptr, sample);
+  } else {
+    sourceManager.update();
+  }
+#else
+  // Update data source; new samples redraw the display via on_wind_sample()
   sourceManager.update();
+#endif
+  // A switch cut over (or gave up): free the sources it stopped
+  if (retired_count) {
+    lock_sources();
+    release_retired_sources();
+    unlock_sources();
+  }
   
-  // Update display
-  static unsigned long last_display_update = 0;
-  if (millis() - last_display_update > 100) {
-    update_wind_display();
-    
-    // Update status
-    if (sourceManager.getCurrentType() == SOURCE_WIFI_SIGNALK) {
-      if (WiFi.status() == WL_CONNECTED) {
-        if (sourceManager.isConnected()) {
-          lv_label_set_text(status_label, "SignalK");
-        } else {
-          lv_label_set_text(status_label, "WiFi OK");
-        }
-      } else {
-        lv_label_set_text(status_label, "WiFi...");
-      }
-    } else {
-      lv_label_set_text(status_label, "Demo");
-    }
-    
-    last_display_update = millis();
+#if WIND_ENABLE_RECORDER
+  if (!recorder.update()) {
+    lock_sources();
+    recorder.stop();   // File error; the config still asks to record after a restart
+    unlock_sources();
+  }
+#endif
+#if WIND_ENABLE_NMEA
+  update_nmea_output();
+#endif
+  update_status_label();
+  handle_serial_commands();
+  
+  static unsigned long last_diag_update = 0;
+  if (millis() - last_diag_update > 1000) {
+    update_diag_overlay();
+    last_diag_update = millis();
   }
   
   lv_timer_handler();
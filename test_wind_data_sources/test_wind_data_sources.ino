@@ -6,15 +6,47 @@
   Tests:
   - WindDataSource interface implementation
   - DemoWindDataSource behavior
+  - Wind simulator determinism, gusts, tacks and apparent/true wind
   - MockWindDataSource functionality
+  - WindSample snapshots and history ring
+  - Sample subscribers and coalescing
+  - SPSC sample queue (source task hand-off)
   - WindDataSourceManager switching
+  - Priority failover between sources
+  - Per-source health and throughput metrics
+  - Make-before-break source switching
+  - Source registry and allocation-free lifecycle (heap over 1000 switches)
+  - Signal K server failover on a silent server under the instant policy
+  - Sample recording format and replay
+  - NMEA 0183 parser, wind sentences and receive ring
+  - NMEA 0183 instrument sentences and true wind
+  - NMEA 0183 talker priority, duplicate and echo suppression
+  - NMEA 0183 output: sentence format, rate, non-blocking writes, passthrough
   - Unit conversions
+  - Signal K delta parser
+  - Signal K frame filter
+  - Signal K path table
+  - Signal K timestamps and latency histogram
+  - Signal K REST snapshot body
 */
 
 #include "WindDataSource.h"
 #include "DemoWindDataSource.h"
 #include "MockWindDataSource.h"
 #include "WindDataSourceManager.h"
+#include "SignalKDeltaParser.h"
+#include "SignalKFrameFilter.h"
+#include "SignalKPathTable.h"
+#include "SignalKTimestamp.h"
+#include "LatencyHistogram.h"
+#include "SignalKRestSnapshot.h"
+#include "SpscQueue.h"
+#include "StaticSlot.h"
+#include "WindSourceRegistry.h"
+#include "WindRecordingFormat.h"
+#include "ReplayWindDataSource.h"
+#include "NMEA0183WindDataSource.h"
+#include "NMEA0183Output.h"
 
 // Test counters
 int tests_passed = 0;
@@ -103,6 +135,192 @@ void test_mock_source() {
   Serial.println("Mock source tests complete");
 }
 
+void test_wind_samples() {
+  Serial.println("\n=== Testing WindSample history ===");
+  
+  MockWindDataSource mock;
+  mock.begin();
+  TEST_ASSERT_EQUAL(0, mock.getLatestSample().sequence, "No sample before first publish");
+  
+  mock.setWindSpeed(5.0);
+  mock.setWindAngle(90.0);
+  mock.publish(1766897238990LL);
+  WindSample sample = mock.getLatestSample();
+  TEST_ASSERT_EQUAL(1, sample.sequence, "First sample gets sequence 1");
+  TEST_ASSERT(sample.hasSpeed() && sample.hasAngle(), "Sample carries both fields");
+  TEST_ASSERT(sample.sourceTime == 1766897238990LL, "Sample keeps source timestamp");
+  
+  for (int i = 0; i < WIND_SAMPLE_HISTORY + 5; i++) {
+    mock.setWindSpeed(i);
+    mock.publish();
+  }
+  const WindSampleRing& history = mock.getHistory();
+  TEST_ASSERT_EQUAL(WIND_SAMPLE_HISTORY, history.size(), "History holds a fixed number of samples");
+  TEST_ASSERT_EQUAL(WIND_SAMPLE_HISTORY + 4, history.at(0).speed, "Newest sample at age 0");
+  TEST_ASSERT_EQUAL(5, history.at(WIND_SAMPLE_HISTORY - 1).speed, "Oldest retained sample at the end");
+  
+  Serial.println("WindSample tests complete");
+}
+
+struct ReceivedSamples {
+  int count;
+  float lastSpeed;
+};
+
+void count_sample(void* context, const WindSample& sample) {
+  ReceivedSamples* r = (ReceivedSamples*)context;
+  r->count++;
+  r->lastSpeed = sample.speed;
+}
+
+void test_wind_simulator() {
+  Serial.println("\n=== Testing wind simulator ===");
+  
+  WindSimulatorConfig config;
+  config.rateHz = 10;
+  config.seed = 42;
+  config.tackInterval = 60;
+  WindSimulator a(config), b(config);
+  bool identical = true;
+  for (int i = 0; i < 1000; i++) {
+    a.step();
+    b.step();
+    if (a.getApparentSpeed() != b.getApparentSpeed() || a.getHeading() != b.getHeading()) identical = false;
+  }
+  TEST_ASSERT(identical, "Same seed gives the same sequence");
+  float first = a.getApparentSpeed();
+  a.reset();
+  for (int i = 0; i < 1000; i++) a.step();
+  TEST_ASSERT(a.getApparentSpeed() == first, "reset() replays the seed");
+  config.seed = 43;
+  WindSimulator other(config);
+  for (int i = 0; i < 1000; i++) other.step();
+  TEST_ASSERT(other.getApparentSpeed() != first, "Other seed gives other wind");
+  
+  // Ten simulated minutes
+  WindSimulator sim(config);
+  double sum = 0, sum_sq = 0;
+  int tacks = 0, upwind = 0, samples = 0;
+  bool starboard = sim.isStarboardTack();
+  for (int i = 0; i < 6000; i++) {
+    sim.step();
+    sum += sim.getTrueSpeed();
+    sum_sq += sim.getTrueSpeed() * sim.getTrueSpeed();
+    if (sim.isStarboardTack() != starboard) {
+      starboard = sim.isStarboardTack();
+      tacks++;
+    }
+    if (!sim.isTacking()) {
+      samples++;
+      float twa = fabs(sim.getTrueAngle() > 180 ? sim.getTrueAngle() - 360 : sim.getTrueAngle());
+      float awa = fabs(sim.getApparentAngle() > 180 ? sim.getApparentAngle() - 360 : sim.getApparentAngle());
+      if (sim.getApparentSpeed() > sim.getTrueSpeed() && awa < twa) upwind++;
+    }
+  }
+  float mean = sum / 6000;
+  float stddev = sqrt(sum_sq / 6000 - mean * mean);
+  Serial.printf("True wind %.2f +/- %.2f m/s, %d tacks\n", mean, stddev, tacks);
+  TEST_ASSERT_NEAR(config.meanSpeed, mean, config.meanSpeed * 0.2, "Mean true wind near configured");
+  TEST_ASSERT(stddev > 0.2 && stddev < 2.0, "Gusts vary the true wind");
+  TEST_ASSERT(tacks >= 8 && tacks <= 11, "Tacks at the configured interval");
+  TEST_ASSERT(upwind > samples * 9 / 10, "Upwind: apparent wind stronger and further forward than true");
+  
+  WindSample sample = sim.sample();
+  TEST_ASSERT(sample.hasSpeed() && sample.hasAngle() && sample.hasTrue(), "Sample carries apparent and true wind");
+  TEST_ASSERT(sample.trueSpeed == sim.getTrueSpeed(), "True speed in sample");
+  
+  config.rateHz = 200;
+  TEST_ASSERT_EQUAL(WIND_SIM_MAX_RATE_HZ, WindSimulator(config).getRateHz(), "Rate capped at 50 Hz");
+  
+  // 50 Hz demo source
+  config.rateHz = 50;
+  DemoWindDataSource fast(config);
+  ReceivedSamples received = {};
+  fast.subscribe(count_sample, &received);
+  fast.begin();
+  unsigned long start = millis();
+  while (millis() - start < 200) {
+    fast.update();
+    delay(1);
+  }
+  TEST_ASSERT(received.count >= 8 && received.count <= 11, "50 Hz demo publishes every 20 ms");
+  TEST_ASSERT(fast.getLatestSample().hasTrue(), "Demo samples carry true wind");
+  fast.stop();
+  
+  Serial.println("Simulator tests complete");
+}
+
+void test_sample_subscribers() {
+  Serial.println("\n=== Testing sample subscribers ===");
+  
+  WindDataSourceManager manager;
+  MockWindDataSource mock;
+  ReceivedSamples received = {};
+  manager.subscribe(count_sample, &received);
+  manager.switchSource(&mock, SOURCE_DEMO);
+  
+  mock.setWindSpeed(1.0);
+  mock.publish();
+  TEST_ASSERT_EQUAL(1, received.count, "Sample pushed through manager without polling");
+  
+  // Burst inside the window: first goes out, newest is held
+  manager.setCoalesceWindow(60000);
+  mock.setWindSpeed(2.0);
+  mock.publish();
+  mock.setWindSpeed(3.0);
+  mock.publish();
+  manager.update();
+  TEST_ASSERT_EQUAL(1, received.count, "Samples inside coalescing window are held");
+  
+  manager.setCoalesceWindow(0);
+  manager.update();
+  TEST_ASSERT_EQUAL(2, received.count, "Held sample delivered when window closes");
+  TEST_ASSERT_EQUAL(3.0, received.lastSpeed, "Only the newest held sample is delivered");
+  
+  manager.switchSource(nullptr, SOURCE_DEMO);
+  mock.publish();
+  TEST_ASSERT_EQUAL(2, received.count, "Previous source no longer delivers after switch");
+  
+  Serial.println("Sample subscriber tests complete");
+}
+
+void test_spsc_queue() {
+  Serial.println("\n=== Testing SPSC sample queue ===");
+  
+  SpscQueue<WindSample, 4> queue;
+  WindSample sample = {};
+  WindSample out;
+  TEST_ASSERT(!queue.pop(out), "Empty queue pops nothing");
+  
+  for (int i = 1; i <= 4; i++) {
+    sample.speed = i;
+    queue.push(sample);
+  }
+  sample.speed = 5;
+  TEST_ASSERT(!queue.push(sample), "Push to full queue fails");
+  TEST_ASSERT_EQUAL(1, queue.getOverruns(), "Overrun counted");
+  TEST_ASSERT_EQUAL(4, queue.getMaxDepth(), "Max depth reaches capacity");
+  
+  queue.pop(out);
+  TEST_ASSERT_EQUAL(1.0, out.speed, "Oldest sample popped first");
+  
+  // Wrap around the end of the array
+  sample.speed = 6;
+  queue.push(sample);
+  float last = 0;
+  int popped = 0;
+  while (queue.pop(out)) {
+    last = out.speed;
+    popped++;
+  }
+  TEST_ASSERT_EQUAL(4, popped, "All queued samples drained after wrap");
+  TEST_ASSERT_EQUAL(6.0, last, "Newest sample last, dropped one skipped");
+  TEST_ASSERT_EQUAL(0, queue.depth(), "Queue empty after drain");
+  TEST_ASSERT_EQUAL(4, queue.getMaxDepth(), "Max depth kept after drain");
+  
+  Serial.println("SPSC queue tests complete");
+}
+
 void test_source_manager() {
   Serial.println("\n=== Testing WindDataSourceManager ===");
   
@@ -135,6 +353,826 @@ void test_source_manager() {
   Serial.println("Manager tests complete");
 }
 
+void test_source_failover() {
+  Serial.println("\n=== Testing source failover ===");
+  
+  WindDataSourceManager manager;
+  MockWindDataSource primary;
+  MockWindDataSource backup;
+  ReceivedSamples received = {};
+  manager.subscribe(count_sample, &received);
+  manager.setStaleBudget(20);
+  manager.setFailbackHold(40);
+  manager.switchSource(&primary, SOURCE_WIFI_SIGNALK);
+  TEST_ASSERT(manager.addSource(&backup, SOURCE_NMEA), "Backup source added");
+  TEST_ASSERT_EQUAL(2, manager.getSourceCount(), "Both sources running");
+  
+  primary.setWindSpeed(1.0);
+  primary.publish();
+  backup.setWindSpeed(2.0);
+  backup.publish();
+  TEST_ASSERT(manager.getCurrentSource() == &primary, "Primary feeds display while fresh");
+  TEST_ASSERT_EQUAL(1.0, received.lastSpeed, "Backup samples not delivered while primary is fresh");
+  
+  // Primary goes quiet past the staleness budget
+  delay(30);
+  backup.publish();
+  TEST_ASSERT(manager.isOnBackup(), "Backup takes over when primary is stale");
+  TEST_ASSERT(manager.getCurrentType() == SOURCE_NMEA, "Current type is the backup's");
+  TEST_ASSERT_EQUAL(2.0, received.lastSpeed, "Backup sample delivered after switch");
+  
+  // Primary returns but must hold before taking over again
+  primary.publish();
+  TEST_ASSERT(manager.isOnBackup(), "Returning primary waits for failback hold");
+  for (int i = 0; i < 5; i++) {
+    delay(10);
+    primary.publish();
+    backup.publish();
+  }
+  TEST_ASSERT(!manager.isOnBackup(), "Primary restored after failback hold");
+  TEST_ASSERT_EQUAL(2, manager.getSourceSwitches(), "Two switches counted");
+  
+  manager.switchSource(nullptr, SOURCE_DEMO);
+  TEST_ASSERT_EQUAL(0, manager.getSourceCount(), "Switching to nothing stops all sources");
+  TEST_ASSERT(!backup.isConnected(), "Backup stopped with the rest");
+  
+  Serial.println("Failover tests complete");
+}
+
+void test_source_metrics() {
+  Serial.println("\n=== Testing source metrics ===");
+  
+  WindDataSourceManager manager;
+  MockWindDataSource mock;
+  manager.switchSource(&mock, SOURCE_NMEA);
+  const WindSourceMetrics* m = manager.getMetrics(0);
+  TEST_ASSERT(m != nullptr, "Metrics readable for a running source");
+  TEST_ASSERT(manager.getMetrics(1) == nullptr, "No metrics past the last source");
+  TEST_ASSERT_EQUAL(UINT32_MAX, m->sinceLastSample(millis()), "No sample yet");
+  
+  for (int i = 0; i < 3; i++) {
+    mock.publish();
+    manager.update();
+    delay(10);
+  }
+  TEST_ASSERT_EQUAL(3, m->samples, "Published samples counted");
+  TEST_ASSERT_EQUAL(2, m->interArrival.getCount(), "Inter-arrival recorded between samples");
+  TEST_ASSERT(m->interArrival.getMin() >= 10, "Inter-arrival matches the spacing");
+  TEST_ASSERT(m->sinceLastSample(millis()) >= 10, "Time since last sample grows");
+  TEST_ASSERT_EQUAL(3, m->updates, "Every update() timed");
+  TEST_ASSERT(m->updateMaxUs >= m->getUpdateMeanUs(), "Max update time not below mean");
+  
+  WindSourceMetrics link;
+  link.messages = 5;
+  link.bytes = 300;
+  link.parseErrors = 1;
+  link.reconnects = 2;
+  mock.getMetrics().addCounters(link);
+  mock.getMetrics().addCounters(link);
+  TEST_ASSERT_EQUAL(10, m->messages, "Link messages summed");
+  TEST_ASSERT_EQUAL(600, m->bytes, "Link bytes summed");
+  TEST_ASSERT_EQUAL(4, m->reconnects, "Link reconnects summed");
+  
+  manager.printMetrics(Serial);
+  manager.resetMetrics();
+  TEST_ASSERT_EQUAL(0, m->samples, "Reset clears samples");
+  TEST_ASSERT_EQUAL(0, m->messages, "Reset clears counters");
+  
+  manager.switchSource(nullptr, SOURCE_DEMO);
+  Serial.println("Metrics tests complete");
+}
+
+struct RetiredSources {
+  WindDataSource* sources[4];
+  int count;
+};
+
+void record_retired(void* context, WindDataSource* source) {
+  RetiredSources* r = (RetiredSources*)context;
+  if (r->count < 4) r->sources[r->count] = source;
+  r->count++;
+}
+
+void test_make_before_break() {
+  Serial.println("\n=== Testing make-before-break switching ===");
+  
+  WindDataSourceManager manager;
+  MockWindDataSource old_source;
+  MockWindDataSource new_source;
+  ReceivedSamples received = {};
+  RetiredSources retired = {};
+  manager.subscribe(count_sample, &received);
+  manager.setRetireCallback(record_retired, &retired);
+  
+  // Nothing running yet: switches at once
+  TEST_ASSERT(manager.beginSwitch(&old_source, SOURCE_DEMO), "First source starts");
+  TEST_ASSERT(!manager.isSwitching(), "No switch pending without a current source");
+  old_source.setWindSpeed(1.0);
+  old_source.publish();
+  
+  TEST_ASSERT(manager.beginSwitch(&new_source, SOURCE_WIFI_SIGNALK), "New source starts in the background");
+  TEST_ASSERT(manager.isSwitching(), "Switch pending");
+  TEST_ASSERT(manager.getCurrentSource() == &old_source, "Old source still current");
+  TEST_ASSERT(old_source.isConnected(), "Old source keeps running");
+  old_source.setWindSpeed(1.5);
+  old_source.publish();
+  TEST_ASSERT_EQUAL(1.5, received.lastSpeed, "Old source still drives the display");
+  
+  new_source.setWindSpeed(3.0);
+  new_source.publishEmpty();
+  TEST_ASSERT(manager.isSwitching(), "Sample without values does not cut over");
+  new_source.publish();
+  TEST_ASSERT(!manager.isSwitching(), "First valid sample cuts over");
+  TEST_ASSERT(manager.getCurrentSource() == &new_source, "New source current");
+  TEST_ASSERT(manager.getCurrentType() == SOURCE_WIFI_SIGNALK, "Current type follows the switch");
+  TEST_ASSERT_EQUAL(3.0, received.lastSpeed, "Cut-over sample delivered");
+  TEST_ASSERT(!old_source.isConnected(), "Old source stopped at cut-over");
+  TEST_ASSERT(retired.count == 1 && retired.sources[0] == &old_source, "Old source retired");
+  old_source.publish();
+  TEST_ASSERT_EQUAL(3.0, received.lastSpeed, "Old source no longer delivers");
+  
+  // New source fails to begin: current one carries on
+  MockWindDataSource broken;
+  broken.setFailBegin(true);
+  TEST_ASSERT(!manager.beginSwitch(&broken, SOURCE_NMEA), "Failed begin reported");
+  TEST_ASSERT(!manager.isSwitching(), "No switch after failed begin");
+  TEST_ASSERT(manager.getCurrentSource() == &new_source, "Current source kept after failed begin");
+  
+  // New source never delivers: abandoned after the timeout
+  MockWindDataSource silent;
+  manager.setSwitchTimeout(20);
+  TEST_ASSERT(manager.beginSwitch(&silent, SOURCE_NMEA), "Silent source starts");
+  delay(30);
+  manager.update();
+  TEST_ASSERT(!manager.isSwitching(), "Switch abandoned after timeout");
+  TEST_ASSERT(manager.getCurrentSource() == &new_source, "Current source kept after timeout");
+  TEST_ASSERT(!silent.isConnected(), "Silent source stopped");
+  TEST_ASSERT(retired.count == 2 && retired.sources[1] == &silent, "Silent source retired");
+  TEST_ASSERT_EQUAL(1, manager.getSwitchesCompleted(), "One switch completed");
+  TEST_ASSERT_EQUAL(2, manager.getSwitchesAbandoned(), "Two switches abandoned");
+  
+  // A new backup that delivers at once waits for the new primary
+  MockWindDataSource next_primary;
+  MockWindDataSource next_backup;
+  new_source.publish();
+  TEST_ASSERT(manager.beginSwitch(&next_primary, SOURCE_NMEA), "New primary starts");
+  TEST_ASSERT(manager.addSource(&next_backup, SOURCE_DEMO), "Backup joins the new sources");
+  next_backup.setWindSpeed(5.0);
+  next_backup.publish();
+  TEST_ASSERT(manager.isSwitching(), "New backup does not cut over while the current source is fresh");
+  TEST_ASSERT_EQUAL(3.0, received.lastSpeed, "Current source still drives the display");
+  next_primary.setWindSpeed(4.0);
+  next_primary.publish();
+  TEST_ASSERT(!manager.isSwitching(), "New primary cuts over");
+  TEST_ASSERT(manager.getCurrentSource() == &next_primary, "New primary current");
+  TEST_ASSERT(retired.count == 3 && retired.sources[2] == &new_source, "Old source retired at cut-over");
+  
+  // With the current sources stale, a new backup is better than nothing
+  MockWindDataSource last_primary;
+  MockWindDataSource last_backup;
+  manager.setStaleBudget(10);
+  TEST_ASSERT(manager.beginSwitch(&last_primary, SOURCE_WIFI_SIGNALK), "Another switch starts");
+  manager.addSource(&last_backup, SOURCE_DEMO);
+  delay(20);
+  last_backup.publish();
+  TEST_ASSERT(!manager.isSwitching(), "New backup cuts over when nothing current is fresh");
+  TEST_ASSERT(manager.getCurrentSource() == &last_backup, "New backup current");
+  TEST_ASSERT_EQUAL(5, retired.count, "Both old sources retired");
+  
+  manager.switchSource(nullptr, SOURCE_DEMO);
+  TEST_ASSERT_EQUAL(7, retired.count, "Stopping all retires the rest");
+  Serial.println("Make-before-break tests complete");
+}
+
+// Slots are global like in the main sketch; a failover source is too
+// big for the loop task's stack
+WindSources test_sources;
+StaticSlot<MockWindDataSource> test_mock_slot;
+
+void cycle_sources(WindDataSourceManager& manager) {
+  MockWindDataSource* mock = test_mock_slot.create();
+  manager.switchSource(mock, SOURCE_NMEA);
+  mock->publish();
+  manager.update();
+  
+  test_sources.create<DemoWindDataSource>();
+  SignalKFailoverSource* sk = test_sources.create<SignalKFailoverSource>("boat", "secret");
+  sk->addServer("10.10.10.1", 3000);
+  sk->addServer("10.10.10.2", 3000);
+  
+  manager.switchSource(nullptr, SOURCE_DEMO);
+  test_sources.destroyAll();
+  test_mock_slot.destroy();
+}
+
+void test_static_source_slots() {
+  Serial.println("\n=== Testing allocation-free source lifecycle ===");
+  
+  // Registry lookups by configured type
+  DemoWindDataSource* demo = test_sources.create<DemoWindDataSource>();
+  TEST_ASSERT(WindSources::has(SOURCE_DEMO) && WindSources::has(SOURCE_WIFI_SIGNALK),
+              "Default build registers demo and Signal K");
+  TEST_ASSERT(WindSources::has(SOURCE_NMEA), "Default build registers NMEA 0183");
+  TEST_ASSERT(!WindSources::has(SOURCE_BLE), "Unimplemented type not registered");
+  TEST_ASSERT(test_sources.find(SOURCE_DEMO) == demo, "Registry finds created source by type");
+  TEST_ASSERT(test_sources.find(SOURCE_WIFI_SIGNALK) == nullptr, "Registry returns nullptr before create");
+  DemoWindDataSource* next = test_sources.create<DemoWindDataSource>();
+  TEST_ASSERT(next && next != demo, "Second instance for a switch");
+  TEST_ASSERT(test_sources.create<DemoWindDataSource>() == nullptr, "No third instance");
+  TEST_ASSERT(test_sources.destroy(demo), "Destroy by pointer");
+  TEST_ASSERT(test_sources.find(SOURCE_DEMO) == next, "Other instance still live");
+  test_sources.destroyAll();
+  
+  WindDataSourceManager manager;
+  cycle_sources(manager);  // First use may allocate (Serial, statics)
+  
+  uint32_t free_before = ESP.getFreeHeap();
+  uint32_t largest_before = ESP.getMaxAllocHeap();
+  for (int i = 0; i < 1000; i++) {
+    cycle_sources(manager);
+  }
+  uint32_t free_after = ESP.getFreeHeap();
+  uint32_t largest_after = ESP.getMaxAllocHeap();
+  Serial.printf("Free heap %lu -> %lu, largest block %lu -> %lu\n",
+                (unsigned long)free_before, (unsigned long)free_after,
+                (unsigned long)largest_before, (unsigned long)largest_after);
+  
+  TEST_ASSERT(free_after >= free_before, "Free heap flat over 1000 source switches");
+  TEST_ASSERT(largest_after >= largest_before, "Largest free block flat over 1000 source switches");
+  TEST_ASSERT(test_sources.get<SignalKFailoverSource>() == nullptr, "Slot empty after destroy");
+  
+  Serial.println("Source lifecycle tests complete");
+}
+
+void test_signalk_server_failover() {
+  Serial.println("\n=== Testing Signal K server failover (instant policy) ===");
+  
+  SignalKFailoverSource* sk = test_sources.create<SignalKFailoverSource>("boat", "secret");
+  sk->addServer("10.10.10.1", 3000);
+  sk->addServer("10.10.10.2", 3000);
+  SignalKSubscription subs[SIGNALK_DEFAULT_PATH_COUNT];
+  for (size_t i = 0; i < SIGNALK_DEFAULT_PATH_COUNT; i++) {
+    subs[i] = signalKDefaultSubscription(SIGNALK_DEFAULT_PATHS[i].quantity);
+  }
+  sk->setSubscriptions(subs);
+  TEST_ASSERT(sk->begin(), "Failover source starts");
+  
+  ReceivedSamples received = {};
+  sk->subscribe(count_sample, &received);
+  
+  SignalKWindDataSource* primary = sk->getLink(0);
+  SignalKWindDataSource* backup = sk->getLink(1);
+  char delta[] =
+    "{\"context\":\"vessels.self\",\"updates\":[{\"values\":["
+    "{\"path\":\"environment.wind.speedApparent\",\"value\":6.2}]}]}";
+  char gust[] =
+    "{\"context\":\"vessels.self\",\"updates\":[{\"values\":["
+    "{\"path\":\"environment.wind.speedApparent\",\"value\":8.4}]}]}";
+  primary->receiveEvent(WStype_CONNECTED, nullptr, 0);
+  backup->receiveEvent(WStype_CONNECTED, nullptr, 0);
+  primary->receiveEvent(WStype_TEXT, (uint8_t*)delta, strlen(delta));
+  primary->receiveEvent(WStype_TEXT, (uint8_t*)gust, strlen(gust));
+  backup->receiveEvent(WStype_TEXT, (uint8_t*)delta, strlen(delta));
+  sk->update();
+  TEST_ASSERT_EQUAL(0, sk->getActiveIndex(), "Primary active while both stream");
+  TEST_ASSERT_EQUAL(2, received.count, "Every active-link sample forwarded, backup's not");
+  TEST_ASSERT_NEAR(8.4, received.lastSpeed, 0.001, "Newest active-link sample last");
+  
+  // Steady wind: no deltas, but both servers answer the heartbeat
+  delay(SK_ALIVE_WINDOW + 100);
+  primary->receiveEvent(WStype_PONG, nullptr, 0);
+  backup->receiveEvent(WStype_PONG, nullptr, 0);
+  sk->update();
+  TEST_ASSERT_EQUAL(0, sk->getActiveIndex(), "Quiet primary answering pings stays active");
+  TEST_ASSERT_EQUAL(0, sk->getFailovers(), "No failover in a steady wind");
+  
+  // Primary hangs: no pong, still subscribed as far as its state goes
+  delay(SK_ALIVE_WINDOW + 100);
+  backup->receiveEvent(WStype_PONG, nullptr, 0);
+  sk->update();
+  TEST_ASSERT(primary->getState() == SK_STATE_SUBSCRIBED || primary->getState() == SK_STATE_STREAMING,
+              "Hung primary still looks subscribed");
+  TEST_ASSERT(!primary->isAlive(millis()), "Hung primary is not alive");
+  TEST_ASSERT_EQUAL(1, sk->getActiveIndex(), "Backup takes over from a hung primary");
+  
+  test_sources.destroyAll();
+  Serial.println("Signal K server failover tests complete");
+}
+
+struct MemoryReader {
+  const uint8_t* data;
+  size_t length;
+  size_t pos;
+};
+
+size_t read_memory(void* context, uint8_t* buffer, size_t length) {
+  MemoryReader* r = (MemoryReader*)context;
+  size_t n = r->length - r->pos < length ? r->length - r->pos : length;
+  memcpy(buffer, r->data + r->pos, n);
+  r->pos += n;
+  return n;
+}
+
+void test_wind_recording() {
+  Serial.println("\n=== Testing sample recording and replay ===");
+  
+  WindSample in[4] = {};
+  in[0].speed = 5.14; in[0].angle = 359.9; in[0].receivedMs = 1000;
+  in[0].sourceTime = 1700000000000LL; in[0].valid = WIND_SAMPLE_SPEED_VALID | WIND_SAMPLE_ANGLE_VALID;
+  in[1].speed = 5.30; in[1].angle = 0.2; in[1].receivedMs = 1100;
+  in[1].sourceTime = 1700000000100LL; in[1].valid = WIND_SAMPLE_SPEED_VALID | WIND_SAMPLE_ANGLE_VALID;
+  in[2].speed = 6.0; in[2].receivedMs = 1200; in[2].valid = WIND_SAMPLE_SPEED_VALID;
+  in[3].angle = 180.0; in[3].receivedMs = 1350; in[3].valid = WIND_SAMPLE_ANGLE_VALID;
+  
+  uint8_t data[256];
+  WindRecordCodec encoder;
+  size_t n = encoder.writeHeader(data);
+  size_t first_record = n;
+  for (int i = 0; i < 4; i++) {
+    n += encoder.encode(in[i], data + n);
+  }
+  uint8_t scratch[WIND_RECORD_MAX_SIZE];
+  WindRecordCodec sizer;
+  sizer.encode(in[0], scratch);
+  TEST_ASSERT(sizer.encode(in[1], scratch) <= 6, "Steady 10 Hz sample encodes in a few bytes");
+  
+  // Second segment, as after a reboot (time starts again)
+  n += encoder.writeHeader(data + n);
+  WindSample late = {};
+  late.speed = 1.0; late.receivedMs = 50; late.valid = WIND_SAMPLE_SPEED_VALID;
+  n += encoder.encode(late, data + n);
+  
+  WindRecordCodec decoder;
+  WindSample out[5];
+  size_t pos = 0, used;
+  int samples = 0, segments = 0;
+  while (pos < n) {
+    WindRecordResult r = decoder.decode(data + pos, n - pos, used, out[samples < 5 ? samples : 4]);
+    if (r == WIND_RECORD_SAMPLE) samples++;
+    else if (r == WIND_RECORD_SEGMENT) segments++;
+    else break;
+    pos += used;
+  }
+  TEST_ASSERT_EQUAL(5, samples, "All recorded samples decoded");
+  TEST_ASSERT_EQUAL(2, segments, "Both segments found");
+  TEST_ASSERT_NEAR(5.14, out[0].speed, 0.006, "Speed kept to 0.01 m/s");
+  TEST_ASSERT_NEAR(0.2, out[1].angle, 0.06, "Angle delta wraps through north");
+  TEST_ASSERT(out[1].sourceTime == 1700000000100LL, "Source time restored exactly");
+  TEST_ASSERT_EQUAL(1200, out[2].receivedMs, "Receive time restored from deltas");
+  TEST_ASSERT(out[2].hasSpeed() && !out[2].hasAngle() && out[2].sourceTime == 0, "Validity and missing source time kept");
+  TEST_ASSERT_EQUAL(50, out[4].receivedMs, "New segment restarts the delta state");
+  
+  decoder.reset();
+  TEST_ASSERT(decoder.decode(data + first_record, 2, used, out[0]) == WIND_RECORD_NEED_MORE, "Partial record needs more data");
+  uint8_t junk = 0x10;
+  TEST_ASSERT(decoder.decode(&junk, 1, used, out[0]) == WIND_RECORD_CORRUPT, "Unknown flags rejected");
+  
+  // Replay as fast as possible, twice: identical samples in order
+  float speeds[2][5];
+  for (int run = 0; run < 2; run++) {
+    MemoryReader reader = {data, n, 0};
+    ReplayWindDataSource replay(read_memory, &reader, WIND_REPLAY_AS_FAST_AS_POSSIBLE);
+    TEST_ASSERT(replay.begin(), "Replay accepts recording");
+    while (!replay.isFinished()) replay.update();
+    TEST_ASSERT_EQUAL(5, replay.getPlayed(), "Replay publishes every sample");
+    if (run == 0) {
+      TEST_ASSERT_EQUAL(7, replay.getMetrics().messages, "Replay counts records and headers");
+      TEST_ASSERT_EQUAL(n, replay.getMetrics().bytes, "Replay counts bytes read");
+    }
+    for (int i = 0; i < 5; i++) speeds[run][i] = replay.getHistory().at(4 - i).speed;
+  }
+  TEST_ASSERT(memcmp(speeds[0], speeds[1], sizeof(speeds[0])) == 0, "Replay is deterministic");
+  
+  // 10x: 350 ms of recording takes at least 30 ms
+  MemoryReader reader = {data, n, 0};
+  ReplayWindDataSource timed(read_memory, &reader, 10.0);
+  timed.begin();
+  unsigned long start = millis();
+  while (!timed.isFinished() && millis() - start < 1000) timed.update();
+  TEST_ASSERT(millis() - start >= 30, "Timed replay keeps recorded spacing");
+  
+  MemoryReader bad = {(const uint8_t*)"not a recording", 15, 0};
+  ReplayWindDataSource rejected(read_memory, &bad, 1.0);
+  TEST_ASSERT(!rejected.begin(), "Replay rejects data without header");
+  
+  Serial.println("Recording tests complete");
+}
+
+struct NMEAReceived {
+  int count;
+  char last[8];
+  uint8_t fields;
+};
+
+void count_nmea(void* context, const NMEASentence& sentence) {
+  NMEAReceived* r = (NMEAReceived*)context;
+  r->count++;
+  snprintf(r->last, sizeof(r->last), "%s%s", sentence.talker, sentence.type);
+  r->fields = sentence.fieldCount;
+}
+
+void test_nmea0183() {
+  Serial.println("\n=== Testing NMEA 0183 parser and source ===");
+  
+  NMEA0183Parser parser;
+  NMEAReceived received = {};
+  parser.setHandler(count_nmea, &received);
+  const char* good = "$WIMWV,045.0,R,10.0,N,A*13\r\n";
+  parser.feed((const uint8_t*)good, strlen(good));
+  TEST_ASSERT_EQUAL(1, received.count, "Valid sentence passed on");
+  TEST_ASSERT(strcmp(received.last, "WIMWV") == 0, "Talker and type split");
+  TEST_ASSERT_EQUAL(5, received.fields, "Fields counted");
+  const char* corrupt = "$WIMWV,045.0,R,10.0,N,A*14\r\n";
+  parser.feed((const uint8_t*)corrupt, strlen(corrupt));
+  TEST_ASSERT_EQUAL(1, received.count, "Bad checksum dropped");
+  TEST_ASSERT_EQUAL(1, parser.getChecksumErrors(), "Checksum error counted");
+  
+  // Longer than 82 bytes: dropped, and the next sentence still parses
+  parser.feed((const uint8_t*)"$IIXDR", 6);
+  for (int i = 0; i < 100; i++) parser.feed((uint8_t)'A');
+  parser.feed((const uint8_t*)"\r\n", 2);
+  TEST_ASSERT_EQUAL(1, parser.getOverruns(), "Overlong sentence counted as overrun");
+  parser.feed((const uint8_t*)"$WIMWV,04", 9);
+  parser.feed((const uint8_t*)good, strlen(good));
+  TEST_ASSERT_EQUAL(2, received.count, "Parser recovers after overrun");
+  TEST_ASSERT_EQUAL(1, parser.getRestarts(), "Cut-off sentence counted");
+  parser.feed((const uint8_t*)"$PGRME,1.0,M*\r\n$IIMWV,,R,,N,A\r\n", 31);
+  TEST_ASSERT_EQUAL(1, parser.getUnchecked(), "Sentence without checksum passed on unchecked");
+  TEST_ASSERT_EQUAL(2, parser.getChecksumErrors(), "Truncated checksum rejected");
+  
+  // Wind sentences, fed one byte at a time as from the UART
+  NMEA0183WindDataSource nmea(nullptr, -1, 4800);
+  nmea.getFilter().setDuplicateWindowMs(0);   // Sentences repeat on purpose here
+  ReceivedSamples samples = {};
+  nmea.subscribe(count_sample, &samples);
+  TEST_ASSERT(nmea.begin(), "NMEA source starts without a port");
+  TEST_ASSERT(!nmea.isConnected(), "Not connected before data");
+  const char* stream =
+    "$WIMWV,200.0,T,36.0,K,A*17\r\n"
+    "$WIMWV,045.0,R,10.0,N,A*13\r\n";
+  for (const char* p = stream; *p; p++) {
+    nmea.feed(p, 1);
+    nmea.update();
+  }
+  TEST_ASSERT_EQUAL(1, samples.count, "True MWV alone publishes nothing");
+  TEST_ASSERT_NEAR(5.144, nmea.getWindSpeed(), 0.01, "MWV knots converted to m/s");
+  TEST_ASSERT_NEAR(45.0, nmea.getWindAngle(), 0.01, "MWV relative angle");
+  WindSample last = nmea.getHistory().latest();
+  TEST_ASSERT(last.hasTrue(), "Recent true wind rides along");
+  TEST_ASSERT_NEAR(10.0, last.trueSpeed, 0.01, "MWV km/h converted to m/s");
+  TEST_ASSERT(nmea.isConnected(), "Connected after apparent wind");
+  
+  const char* more =
+    "$IIMWV,090.0,R,5.5,M,A*37\r\n"
+    "$IIMWV,090.0,R,5.5,M,V*20\r\n"
+    "$IIVWR,030.0,L,10.0,N,5.1,M,18.5,K*5D\r\n"
+    "$IIVWR,120.0,R,,N,,M,36.0,K*7F\r\n";
+  nmea.feed(more, strlen(more));
+  nmea.update();
+  TEST_ASSERT_EQUAL(4, samples.count, "Status V sentence ignored");
+  TEST_ASSERT_EQUAL(1, nmea.getInvalid(), "Invalid wind counted");
+  TEST_ASSERT_NEAR(10.0, nmea.getWindSpeed(), 0.01, "VWR km/h when the other units are empty");
+  TEST_ASSERT_NEAR(120.0, nmea.getWindAngle(), 0.01, "VWR starboard angle");
+  const char* port_side = "$IIVWR,030.0,L,10.0,N,5.1,M,18.5,K*5D\r\n";
+  nmea.feed(port_side, strlen(port_side));
+  nmea.update();
+  TEST_ASSERT_NEAR(330.0, nmea.getWindAngle(), 0.01, "VWR port angle is 360 minus angle");
+  TEST_ASSERT_NEAR(5.1, nmea.getWindSpeed(), 0.01, "VWR m/s preferred");
+  TEST_ASSERT_EQUAL(7, nmea.getMetrics().messages, "Sentences counted as messages");
+  const char* bad_sum = "$IIMWV,090.0,R,5.5,M,A*38\r\n";
+  nmea.feed(bad_sum, strlen(bad_sum));
+  nmea.update();
+  TEST_ASSERT_EQUAL(1, nmea.getMetrics().parseErrors, "Checksum failure counted as parse error");
+  nmea.stop();
+  
+  // 38400 baud while the display is busy for 200 ms: 768 bytes arrive
+  // before update() runs, and all of them must fit in the ring
+  NMEA0183WindDataSource mux(nullptr, -1, 38400);
+  mux.getFilter().setDuplicateWindowMs(0);
+  ReceivedSamples mux_samples = {};
+  mux.subscribe(count_sample, &mux_samples);
+  mux.begin();
+  const char* sentence = "$WIMWV,045.0,R,10.0,N,A*13\r\n";
+  size_t len = strlen(sentence);
+  size_t burst = 0;
+  while (burst + len <= 3840 / 5) {
+    mux.feed(sentence, len);
+    burst += len;
+  }
+  mux.update();
+  TEST_ASSERT_EQUAL(0, mux.getRxDropped(), "200 ms at 38400 baud fits in the receive ring");
+  TEST_ASSERT_EQUAL(burst, mux.getRxMaxFill(), "Worst ring fill recorded");
+  TEST_ASSERT_EQUAL((int)(burst / len), mux_samples.count, "Every buffered sentence parsed");
+  
+  // A stall longer than the ring: the excess is dropped and counted
+  for (size_t i = 0; i < NMEA_RX_BUFFER_SIZE / len + 2; i++) mux.feed(sentence, len);
+  TEST_ASSERT_EQUAL(NMEA_RX_BUFFER_SIZE, mux.getRxMaxFill(), "Ring fills up");
+  TEST_ASSERT_EQUAL((NMEA_RX_BUFFER_SIZE / len + 2) * len - NMEA_RX_BUFFER_SIZE, mux.getRxDropped(),
+                    "Dropped bytes counted");
+  mux.update();
+  mux.feed(sentence, len);
+  mux.update();
+  TEST_ASSERT_EQUAL(mux_samples.count, (int)mux.getParser().getSentences(), "Parser resynchronizes after drops");
+  mux.stop();
+  
+  Serial.println("NMEA 0183 tests complete");
+}
+
+void test_nmea_instruments() {
+  Serial.println("\n=== Testing NMEA 0183 instrument sentences ===");
+  
+  NMEA0183WindDataSource nmea(nullptr, -1, 4800);
+  nmea.getFilter().setDuplicateWindowMs(0);
+  ReceivedSamples samples = {};
+  nmea.subscribe(count_sample, &samples);
+  nmea.begin();
+  const char* bus =
+    "$IIVHW,,T,,M,6.0,N,,K*7D\r\n"
+    "$IIHDG,100.0,2.0,W,3.0,E*5B\r\n"
+    "$IIHDT,101.0,T*22\r\n"
+    "$IIHDM,98.0,M*13\r\n"
+    "$GPRMC,123519,A,4807.038,N,01131.000,E,5.0,084.4,230394,3.1,W*6B\r\n"
+    "$GPRMC,123519,V,,,,,,,230394,,*33\r\n"
+    "$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K,A*25\r\n"
+    "$GPVTG,054.7,034.4,005.5,010.2*54\r\n"
+    "$IIXDR,C,19.5,C,AIR*07\r\n";
+  nmea.feed(bus, strlen(bus));
+  nmea.update();
+  const InstrumentState& state = nmea.getInstrumentState();
+  TEST_ASSERT_NEAR(3.087, state.get(IQ_SPEED_THROUGH_WATER), 0.01, "VHW speed through water in m/s");
+  TEST_ASSERT_NEAR(98.0, state.get(IQ_HEADING_MAGNETIC), 0.01, "HDG deviation applied");
+  TEST_ASSERT_NEAR(101.0, state.get(IQ_HEADING_TRUE), 0.01, "HDG/HDT true heading");
+  TEST_ASSERT_NEAR(54.7, state.get(IQ_COURSE_OVER_GROUND), 0.01, "VTG course over ground");
+  TEST_ASSERT_NEAR(2.829, state.get(IQ_SPEED_OVER_GROUND), 0.01, "NMEA 1.x VTG speed over ground");
+  TEST_ASSERT(state.age(IQ_SPEED_THROUGH_WATER, millis()) < 100, "Each quantity has its own age");
+  TEST_ASSERT(!state.has(IQ_APPARENT_WIND_SPEED), "No wind yet");
+  TEST_ASSERT_EQUAL(2, nmea.getDecoded(NMEA_TYPE('R', 'M', 'C')), "Decoded sentences counted per type");
+  TEST_ASSERT_EQUAL(1, nmea.getInvalid(), "RMC with status V ignored");
+  TEST_ASSERT_EQUAL(1, nmea.getUnhandled(), "Unknown sentence type counted");
+  TEST_ASSERT_EQUAL(0, samples.count, "Instrument sentences alone publish nothing");
+  
+  // Apparent wind with boat speed and no true wind on the bus: computed
+  const char* apparent = "$IIMWV,030.0,R,10.0,M,A*0C\r\n";
+  nmea.feed(apparent, strlen(apparent));
+  nmea.update();
+  WindSample sample = nmea.getHistory().latest();
+  TEST_ASSERT(sample.hasTrue(), "True wind computed from apparent wind and boat speed");
+  TEST_ASSERT_NEAR(7.49, sample.trueSpeed, 0.02, "Computed true wind speed");
+  TEST_ASSERT_NEAR(41.9, sample.trueAngle, 0.2, "Computed true wind angle");
+  TEST_ASSERT_NEAR(142.9, state.get(IQ_TRUE_WIND_DIRECTION), 0.2, "Computed true wind direction");
+  TEST_ASSERT_EQUAL(1, nmea.getTrueComputed(), "Computation counted");
+  
+  // MWD from the instruments takes over from the computation
+  const char* mwd = "$WIMWD,270.0,T,268.0,M,12.0,N,6.2,M*64\r\n";
+  nmea.feed(mwd, strlen(mwd));
+  nmea.feed(apparent, strlen(apparent));
+  nmea.update();
+  sample = nmea.getHistory().latest();
+  TEST_ASSERT_NEAR(6.2, sample.trueSpeed, 0.01, "MWD true wind speed in m/s");
+  TEST_ASSERT_NEAR(169.0, sample.trueAngle, 0.01, "MWD direction minus heading gives true wind angle");
+  TEST_ASSERT_EQUAL(1, nmea.getTrueComputed(), "Received true wind is not recomputed");
+  TEST_ASSERT_EQUAL(2, samples.count, "One sample per apparent wind sentence");
+  nmea.stop();
+  
+  // MWD speed without a heading gives no true wind angle: still computed
+  NMEA0183WindDataSource no_heading(nullptr, -1, 4800);
+  no_heading.getFilter().setDuplicateWindowMs(0);
+  no_heading.begin();
+  const char* partial =
+    "$IIVHW,,T,,M,6.0,N,,K*7D\r\n"
+    "$WIMWD,,T,,M,12.0,N,6.2,M*6D\r\n";
+  no_heading.feed(partial, strlen(partial));
+  no_heading.feed(apparent, strlen(apparent));
+  no_heading.update();
+  sample = no_heading.getHistory().latest();
+  TEST_ASSERT(sample.hasTrue(), "MWD speed alone does not suppress true wind");
+  TEST_ASSERT_EQUAL(1, no_heading.getTrueComputed(), "True wind computed without a fresh heading");
+  no_heading.stop();
+  
+  Serial.println("NMEA 0183 instrument tests complete");
+}
+
+struct FilterRun {
+  NMEA0183TalkerFilter* filter;
+  uint32_t now;
+  NMEAFilterVerdict verdict;
+};
+
+void check_filter(void* context, const NMEASentence& sentence) {
+  FilterRun* run = (FilterRun*)context;
+  run->verdict = run->filter->check(sentence, run->now);
+}
+
+NMEAFilterVerdict filter_at(NMEA0183Parser& parser, FilterRun& run, uint32_t now, const char* sentence) {
+  run.now = now;
+  run.verdict = NMEA_FILTER_ACCEPT;
+  parser.feed((const uint8_t*)sentence, strlen(sentence));
+  parser.feed((const uint8_t*)"\r\n", 2);
+  return run.verdict;
+}
+
+void test_nmea_talker_filter() {
+  Serial.println("\n=== Testing NMEA talker priority and echo suppression ===");
+  
+  NMEA0183TalkerFilter filter;
+  filter.setPriority("WI,II");
+  TEST_ASSERT_EQUAL(2, filter.getTalkerCount(), "Priority list parsed");
+  NMEA0183Parser parser;
+  FilterRun run = {&filter, 0, NMEA_FILTER_ACCEPT};
+  parser.setHandler(check_filter, &run);
+  
+  TEST_ASSERT(filter_at(parser, run, 0, "$WIMWV,045.0,R,10.0,N,A") == NMEA_FILTER_ACCEPT, "Masthead accepted");
+  TEST_ASSERT(filter_at(parser, run, 10, "$WIMWV,045.0,R,10.0,N,A") == NMEA_FILTER_REJECT_DUPLICATE,
+              "Same sentence twice from one talker is a duplicate");
+  TEST_ASSERT(filter_at(parser, run, 100, "$IIMWV,046.0,R,10.1,N,A") == NMEA_FILTER_REJECT_PRIORITY,
+              "Lower-priority talker dropped while the masthead is live");
+  TEST_ASSERT(filter_at(parser, run, 200, "$IIMWV,200.0,T,8.0,N,A") == NMEA_FILTER_ACCEPT,
+              "True MWV is a separate stream");
+  TEST_ASSERT(filter_at(parser, run, 300, "$WIMWV,200.0,T,8.0,N,A") == NMEA_FILTER_ACCEPT,
+              "Masthead repeating the repeater's content is not an echo");
+  TEST_ASSERT(filter_at(parser, run, 350, "$IIMWV,200.0,T,8.0,N,A") == NMEA_FILTER_REJECT_PRIORITY,
+              "Masthead owns the stream again");
+  TEST_ASSERT(filter_at(parser, run, 3000, "$IIMWV,047.0,R,10.2,N,A") == NMEA_FILTER_ACCEPT,
+              "Lower-priority talker takes over when the masthead is silent");
+  TEST_ASSERT(filter_at(parser, run, 3100, "$WIMWV,048.0,R,10.3,N,A") == NMEA_FILTER_ACCEPT,
+              "Masthead takes back over");
+  TEST_ASSERT(filter_at(parser, run, 3200, "$IIMWV,049.0,R,10.4,N,A") == NMEA_FILTER_REJECT_PRIORITY,
+              "Echo talker dropped again");
+  TEST_ASSERT_EQUAL(5, filter.getAccepted(), "Accepted counted");
+  TEST_ASSERT_EQUAL(3, filter.getRejectedPriority(), "Priority drops counted");
+  TEST_ASSERT_EQUAL(1, filter.getRejectedDuplicate(), "Duplicates counted");
+  TEST_ASSERT_EQUAL(0, filter.getRejectedEcho(), "No echoes between ranked talkers");
+  TEST_ASSERT_EQUAL(3, filter.getTakeovers(), "Talker changes counted");
+  
+  // No priority: both talkers pass unless the content is the same
+  filter.setPriority("");
+  TEST_ASSERT(filter_at(parser, run, 4000, "$WIMWV,045.0,R,10.0,N,A") == NMEA_FILTER_ACCEPT, "Equal talkers: first");
+  TEST_ASSERT(filter_at(parser, run, 4050, "$IIMWV,046.0,R,10.1,N,A") == NMEA_FILTER_ACCEPT, "Equal talkers: second");
+  TEST_ASSERT(filter_at(parser, run, 4100, "$IIMWV,045.0,R,10.0,N,A") == NMEA_FILTER_REJECT_ECHO, "Equal talkers: echo");
+  TEST_ASSERT(filter_at(parser, run, 4700, "$IIMWV,045.0,R,10.0,N,A") == NMEA_FILTER_ACCEPT, "Echo window expires");
+  
+  // Only decoded types get a priority stream; others cannot fill the table
+  uint32_t mwv = NMEA_TYPE('M', 'W', 'V');
+  filter.setPriority("WI,II");
+  filter.setPriorityTypes(&mwv, 1);
+  char other[24];
+  for (int i = 0; i < NMEA_FILTER_MAX_STREAMS + 2; i++) {
+    snprintf(other, sizeof(other), "$GP%c%cX,%d", 'A' + i, 'A' + i, i);
+    filter_at(parser, run, 5000, other);
+  }
+  TEST_ASSERT(filter_at(parser, run, 5000, "$WIMWV,010.0,R,10.0,N,A") == NMEA_FILTER_ACCEPT, "Masthead after many other types");
+  TEST_ASSERT(filter_at(parser, run, 5100, "$IIMWV,011.0,R,10.0,N,A") == NMEA_FILTER_REJECT_PRIORITY,
+              "Priority still applies after many other types");
+  TEST_ASSERT_EQUAL(0, filter.getUnfiltered(), "No stream skipped the priority check");
+  
+  // In the source: the chartplotter echo never reaches the display
+  NMEA0183WindDataSource nmea(nullptr, -1, 4800);
+  nmea.getFilter().setPriority("WI,II");
+  ReceivedSamples samples = {};
+  nmea.subscribe(count_sample, &samples);
+  nmea.begin();
+  const char* bus =
+    "$WIMWV,045.0,R,10.0,N,A*13\r\n"
+    "$IIMWV,090.0,R,5.5,M,A*37\r\n";
+  nmea.feed(bus, strlen(bus));
+  nmea.update();
+  TEST_ASSERT_EQUAL(1, samples.count, "Echoed MWV not published");
+  TEST_ASSERT_NEAR(45.0, nmea.getWindAngle(), 0.01, "Display follows the masthead");
+  TEST_ASSERT_EQUAL(2, nmea.getMetrics().messages, "Filtered sentences still counted as messages");
+  nmea.stop();
+  
+  Serial.println("NMEA talker filter tests complete");
+}
+
+// UART stand-in that takes at most room bytes at a time
+struct CapturePrint : public Print {
+  char data[1024];
+  size_t length;
+  int room;
+  
+  CapturePrint() : length(0), room(1024) { data[0] = '\0'; }
+  int availableForWrite() override { return room; }
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buffer, size_t n) override {
+    if (n > sizeof(data) - 1 - length) n = sizeof(data) - 1 - length;
+    memcpy(data + length, buffer, n);
+    length += n;
+    data[length] = '\0';
+    return n;
+  }
+};
+
+// Run captured output back through the parser
+NMEA0183Parser reparse(const CapturePrint& out, NMEAReceived& received) {
+  NMEA0183Parser parser;
+  parser.setHandler(count_nmea, &received);
+  parser.feed((const uint8_t*)out.data, out.length);
+  return parser;
+}
+
+void test_nmea_output() {
+  Serial.println("\n=== Testing NMEA 0183 output ===");
+  
+  WindSample sample = {};
+  sample.speed = 6.33;
+  sample.angle = 315.0;
+  sample.trueSpeed = 5.2;
+  sample.trueAngle = 290.0;
+  sample.valid = WIND_SAMPLE_SPEED_VALID | WIND_SAMPLE_ANGLE_VALID | WIND_SAMPLE_TRUE_VALID;
+  sample.receivedMs = 1000;
+  
+  CapturePrint out;
+  NMEA0183Output output;
+  output.begin(&out, NMEA_OUTPUT_GENERATE);
+  output.setSentences(NMEA_OUT_MWV_R | NMEA_OUT_MWV_T | NMEA_OUT_VWR | NMEA_OUT_MWD);
+  output.setRate(2);
+  output.onSample(sample);
+  output.setTrueDirection(210.0, 1000);
+  output.update(1000);
+  TEST_ASSERT(strncmp(out.data, "$WIMWV,315.0,R,12.3,N,A*", 24) == 0, "Apparent MWV formatted");
+  TEST_ASSERT(strstr(out.data, "$WIMWV,290.0,T,10.1,N,A*") != nullptr, "True MWV formatted");
+  TEST_ASSERT(strstr(out.data, "$WIVWR,045.0,L,12.3,N,6.3,M,22.8,K*") != nullptr, "VWR to port, three speed units");
+  TEST_ASSERT(strstr(out.data, "$WIMWD,210.0,T,,M,10.1,N,5.2,M*") != nullptr, "MWD with true direction");
+  NMEAReceived received = {};
+  NMEA0183Parser check = reparse(out, received);
+  TEST_ASSERT_EQUAL(4, received.count, "Four sentences written");
+  TEST_ASSERT_EQUAL(0, check.getChecksumErrors(), "Checksums valid");
+  TEST_ASSERT_EQUAL(out.length, output.getBytes(), "Bytes counted");
+  
+  size_t length = out.length;
+  output.update(1200);
+  TEST_ASSERT_EQUAL(length, out.length, "Nothing before the next interval");
+  output.update(1500);
+  TEST_ASSERT(out.length > length, "Sent again at the configured rate");
+  length = out.length;
+  output.update(3100);
+  TEST_ASSERT_EQUAL(length, out.length, "Stale sample not repeated");
+  
+  // A slow UART: write only what it takes, keep the rest for later
+  CapturePrint slow;
+  slow.room = 10;
+  output.begin(&slow, NMEA_OUTPUT_GENERATE);
+  output.resetCounters();
+  output.setSentences(NMEA_OUT_MWV_R | NMEA_OUT_MWV_T);
+  sample.receivedMs = 5000;
+  output.onSample(sample);
+  output.update(5000);
+  TEST_ASSERT_EQUAL(2, output.getGenerated(), "Both MWV generated");
+  TEST_ASSERT_EQUAL(10, slow.length, "Write limited to availableForWrite()");
+  TEST_ASSERT(output.getPending() > 0, "Rest kept pending");
+  slow.room = 1024;
+  output.update(5100);
+  TEST_ASSERT_EQUAL(0, output.getPending(), "Pending bytes written on the next update");
+  
+  // A stalled UART: whole sentences are dropped, never split
+  slow.room = 0;
+  for (uint32_t now = 6000; now < 11000; now += 500) {
+    sample.receivedMs = now;
+    output.onSample(sample);
+    output.update(now);
+  }
+  TEST_ASSERT(output.getDropped() > 0, "Sentences dropped when the buffer is full");
+  TEST_ASSERT(output.getPending() <= NMEA_OUTPUT_BUFFER, "Buffer never exceeded");
+  slow.room = 1024;
+  output.update(10600);
+  NMEAReceived drained = {};
+  check = reparse(slow, drained);
+  TEST_ASSERT_EQUAL(output.getGenerated(), (uint32_t)drained.count, "Every buffered sentence arrives whole");
+  TEST_ASSERT_EQUAL(0, check.getChecksumErrors() + check.getRestarts(), "No split sentences");
+  
+  // Passthrough: accepted sentences repeated unchanged, echoes not
+  CapturePrint repeated;
+  output.begin(&repeated, NMEA_OUTPUT_PASSTHROUGH);
+  output.resetCounters();
+  NMEA0183WindDataSource nmea(nullptr, -1, 4800);
+  nmea.getFilter().setPriority("WI,II");
+  nmea.setSentenceTap(NMEA0183Output::passthrough, &output);
+  nmea.begin();
+  const char* bus =
+    "$WIMWV,045.0,R,10.0,N,A*13\r\n"
+    "$IIMWV,090.0,R,5.5,M,A*37\r\n";
+  nmea.feed(bus, strlen(bus));
+  nmea.update();
+  TEST_ASSERT(strcmp(repeated.data, "$WIMWV,045.0,R,10.0,N,A*13\r\n") == 0, "Accepted sentence repeated as is");
+  TEST_ASSERT_EQUAL(1, output.getRepeated(), "Repeated sentences counted");
+  
+  // The rest of a burst the UART could not take goes out on update()
+  repeated.room = 10;
+  const char* burst = "$WIMWV,050.0,R,10.0,N,A*17\r\n";
+  nmea.feed(burst, strlen(burst));
+  nmea.update();
+  TEST_ASSERT(output.getPending() > 0, "Passthrough keeps what the UART did not take");
+  repeated.room = 1024;
+  output.update(20000);
+  TEST_ASSERT_EQUAL(0, output.getPending(), "Passthrough pending bytes written by update()");
+  output.onSample(sample);
+  output.update(20000);
+  TEST_ASSERT_EQUAL(0, output.getGenerated(), "Nothing generated in passthrough mode");
+  nmea.stop();
+  
+  Serial.println("NMEA output tests complete");
+}
+
 void test_unit_conversions() {
   Serial.println("\n=== Testing Unit Conversions ===");
   
@@ -156,6 +1194,195 @@ void test_unit_conversions() {
   Serial.println("Unit conversion tests complete");
 }
 
+// Collects parser output for the Signal K tests
+struct ParsedDeltaValues {
+  int count;
+  float speed;
+  float angle;
+  float roll;
+  bool hasTimestamp;
+};
+
+void collect_delta_value(void* context, const SignalKDeltaValue& value) {
+  ParsedDeltaValues* out = (ParsedDeltaValues*)context;
+  out->count++;
+  out->hasTimestamp = value.timestamp != nullptr;
+  if (value.pathLength == 30 && memcmp(value.path, "environment.wind.speedApparent", 30) == 0) {
+    out->speed = value.value;
+  } else if (value.pathLength == 30 && memcmp(value.path, "environment.wind.angleApparent", 30) == 0) {
+    out->angle = value.value;
+  } else if (value.field && value.fieldLength == 4 && memcmp(value.field, "roll", 4) == 0) {
+    out->roll = value.value;
+  }
+}
+
+void test_signalk_delta_parser() {
+  Serial.println("\n=== Testing SignalKDeltaParser ===");
+  
+  SignalKDeltaParser parser;
+  ParsedDeltaValues out = {};
+  parser.setHandler(collect_delta_value, &out);
+  
+  const char* delta =
+    "{\"context\":\"vessels.self\",\"updates\":[{\"$source\":\"nmea.0183\","
+    "\"timestamp\":\"2025-12-28T04:47:18.990Z\",\"values\":["
+    "{\"path\":\"environment.wind.speedApparent\",\"value\":6.43},"
+    "{\"path\":\"environment.wind.angleApparent\",\"value\":-0.7854}]}]}";
+  TEST_ASSERT(parser.parse(delta, strlen(delta)), "Parser accepts a wind delta");
+  TEST_ASSERT_EQUAL(2, out.count, "Parser reports both values");
+  TEST_ASSERT_NEAR(6.43, out.speed, 0.0001, "Parser reads speed value");
+  TEST_ASSERT_NEAR(-0.7854, out.angle, 0.0001, "Parser reads negative angle value");
+  TEST_ASSERT(out.hasTimestamp, "Parser attaches update timestamp");
+  
+  // Timestamp after values, object value, exponent notation
+  out = ParsedDeltaValues();
+  const char* reordered =
+    "{\"updates\":[{\"values\":[{\"value\":1.5e1,\"path\":\"environment.wind.speedApparent\"},"
+    "{\"path\":\"navigation.attitude\",\"value\":{\"roll\":0.1,\"pitch\":0.2,\"yaw\":null}}],"
+    "\"timestamp\":\"2025-12-28T04:47:19.000Z\"}]}";
+  TEST_ASSERT(parser.parse(reordered, strlen(reordered)), "Parser accepts reordered members");
+  TEST_ASSERT_EQUAL(3, out.count, "Parser reports scalar and numeric object members");
+  TEST_ASSERT_NEAR(15.0, out.speed, 0.0001, "Parser reads exponent notation");
+  TEST_ASSERT_NEAR(0.1, out.roll, 0.0001, "Parser reads object member value");
+  TEST_ASSERT(out.hasTimestamp, "Parser applies trailing timestamp to buffered values");
+  
+  // Malformed frames are rejected and counted
+  const char* truncated = "{\"updates\":[{\"values\":[{\"path\":\"a\",\"value\":1";
+  const char* mismatched = "{\"updates\":[{\"source\":{\"x\":[1,2}]}]}";
+  TEST_ASSERT(!parser.parse(truncated, strlen(truncated)), "Parser rejects truncated frame");
+  TEST_ASSERT(!parser.parse(mismatched, strlen(mismatched)), "Parser rejects mismatched brackets");
+  TEST_ASSERT_EQUAL(2, parser.getParseErrors(), "Parser counts parse errors");
+  
+  Serial.println("Signal K parser tests complete");
+}
+
+void test_signalk_frame_filter() {
+  Serial.println("\n=== Testing SignalKFrameFilter ===");
+  
+  SignalKFrameFilter filter;
+  filter.addPathPrefix("environment.wind.");
+  
+  const char* ownWind =
+    "{\"context\":\"vessels.urn:mrn:signalk:uuid:self\",\"updates\":[{\"values\":["
+    "{\"path\":\"environment.wind.speedApparent\",\"value\":6.4}]}]}";
+  const char* aisTarget =
+    "{\"context\":\"vessels.urn:mrn:imo:mmsi:235000000\",\"updates\":[{\"values\":["
+    "{\"path\":\"navigation.position\",\"value\":{\"latitude\":50.1,\"longitude\":-1.2}}]}]}";
+  const char* notification =
+    "{\"context\":\"vessels.self\",\"updates\":[{\"values\":["
+    "{\"path\":\"notifications.anchor\",\"value\":{\"state\":\"alarm\"}}]}]}";
+  const char* hello =
+    "{\"name\":\"signalk-server\",\"version\":\"2.0.0\","
+    "\"self\":\"vessels.urn:mrn:signalk:uuid:self\",\"roles\":[\"master\"]}";
+  
+  TEST_ASSERT(filter.check(hello, strlen(hello)) == SK_FRAME_REJECT_NO_UPDATES, "Filter drops hello message");
+  TEST_ASSERT(strcmp(filter.getSelfContext(), "vessels.urn:mrn:signalk:uuid:self") == 0, "Filter learns self context");
+  TEST_ASSERT(filter.check(ownWind, strlen(ownWind)) == SK_FRAME_ACCEPT, "Filter accepts own wind delta");
+  TEST_ASSERT(filter.check(aisTarget, strlen(aisTarget)) == SK_FRAME_REJECT_CONTEXT, "Filter drops AIS target");
+  TEST_ASSERT(filter.check(notification, strlen(notification)) == SK_FRAME_REJECT_PATH, "Filter drops notifications");
+  TEST_ASSERT_EQUAL(1, filter.getAccepted(), "Filter counts accepted frames");
+  TEST_ASSERT_EQUAL(3, filter.getRejected(), "Filter counts rejected frames");
+  
+  Serial.println("Signal K filter tests complete");
+}
+
+void store_path_value(void* context, InstrumentQuantity quantity, float value) {
+  ((InstrumentState*)context)->set(quantity, value, millis());
+}
+
+void dispatch_delta_value(void* context, const SignalKDeltaValue& value) {
+  ((SignalKPathTable*)context)->dispatch(value);
+}
+
+void test_signalk_path_table() {
+  Serial.println("\n=== Testing SignalKPathTable ===");
+  
+  InstrumentState state;
+  SignalKPathTable table;
+  TEST_ASSERT(table.addAll(SIGNALK_DEFAULT_PATHS, SIGNALK_DEFAULT_PATH_COUNT, store_path_value, &state),
+              "Default paths register without collisions");
+  TEST_ASSERT(signalKPathHash("navigation.headingTrue") ==
+              signalKHashAppend(SIGNALK_HASH_SEED, "navigation.headingTrue", 22),
+              "Compile-time and run-time hashes agree");
+  TEST_ASSERT(!table.add("navigation.headingTrue", nullptr, IQ_HEADING_TRUE, SK_CONV_NONE, store_path_value, &state),
+              "Duplicate path is refused");
+  
+  SignalKDeltaParser parser;
+  parser.setHandler(dispatch_delta_value, &table);
+  const char* delta =
+    "{\"updates\":[{\"values\":["
+    "{\"path\":\"environment.wind.angleApparent\",\"value\":-1.5708},"
+    "{\"path\":\"navigation.speedThroughWater\",\"value\":3.2},"
+    "{\"path\":\"navigation.attitude\",\"value\":{\"roll\":-0.1745,\"pitch\":0,\"yaw\":3.1416}},"
+    "{\"path\":\"electrical.batteries.1.voltage\",\"value\":12.8}]}]}";
+  TEST_ASSERT(parser.parse(delta, strlen(delta)), "Parser feeds path table");
+  TEST_ASSERT_NEAR(270.0, state.get(IQ_APPARENT_WIND_ANGLE), 0.01, "Angle converted to 0-360 degrees");
+  TEST_ASSERT_NEAR(3.2, state.get(IQ_SPEED_THROUGH_WATER), 0.0001, "Speed through water stored");
+  TEST_ASSERT_NEAR(-10.0, state.get(IQ_ROLL), 0.01, "Attitude roll converted to signed degrees");
+  TEST_ASSERT_NEAR(180.0, state.get(IQ_YAW), 0.01, "Attitude yaw converted to degrees");
+  TEST_ASSERT(!state.has(IQ_HEADING_TRUE), "Unreceived quantity is not valid");
+  TEST_ASSERT_EQUAL(1, table.getUnknown(), "Unregistered path is counted");
+  
+  SignalKSubscription sub = signalKDefaultSubscription(IQ_APPARENT_WIND_SPEED);
+  TEST_ASSERT(signalKSubscriptionValid(sub), "Default subscription is valid");
+  sub.minPeriod = sub.period + 1;
+  TEST_ASSERT(!signalKSubscriptionValid(sub), "minPeriod above period is rejected");
+  sub.minPeriod = 0;
+  sub.period = 0;
+  TEST_ASSERT(!signalKSubscriptionValid(sub), "Zero period is rejected");
+  
+  Serial.println("Signal K path table tests complete");
+}
+
+void test_latency_instrumentation() {
+  Serial.println("\n=== Testing Timestamps and LatencyHistogram ===");
+  
+  int64_t ms = 0;
+  const char* ts = "2025-12-28T04:47:18.990Z";
+  TEST_ASSERT(signalKParseTimestamp(ts, strlen(ts), ms), "Parses Signal K timestamp");
+  TEST_ASSERT(ms == 1766897238990LL, "Timestamp converts to epoch ms");
+  const char* offset = "2025-12-28T05:47:18.99+01:00";
+  TEST_ASSERT(signalKParseTimestamp(offset, strlen(offset), ms) && ms == 1766897238990LL,
+              "Timestamp with offset and short fraction");
+  TEST_ASSERT(!signalKParseTimestamp("garbage", 7, ms), "Rejects malformed timestamp");
+  
+  LatencyHistogram h;
+  for (int i = 0; i < 90; i++) h.record(3);
+  for (int i = 0; i < 10; i++) h.record(300);
+  TEST_ASSERT_EQUAL(100, h.getCount(), "Histogram counts samples");
+  TEST_ASSERT_EQUAL(4, h.percentile(50), "p50 is upper edge of 2-4 ms bucket");
+  TEST_ASSERT_EQUAL(300, h.percentile(99), "p99 capped at max");
+  TEST_ASSERT_EQUAL(32, h.getMean(), "Histogram mean");
+  
+  Serial.println("Latency instrumentation tests complete");
+}
+
+void test_signalk_rest_snapshot() {
+  Serial.println("\n=== Testing SignalKRestSnapshot ===");
+  
+  InstrumentState state;
+  SignalKPathTable table;
+  table.addAll(SIGNALK_DEFAULT_PATHS, SIGNALK_DEFAULT_PATH_COUNT, store_path_value, &state);
+  
+  SignalKRestSnapshot snapshot;
+  snapshot.setHandler(dispatch_delta_value, &table);
+  snapshot.setPathPrefix("environment.wind");
+  
+  const char* body =
+    "{\"angleApparent\":{\"meta\":{\"units\":\"rad\",\"zones\":[]},\"value\":1.5708,"
+    "\"$source\":\"nmea.II\",\"timestamp\":\"2025-12-28T04:47:18.990Z\"},"
+    "\"speedApparent\":{\"value\":7.2,\"timestamp\":\"2025-12-28T04:47:18.990Z\","
+    "\"values\":{\"nmea.II\":{\"value\":7.2}}},"
+    "\"directionTrue\":{\"meta\":{\"units\":\"rad\"}}}";
+  TEST_ASSERT(snapshot.parseBody(body, strlen(body)), "Snapshot body parses");
+  TEST_ASSERT_EQUAL(2, snapshot.getValuesFound(), "Snapshot reports members with a value");
+  TEST_ASSERT_NEAR(90.0, state.get(IQ_APPARENT_WIND_ANGLE), 0.01, "Snapshot angle reaches path table");
+  TEST_ASSERT_NEAR(7.2, state.get(IQ_APPARENT_WIND_SPEED), 0.0001, "Snapshot speed reaches path table");
+  TEST_ASSERT(!state.has(IQ_TRUE_WIND_DIRECTION), "Member without value is ignored");
+  
+  Serial.println("Signal K snapshot tests complete");
+}
+
 void setup() {
   Serial.begin(115200);
   delay(2000);  // Wait for serial monitor
@@ -167,9 +1394,28 @@ void setup() {
   
   // Run all tests
   test_demo_source();
+  test_wind_simulator();
   test_mock_source();
+  test_wind_samples();
+  test_sample_subscribers();
+  test_spsc_queue();
   test_source_manager();
+  test_source_failover();
+  test_source_metrics();
+  test_make_before_break();
+  test_static_source_slots();
+  test_signalk_server_failover();
+  test_wind_recording();
+  test_nmea0183();
+  test_nmea_instruments();
+  test_nmea_talker_filter();
+  test_nmea_output();
   test_unit_conversions();
+  test_signalk_delta_parser();
+  test_signalk_frame_filter();
+  test_signalk_path_table();
+  test_latency_instrumentation();
+  test_signalk_rest_snapshot();
   
   // Print summary
   Serial.println("\n");
@@ -0,0 +1,236 @@
+/*
+  signalk_load_client.cpp - Loopback client for the Signal K stub server
+
+  Connects like the display does (WebSocket handshake, subscribe built
+  from SIGNALK_DEFAULT_PATHS) and pushes every frame through the same
+  SignalKFrameFilter -> SignalKDeltaParser -> SignalKPathTable chain as
+  SignalKWindDataSource. Fragmented messages are dropped by default, as
+  the firmware only handles whole WStype_TEXT frames; --reassemble
+  joins them to show the upper bound.
+
+  When the server sends its {"stubSummary":...} frame the decoded
+  totals are compared with what was sent and a report is printed.
+
+  Usage: signalk-load-client [--host H] [--port N] [--reassemble]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <string>
+
+#include "websocket.h"
+#include "SignalKDeltaParser.h"
+#include "SignalKFrameFilter.h"
+#include "SignalKPathTable.h"
+
+struct Summary {
+  bool received = false;
+  unsigned long long sent = 0, valid = 0, fragmented = 0, bad = 0, ais = 0, values = 0;
+  double valueSum = 0;
+};
+
+struct ClientStats {
+  uint64_t frames = 0;            // Complete text messages handed to the filter
+  uint64_t bytes = 0;
+  uint64_t fragmentsDropped = 0;  // Messages lost to fragmentation
+  uint64_t decodedFrames = 0;     // Accepted and parsed without error
+  uint64_t values = 0;            // Values from frames that parsed cleanly
+  uint64_t partialValues = 0;     // Values delivered before a parse error
+  double valueSum = 0;
+  double parseSeconds = 0;
+  double parseMax = 0;
+};
+
+// Values of the frame being parsed; committed only if the frame is clean
+static uint32_t frameValues;
+static double frameSum;
+static SignalKPathTable paths;
+
+static void collectValue(void* context, const SignalKDeltaValue& value) {
+  frameValues++;
+  frameSum += value.value;
+  paths.dispatch(value);
+}
+
+static double nowSeconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int connectTo(const char* host, int port) {
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  struct addrinfo* result;
+  char service[8];
+  snprintf(service, sizeof(service), "%d", port);
+  if (getaddrinfo(host, service, &hints, &result) != 0) return -1;
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd >= 0 && connect(fd, result->ai_addr, result->ai_addrlen) != 0) {
+    close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(result);
+  return fd;
+}
+
+static bool handshake(int fd, const char* host, int port) {
+  char request[512];
+  int n = snprintf(request, sizeof(request),
+                   "GET /signalk/v1/stream?subscribe=none HTTP/1.1\r\nHost: %s:%d\r\n"
+                   "Upgrade: websocket\r\nConnection: Upgrade\r\n"
+                   "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n",
+                   host, port);
+  if (!sendAll(fd, request, n)) return false;
+  std::string headers;
+  if (!readHttpHeaders(fd, headers) || headers.compare(0, 12, "HTTP/1.1 101") != 0) return false;
+  return httpHeader(headers, "Sec-WebSocket-Accept") == wsAcceptKey("dGhlIHNhbXBsZSBub25jZQ==");
+}
+
+static void subscribe(int fd) {
+  std::string msg = "{\"context\":\"vessels.self\",\"subscribe\":[";
+  for (uint8_t i = 0; i < paths.size(); i++) {
+    if (paths.isDuplicatePath(i)) continue;
+    const SignalKPathEntry& e = paths.entry(i);
+    char entry[160];
+    snprintf(entry, sizeof(entry), "%s{\"path\":\"%s\",\"policy\":\"%s\",\"period\":%u}",
+             i ? "," : "", e.path, signalKPolicyName(e.subscription.policy), e.subscription.period);
+    msg += entry;
+  }
+  msg += "]}";
+  wsSendFrame(fd, WS_OP_TEXT, true, msg.data(), msg.size(), true);
+}
+
+static bool readSummary(const std::string& json, Summary& s) {
+  const char* p = strstr(json.c_str(), "\"stubSummary\"");
+  if (!p) return false;
+  s.received = sscanf(p, "\"stubSummary\":{\"sent\":%llu,\"valid\":%llu,\"fragmented\":%llu,\"bad\":%llu,"
+                         "\"ais\":%llu,\"values\":%llu,\"valueSum\":%lf",
+                      &s.sent, &s.valid, &s.fragmented, &s.bad, &s.ais, &s.values, &s.valueSum) == 7;
+  return true;
+}
+
+static void printReport(const ClientStats& c, SignalKFrameFilter& filter, SignalKDeltaParser& parser,
+                        const Summary& s, double elapsed) {
+  printf("\n[Client] Load report\n");
+  printf("  duration          %.2f s\n", elapsed);
+  printf("  messages          %llu (%.1f msg/s, %.1f KB/s)\n", (unsigned long long)c.frames,
+         c.frames / elapsed, c.bytes / elapsed / 1024);
+  printf("  fragmented lost   %llu\n", (unsigned long long)c.fragmentsDropped);
+  printf("  filter            accepted %u, context %u, path %u, no updates %u\n",
+         filter.getAccepted(), filter.getRejectedContext(), filter.getRejectedPath(),
+         filter.getRejectedNoUpdates());
+  printf("  parse errors      %u\n", parser.getParseErrors());
+  printf("  parse time        mean %.1f us, max %.1f us\n",
+         c.frames ? c.parseSeconds / c.frames * 1e6 : 0.0, c.parseMax * 1e6);
+  printf("  decoded frames    %llu\n", (unsigned long long)c.decodedFrames);
+  printf("  decoded values    %llu (+%llu from broken frames)\n", (unsigned long long)c.values,
+         (unsigned long long)c.partialValues);
+  printf("  path table        %u dispatched, %u unknown\n", paths.getDispatched(), paths.getUnknown());
+
+  if (!s.received) {
+    printf("  no summary from server, cannot compare counts\n");
+    return;
+  }
+  double pct = s.values ? 100.0 * c.values / s.values : 100.0;
+  printf("  server sent       %llu valid deltas, %llu values (sum %.3f)\n", s.valid, s.values, s.valueSum);
+  // Counts and sums only; individual values are not matched up
+  printf("  decoded count     %.2f%% of values, sum difference %.4f\n", pct, c.valueSum - s.valueSum);
+}
+
+int main(int argc, char** argv) {
+  const char* host = "127.0.0.1";
+  int port = 3000;
+  bool reassemble = false;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--host") && i + 1 < argc) host = argv[++i];
+    else if (!strcmp(argv[i], "--port") && i + 1 < argc) port = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--reassemble")) reassemble = true;
+    else {
+      printf("Usage: signalk-load-client [--host H] [--port N] [--reassemble]\n");
+      return 1;
+    }
+  }
+  signal(SIGPIPE, SIG_IGN);
+
+  paths.addAll(SIGNALK_DEFAULT_PATHS, SIGNALK_DEFAULT_PATH_COUNT, nullptr, nullptr);
+  SignalKFrameFilter filter;
+  for (uint8_t i = 0; i < paths.size(); i++) {
+    filter.addPathPrefix(paths.entry(i).path);
+  }
+  SignalKDeltaParser parser;
+  parser.setHandler(collectValue, nullptr);
+
+  int fd = connectTo(host, port);
+  if (fd < 0 || !handshake(fd, host, port)) {
+    fprintf(stderr, "[Client] Cannot open WebSocket to %s:%d\n", host, port);
+    return 1;
+  }
+  subscribe(fd);
+  printf("[Client] Connected to %s:%d\n", host, port);
+
+  ClientStats stats;
+  Summary summary;
+  std::string message;
+  bool inFragment = false;
+  double start = nowSeconds();
+
+  WsFrame frame;
+  while (wsReadFrame(fd, frame)) {
+    if (frame.opcode == WS_OP_CLOSE) break;
+    if (frame.opcode == WS_OP_PING) {
+      wsSendFrame(fd, WS_OP_PONG, true, frame.payload.data(), frame.payload.size(), true);
+      continue;
+    }
+    if (frame.opcode == WS_OP_TEXT && frame.fin) {
+      message.swap(frame.payload);
+    } else if (frame.opcode == WS_OP_TEXT || frame.opcode == WS_OP_CONTINUATION) {
+      if (frame.opcode == WS_OP_TEXT) {
+        message = frame.payload;
+        inFragment = true;
+      } else if (inFragment) {
+        message += frame.payload;
+      }
+      if (!frame.fin) continue;
+      inFragment = false;
+      if (!reassemble) {
+        stats.fragmentsDropped++;
+        continue;
+      }
+    } else {
+      continue;
+    }
+
+    if (readSummary(message, summary)) break;
+
+    stats.frames++;
+    stats.bytes += message.size();
+    double t0 = nowSeconds();
+    if (filter.accept(message.data(), message.size())) {
+      frameValues = 0;
+      frameSum = 0;
+      if (parser.parse(message.data(), message.size())) {
+        stats.decodedFrames++;
+        stats.values += frameValues;
+        stats.valueSum += frameSum;
+      } else {
+        stats.partialValues += frameValues;
+      }
+    }
+    double dt = nowSeconds() - t0;
+    stats.parseSeconds += dt;
+    if (dt > stats.parseMax) stats.parseMax = dt;
+  }
+  close(fd);
+
+  printReport(stats, filter, parser, summary, nowSeconds() - start);
+  return 0;
+}
@@ -0,0 +1,448 @@
+/*
+  signalk_stub_server.cpp - Stand-in Signal K server for load testing
+
+  Serves /signalk/v1/stream as a WebSocket on localhost (or any address
+  with --bind) and pushes wind deltas at a fixed rate, either synthetic
+  (WindSimulator seeded with --seed: apparent and true wind, heading and
+  boat speed) or replayed from a file with one delta per line. Bursts,
+  fragmented frames, other-vessel (AIS) frames and malformed JSON can be
+  mixed in.
+  The REST wind snapshot is served too, so the display's connect path
+  can be exercised end to end.
+
+  Every decodable delta is run through the firmware's own
+  SignalKDeltaParser to count the values it carries. At the end of a
+  session the totals go to the client in a final {"stubSummary":...}
+  frame and a throughput report is printed.
+
+  Usage: signalk-stub-server [options]   (see --help)
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <poll.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <string>
+#include <vector>
+
+#include "websocket.h"
+#include "SignalKDeltaParser.h"
+#include "WindSimulator.h"
+
+struct Options {
+  const char* bind = "127.0.0.1";
+  int port = 3000;
+  double rate = 10;           // Messages per second, 1-1000
+  double duration = 10;       // Seconds per session
+  const char* replay = nullptr;
+  double burstEvery = 0;      // Seconds between bursts, 0 = none
+  int burstSize = 50;
+  double fragmentPct = 0;
+  double badPct = 0;
+  double aisPct = 0;
+  unsigned seed = 1;
+  bool once = false;
+};
+
+struct Stats {
+  uint64_t sent = 0;          // WebSocket messages (a fragmented one counts once)
+  uint64_t bytes = 0;
+  uint64_t valid = 0;         // Deltas meant to be decoded
+  uint64_t fragmented = 0;    // ...of which sent in pieces
+  uint64_t bad = 0;
+  uint64_t ais = 0;
+  uint64_t bursts = 0;
+  uint64_t values = 0;        // Values in valid deltas, counted by SignalKDeltaParser
+  double valueSum = 0;
+};
+
+static Options opt;
+
+static double nowSeconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double uniform() {
+  return rand() / (RAND_MAX + 1.0);
+}
+
+static void isoTimestamp(char* out, size_t size) {
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  struct tm t;
+  gmtime_r(&tv.tv_sec, &t);
+  size_t n = strftime(out, size, "%Y-%m-%dT%H:%M:%S", &t);
+  snprintf(out + n, size - n, ".%03uZ", (unsigned)(tv.tv_usec / 1000) % 1000);
+}
+
+// Synthetic wind: one simulator step per delta
+static WindSimulator simulator;
+static float windSpeed = 0;    // Apparent, m/s
+static float windAngle = 0;    // Apparent, rad -pi..pi
+
+static float radians180(float degrees) {
+  return (degrees > 180.0f ? degrees - 360.0f : degrees) * (float)(M_PI / 180.0);
+}
+
+static std::string syntheticDelta() {
+  simulator.step();
+  windSpeed = simulator.getApparentSpeed();
+  windAngle = radians180(simulator.getApparentAngle());
+
+  char ts[32];
+  isoTimestamp(ts, sizeof(ts));
+  char buf[512];
+  snprintf(buf, sizeof(buf),
+           "{\"context\":\"vessels.urn:mrn:signalk:uuid:stub\",\"updates\":[{\"$source\":\"stub.II\","
+           "\"timestamp\":\"%s\",\"values\":["
+           "{\"path\":\"environment.wind.speedApparent\",\"value\":%.3f},"
+           "{\"path\":\"environment.wind.angleApparent\",\"value\":%.4f},"
+           "{\"path\":\"environment.wind.speedTrue\",\"value\":%.3f},"
+           "{\"path\":\"environment.wind.angleTrueWater\",\"value\":%.4f},"
+           "{\"path\":\"navigation.headingTrue\",\"value\":%.4f},"
+           "{\"path\":\"navigation.speedThroughWater\",\"value\":%.3f}]}]}",
+           ts, windSpeed, windAngle, simulator.getTrueSpeed(), radians180(simulator.getTrueAngle()),
+           simulator.getHeading() * (float)(M_PI / 180.0), simulator.getBoatSpeed());
+  return buf;
+}
+
+static std::string aisDelta() {
+  char buf[256];
+  snprintf(buf, sizeof(buf),
+           "{\"context\":\"vessels.urn:mrn:imo:mmsi:2350%05d\",\"updates\":[{\"values\":["
+           "{\"path\":\"navigation.position\",\"value\":{\"latitude\":50.%04d,\"longitude\":-1.%04d}}]}]}",
+           rand() % 100000, rand() % 10000, rand() % 10000);
+  return buf;
+}
+
+// Truncated, bracket-mismatched or plain non-JSON
+static std::string badDelta() {
+  std::string d = syntheticDelta();
+  switch (rand() % 3) {
+    case 0:
+      return d.substr(0, 1 + rand() % (d.size() - 1));
+    case 1: {
+      size_t brace = d.rfind('}', d.size() - 3);
+      d[brace] = ']';
+      return d;
+    }
+    default:
+      return "<html>502 Bad Gateway</html>";
+  }
+}
+
+static std::vector<std::string> replayLines;
+static size_t replayNext = 0;
+
+static bool loadReplay(const char* path) {
+  FILE* f = fopen(path, "r");
+  if (!f) return false;
+  char* line = nullptr;
+  size_t cap = 0;
+  ssize_t n;
+  while ((n = getline(&line, &cap, f)) > 0) {
+    while (n > 0 && (line[n - 1] == '\n' || line[n - 1] == '\r')) n--;
+    if (n > 0 && line[0] == '{') replayLines.push_back(std::string(line, n));
+  }
+  free(line);
+  fclose(f);
+  return !replayLines.empty();
+}
+
+static void countValues(void* context, const SignalKDeltaValue& value) {
+  Stats* stats = (Stats*)context;
+  stats->values++;
+  stats->valueSum += value.value;
+}
+
+static bool sendMessage(int fd, Stats& stats, SignalKDeltaParser& parser) {
+  double pick = uniform() * 100;
+  std::string msg;
+  bool valid = false;
+  if (pick < opt.badPct) {
+    msg = badDelta();
+    stats.bad++;
+  } else if (pick < opt.badPct + opt.aisPct) {
+    msg = aisDelta();
+    stats.ais++;
+  } else {
+    if (!replayLines.empty()) {
+      msg = replayLines[replayNext];
+      replayNext = (replayNext + 1) % replayLines.size();
+    } else {
+      msg = syntheticDelta();
+    }
+    valid = true;
+  }
+
+  if (valid) {
+    // Count only what a correct decoder must find
+    Stats before = stats;
+    if (!parser.parse(msg.data(), msg.size())) {
+      stats.values = before.values;
+      stats.valueSum = before.valueSum;
+      stats.bad++;
+      valid = false;
+    } else {
+      stats.valid++;
+    }
+  }
+
+  bool ok;
+  if (valid && uniform() * 100 < opt.fragmentPct && msg.size() > 8) {
+    size_t a = msg.size() / 3, b = 2 * msg.size() / 3;
+    ok = wsSendFrame(fd, WS_OP_TEXT, false, msg.data(), a, false) &&
+         wsSendFrame(fd, WS_OP_CONTINUATION, false, msg.data() + a, b - a, false) &&
+         wsSendFrame(fd, WS_OP_CONTINUATION, true, msg.data() + b, msg.size() - b, false);
+    stats.fragmented++;
+  } else {
+    ok = wsSendFrame(fd, WS_OP_TEXT, true, msg.data(), msg.size(), false);
+  }
+  stats.sent++;
+  stats.bytes += msg.size();
+  return ok;
+}
+
+static void serveSnapshot(int fd) {
+  char ts[32];
+  isoTimestamp(ts, sizeof(ts));
+  char body[512];
+  int n = snprintf(body, sizeof(body),
+                   "{\"angleApparent\":{\"meta\":{\"units\":\"rad\"},\"value\":%.4f,\"$source\":\"stub.II\","
+                   "\"timestamp\":\"%s\"},\"speedApparent\":{\"meta\":{\"units\":\"m/s\"},\"value\":%.3f,"
+                   "\"$source\":\"stub.II\",\"timestamp\":\"%s\"}}",
+                   windAngle, ts, windSpeed, ts);
+  char header[160];
+  int h = snprintf(header, sizeof(header),
+                   "HTTP/1.0 200 OK\r\nContent-Type: application/json\r\nContent-Length: %d\r\n\r\n", n);
+  sendAll(fd, header, h);
+  sendAll(fd, body, n);
+}
+
+static void reject(int fd, const char* status) {
+  std::string r = std::string("HTTP/1.1 ") + status + "\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+  sendAll(fd, r.data(), r.size());
+}
+
+// Handle one incoming connection. Returns true if it became the
+// WebSocket session (fd stays open), false if it was answered and closed.
+static bool handleRequest(int fd, bool sessionBusy) {
+  std::string headers;
+  if (!readHttpHeaders(fd, headers)) {
+    close(fd);
+    return false;
+  }
+  std::string requestLine = headers.substr(0, headers.find("\r\n"));
+  printf("[Stub] %s\n", requestLine.c_str());
+
+  if (requestLine.find(" /signalk/v1/api/vessels/self/environment/wind") != std::string::npos) {
+    serveSnapshot(fd);
+    close(fd);
+    return false;
+  }
+  if (requestLine.find(" /signalk/v1/stream") == std::string::npos) {
+    reject(fd, "404 Not Found");
+    close(fd);
+    return false;
+  }
+  std::string key = httpHeader(headers, "Sec-WebSocket-Key");
+  if (key.empty() || sessionBusy) {
+    reject(fd, sessionBusy ? "503 Service Unavailable" : "400 Bad Request");
+    close(fd);
+    return false;
+  }
+
+  std::string response =
+    "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+    "Sec-WebSocket-Accept: " + wsAcceptKey(key) + "\r\n\r\n";
+  sendAll(fd, response.data(), response.size());
+
+  char ts[32];
+  isoTimestamp(ts, sizeof(ts));
+  char hello[256];
+  int n = snprintf(hello, sizeof(hello),
+                   "{\"name\":\"signalk-stub-server\",\"version\":\"2.0.0\",\"timestamp\":\"%s\","
+                   "\"self\":\"vessels.urn:mrn:signalk:uuid:stub\",\"roles\":[\"master\",\"main\"]}", ts);
+  wsSendFrame(fd, WS_OP_TEXT, true, hello, n, false);
+  return true;
+}
+
+static void printReport(const Stats& s, double elapsed) {
+  printf("\n[Stub] Session report\n");
+  printf("  duration        %.2f s\n", elapsed);
+  printf("  messages        %llu (%.1f msg/s)\n", (unsigned long long)s.sent, s.sent / elapsed);
+  printf("  payload bytes   %llu (%.1f KB/s)\n", (unsigned long long)s.bytes, s.bytes / elapsed / 1024);
+  printf("  valid deltas    %llu (fragmented %llu)\n", (unsigned long long)s.valid,
+         (unsigned long long)s.fragmented);
+  printf("  AIS deltas      %llu\n", (unsigned long long)s.ais);
+  printf("  bad JSON        %llu\n", (unsigned long long)s.bad);
+  printf("  bursts          %llu x %d\n", (unsigned long long)s.bursts, opt.burstSize);
+  printf("  values sent     %llu (sum %.3f)\n", (unsigned long long)s.values, s.valueSum);
+}
+
+static void runSession(int client, int listener) {
+  Stats stats;
+  SignalKDeltaParser parser;
+  parser.setHandler(countValues, &stats);
+
+  int one = 1;
+  setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+  double start = nowSeconds();
+  double nextBurst = opt.burstEvery > 0 ? start + opt.burstEvery : 0;
+  uint64_t scheduled = 0;
+  bool open = true;
+
+  while (open) {
+    double now = nowSeconds();
+    double elapsed = now - start;
+    if (elapsed >= opt.duration) break;
+
+    // Messages due so far at the configured rate
+    uint64_t due = (uint64_t)(elapsed * opt.rate) + 1;
+    while (scheduled < due && open) {
+      open = sendMessage(client, stats, parser);
+      scheduled++;
+    }
+    if (nextBurst && now >= nextBurst) {
+      for (int i = 0; i < opt.burstSize && open; i++) {
+        open = sendMessage(client, stats, parser);
+      }
+      stats.bursts++;
+      nextBurst += opt.burstEvery;
+    }
+
+    double nextSend = start + scheduled / opt.rate;
+    int timeoutMs = (int)((nextSend - nowSeconds()) * 1000);
+    if (timeoutMs < 0) timeoutMs = 0;
+
+    struct pollfd fds[2] = {{client, POLLIN, 0}, {listener, POLLIN, 0}};
+    if (poll(fds, 2, timeoutMs) <= 0) continue;
+
+    if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+      WsFrame frame;
+      if (!wsReadFrame(client, frame)) {
+        printf("[Stub] Client went away\n");
+        open = false;
+        break;
+      }
+      if (frame.opcode == WS_OP_CLOSE) {
+        printf("[Stub] Client closed\n");
+        open = false;
+      } else if (frame.opcode == WS_OP_PING) {
+        wsSendFrame(client, WS_OP_PONG, true, frame.payload.data(), frame.payload.size(), false);
+      } else if (frame.opcode == WS_OP_TEXT) {
+        printf("[Stub] Client: %.200s\n", frame.payload.c_str());
+      }
+    }
+    if (fds[1].revents & POLLIN) {
+      int extra = accept(listener, nullptr, nullptr);
+      if (extra >= 0 && handleRequest(extra, true)) close(extra);
+    }
+  }
+
+  double elapsed = nowSeconds() - start;
+  if (open) {
+    char summary[256];
+    int n = snprintf(summary, sizeof(summary),
+                     "{\"stubSummary\":{\"sent\":%llu,\"valid\":%llu,\"fragmented\":%llu,\"bad\":%llu,"
+                     "\"ais\":%llu,\"values\":%llu,\"valueSum\":%.3f}}",
+                     (unsigned long long)stats.sent, (unsigned long long)stats.valid,
+                     (unsigned long long)stats.fragmented, (unsigned long long)stats.bad,
+                     (unsigned long long)stats.ais, (unsigned long long)stats.values, stats.valueSum);
+    wsSendFrame(client, WS_OP_TEXT, true, summary, n, false);
+    uint8_t code[2] = {0x03, 0xE8};  // 1000 normal closure
+    wsSendFrame(client, WS_OP_CLOSE, true, (const char*)code, 2, false);
+  }
+  close(client);
+  printReport(stats, elapsed);
+}
+
+static void usage() {
+  printf("Usage: signalk-stub-server [options]\n"
+         "  --bind ADDR         listen address (default 127.0.0.1)\n"
+         "  --port N            listen port (default 3000)\n"
+         "  --rate N            deltas per second, 1-1000 (default 10)\n"
+         "  --duration S        seconds per session (default 10)\n"
+         "  --replay FILE       replay deltas from FILE, one JSON object per line\n"
+         "  --burst-every S     send a burst every S seconds\n"
+         "  --burst-size N      messages per burst (default 50)\n"
+         "  --fragment-pct P    percent of valid deltas sent as 3 fragments\n"
+         "  --bad-pct P         percent of malformed frames\n"
+         "  --ais-pct P         percent of other-vessel deltas\n"
+         "  --seed N            random seed (default 1)\n"
+         "  --once              exit after the first session\n");
+}
+
+int main(int argc, char** argv) {
+  for (int i = 1; i < argc; i++) {
+    const char* a = argv[i];
+    const char* v = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (!strcmp(a, "--once")) { opt.once = true; continue; }
+    if (!strcmp(a, "--help") || !v) { usage(); return strcmp(a, "--help") ? 1 : 0; }
+    i++;
+    if (!strcmp(a, "--bind")) opt.bind = v;
+    else if (!strcmp(a, "--port")) opt.port = atoi(v);
+    else if (!strcmp(a, "--rate")) opt.rate = atof(v);
+    else if (!strcmp(a, "--duration")) opt.duration = atof(v);
+    else if (!strcmp(a, "--replay")) opt.replay = v;
+    else if (!strcmp(a, "--burst-every")) opt.burstEvery = atof(v);
+    else if (!strcmp(a, "--burst-size")) opt.burstSize = atoi(v);
+    else if (!strcmp(a, "--fragment-pct")) opt.fragmentPct = atof(v);
+    else if (!strcmp(a, "--bad-pct")) opt.badPct = atof(v);
+    else if (!strcmp(a, "--ais-pct")) opt.aisPct = atof(v);
+    else if (!strcmp(a, "--seed")) opt.seed = (unsigned)atoi(v);
+    else { usage(); return 1; }
+  }
+  if (opt.rate < 1) opt.rate = 1;
+  if (opt.rate > 1000) opt.rate = 1000;
+  srand(opt.seed);
+  WindSimulatorConfig sim;
+  sim.seed = opt.seed;
+  sim.rateHz = opt.rate < WIND_SIM_MAX_RATE_HZ ? (uint16_t)opt.rate : WIND_SIM_MAX_RATE_HZ;
+  simulator.configure(sim);
+  windSpeed = simulator.getApparentSpeed();
+  windAngle = radians180(simulator.getApparentAngle());
+  signal(SIGPIPE, SIG_IGN);
+  setvbuf(stdout, nullptr, _IOLBF, 0);
+
+  if (opt.replay && !loadReplay(opt.replay)) {
+    fprintf(stderr, "[Stub] Cannot read deltas from %s\n", opt.replay);
+    return 1;
+  }
+
+  int listener = socket(AF_INET, SOCK_STREAM, 0);
+  int one = 1;
+  setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(opt.port);
+  if (!inet_aton(opt.bind, &addr.sin_addr) ||
+      bind(listener, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(listener, 4) != 0) {
+    perror("[Stub] listen");
+    return 1;
+  }
+  printf("[Stub] Listening on %s:%d, %.0f msg/s for %.0f s%s\n", opt.bind, opt.port, opt.rate,
+         opt.duration, opt.replay ? " (replay)" : "");
+  fflush(stdout);
+
+  for (;;) {
+    int client = accept(listener, nullptr, nullptr);
+    if (client < 0) continue;
+    if (!handleRequest(client, false)) continue;
+    runSession(client, listener);
+    fflush(stdout);
+    if (opt.once) break;
+  }
+  close(listener);
+  return 0;
+}
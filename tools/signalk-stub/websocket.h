@@ -0,0 +1,209 @@
+/*
+  websocket.h - Minimal RFC 6455 helpers for the host-side Signal K tools
+
+  Just enough WebSocket for a localhost test rig: the SHA-1/base64
+  handshake key, blocking frame reads and writes on a socket, and HTTP
+  header reading. Linux only; not used by the firmware.
+*/
+
+#ifndef SIGNALK_STUB_WEBSOCKET_H
+#define SIGNALK_STUB_WEBSOCKET_H
+
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <string>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/socket.h>
+
+enum WsOpcode {
+  WS_OP_CONTINUATION = 0x0,
+  WS_OP_TEXT = 0x1,
+  WS_OP_BINARY = 0x2,
+  WS_OP_CLOSE = 0x8,
+  WS_OP_PING = 0x9,
+  WS_OP_PONG = 0xA
+};
+
+struct WsFrame {
+  uint8_t opcode;
+  bool fin;
+  std::string payload;
+};
+
+// SHA-1 of a short string (handshake keys only)
+inline void wsSha1(const uint8_t* data, size_t length, uint8_t digest[20]) {
+  uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+  std::string msg((const char*)data, length);
+  uint64_t bits = (uint64_t)length * 8;
+  msg += (char)0x80;
+  while (msg.size() % 64 != 56) msg += (char)0;
+  for (int i = 7; i >= 0; i--) msg += (char)(bits >> (i * 8));
+
+  for (size_t chunk = 0; chunk < msg.size(); chunk += 64) {
+    uint32_t w[80];
+    for (int i = 0; i < 16; i++) {
+      const uint8_t* b = (const uint8_t*)msg.data() + chunk + i * 4;
+      w[i] = (uint32_t)b[0] << 24 | (uint32_t)b[1] << 16 | (uint32_t)b[2] << 8 | b[3];
+    }
+    for (int i = 16; i < 80; i++) {
+      uint32_t x = w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16];
+      w[i] = (x << 1) | (x >> 31);
+    }
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+    for (int i = 0; i < 80; i++) {
+      uint32_t f, k;
+      if (i < 20) { f = (b & c) | (~b & d); k = 0x5A827999; }
+      else if (i < 40) { f = b ^ c ^ d; k = 0x6ED9EBA1; }
+      else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+      else { f = b ^ c ^ d; k = 0xCA62C1D6; }
+      uint32_t t = ((a << 5) | (a >> 27)) + f + e + k + w[i];
+      e = d; d = c; c = (b << 30) | (b >> 2); b = a; a = t;
+    }
+    h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+  }
+  for (int i = 0; i < 5; i++) {
+    digest[i * 4] = h[i] >> 24;
+    digest[i * 4 + 1] = h[i] >> 16;
+    digest[i * 4 + 2] = h[i] >> 8;
+    digest[i * 4 + 3] = h[i];
+  }
+}
+
+inline std::string wsBase64(const uint8_t* data, size_t length) {
+  static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string out;
+  for (size_t i = 0; i < length; i += 3) {
+    uint32_t n = (uint32_t)data[i] << 16;
+    if (i + 1 < length) n |= (uint32_t)data[i + 1] << 8;
+    if (i + 2 < length) n |= data[i + 2];
+    out += table[(n >> 18) & 63];
+    out += table[(n >> 12) & 63];
+    out += i + 1 < length ? table[(n >> 6) & 63] : '=';
+    out += i + 2 < length ? table[n & 63] : '=';
+  }
+  return out;
+}
+
+// Sec-WebSocket-Accept for a client's Sec-WebSocket-Key
+inline std::string wsAcceptKey(const std::string& key) {
+  std::string s = key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+  uint8_t digest[20];
+  wsSha1((const uint8_t*)s.data(), s.size(), digest);
+  return wsBase64(digest, 20);
+}
+
+inline bool sendAll(int fd, const void* data, size_t length) {
+  const char* p = (const char*)data;
+  while (length) {
+    ssize_t n = send(fd, p, length, MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    p += n;
+    length -= (size_t)n;
+  }
+  return true;
+}
+
+inline bool recvAll(int fd, void* data, size_t length) {
+  char* p = (char*)data;
+  while (length) {
+    ssize_t n = recv(fd, p, length, 0);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    p += n;
+    length -= (size_t)n;
+  }
+  return true;
+}
+
+// Clients must mask, servers must not
+inline bool wsSendFrame(int fd, uint8_t opcode, bool fin, const char* data, size_t length, bool mask) {
+  uint8_t header[14];
+  size_t h = 0;
+  header[h++] = (fin ? 0x80 : 0) | opcode;
+  uint8_t maskBit = mask ? 0x80 : 0;
+  if (length < 126) {
+    header[h++] = maskBit | (uint8_t)length;
+  } else if (length < 65536) {
+    header[h++] = maskBit | 126;
+    header[h++] = length >> 8;
+    header[h++] = length;
+  } else {
+    header[h++] = maskBit | 127;
+    for (int i = 7; i >= 0; i--) header[h++] = (uint8_t)((uint64_t)length >> (i * 8));
+  }
+  if (!mask) {
+    return sendAll(fd, header, h) && sendAll(fd, data, length);
+  }
+  uint8_t key[4] = {0x12, 0x34, 0x56, 0x78};
+  memcpy(header + h, key, 4);
+  h += 4;
+  std::string masked(data, length);
+  for (size_t i = 0; i < length; i++) masked[i] ^= key[i & 3];
+  return sendAll(fd, header, h) && sendAll(fd, masked.data(), length);
+}
+
+inline bool wsReadFrame(int fd, WsFrame& frame) {
+  uint8_t header[2];
+  if (!recvAll(fd, header, 2)) return false;
+  frame.fin = header[0] & 0x80;
+  frame.opcode = header[0] & 0x0F;
+  bool masked = header[1] & 0x80;
+  uint64_t length = header[1] & 0x7F;
+  if (length == 126) {
+    uint8_t ext[2];
+    if (!recvAll(fd, ext, 2)) return false;
+    length = (uint64_t)ext[0] << 8 | ext[1];
+  } else if (length == 127) {
+    uint8_t ext[8];
+    if (!recvAll(fd, ext, 8)) return false;
+    length = 0;
+    for (int i = 0; i < 8; i++) length = length << 8 | ext[i];
+  }
+  if (length > (1u << 24)) return false;
+  uint8_t key[4] = {0, 0, 0, 0};
+  if (masked && !recvAll(fd, key, 4)) return false;
+  frame.payload.resize(length);
+  if (length && !recvAll(fd, &frame.payload[0], length)) return false;
+  if (masked) {
+    for (size_t i = 0; i < length; i++) frame.payload[i] ^= key[i & 3];
+  }
+  return true;
+}
+
+// Read up to and including the blank line after the headers
+inline bool readHttpHeaders(int fd, std::string& out) {
+  out.clear();
+  char c;
+  while (out.size() < 8192) {
+    if (!recvAll(fd, &c, 1)) return false;
+    out += c;
+    if (out.size() >= 4 && out.compare(out.size() - 4, 4, "\r\n\r\n") == 0) return true;
+  }
+  return false;
+}
+
+// Case-insensitive header lookup; empty if missing
+inline std::string httpHeader(const std::string& headers, const char* name) {
+  size_t nameLength = strlen(name);
+  size_t pos = headers.find("\r\n");
+  while (pos != std::string::npos && pos + 2 < headers.size()) {
+    size_t line = pos + 2;
+    size_t eol = headers.find("\r\n", line);
+    if (eol == std::string::npos) break;
+    if (eol - line > nameLength && headers[line + nameLength] == ':' &&
+        strncasecmp(headers.c_str() + line, name, nameLength) == 0) {
+      size_t v = line + nameLength + 1;
+      while (v < eol && headers[v] == ' ') v++;
+      return headers.substr(v, eol - v);
+    }
+    pos = eol;
+  }
+  return std::string();
+}
+
+#endif // SIGNALK_STUB_WEBSOCKET_H
@@ -0,0 +1,37 @@
+#!/bin/sh
+# Flash and RAM use of each source variant (WIND_ENABLE_* combinations).
+#
+#   tools/size-report.sh [fqbn]
+#
+# Needs arduino-cli with the esp32 core and the sketch libraries
+# installed. Builds go to a temporary directory; the sketch is not touched.
+
+set -e
+
+SKETCH_DIR=$(cd "$(dirname "$0")/.." && pwd)
+FQBN=${1:-esp32:esp32:esp32c6:PartitionScheme=huge_app,FlashMode=qio,FlashFreq=80}
+BUILD_ROOT=$(mktemp -d)
+trap 'rm -rf "$BUILD_ROOT"' EXIT
+
+# name|flags
+VARIANTS="all|
+demo only|-DWIND_ENABLE_SIGNALK=0 -DWIND_ENABLE_NMEA=0
+signalk only|-DWIND_ENABLE_DEMO=0 -DWIND_ENABLE_NMEA=0
+nmea only|-DWIND_ENABLE_DEMO=0 -DWIND_ENABLE_SIGNALK=0
+no nmea|-DWIND_ENABLE_NMEA=0
+all, source task|-DWIND_SOURCE_TASK=1"
+
+printf '%-20s %12s %12s %10s\n' "variant" "flash" "ram" "vs all"
+base=""
+echo "$VARIANTS" | while IFS='|' read -r name flags; do
+  out=$(arduino-cli compile --fqbn "$FQBN" --build-path "$BUILD_ROOT/$(echo "$name" | tr -c 'a-z' _)" \
+        --build-property "compiler.cpp.extra_flags=$flags" "$SKETCH_DIR" 2>&1) || {
+    printf '%-20s build failed\n' "$name"
+    echo "$out" | tail -5
+    continue
+  }
+  flash=$(echo "$out" | sed -n 's/^Sketch uses \([0-9]*\) bytes.*/\1/p')
+  ram=$(echo "$out" | sed -n 's/^Global variables use \([0-9]*\) bytes.*/\1/p')
+  [ -z "$base" ] && base=$flash
+  printf '%-20s %12s %12s %10s\n' "$name" "$flash" "$ram" "$((flash - base))"
+done
@@ -0,0 +1,34 @@
+/*
+  host_arduino.h - The few Arduino calls the replay path uses, for Linux
+
+  ReplayWindDataSource only needs millis() and Serial.print*; this
+  provides them on top of the C library so recordings can drive
+  desktop tests and tools.
+*/
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <time.h>
+
+inline unsigned long millis() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+struct HostSerial {
+  void println(const char* s) { fprintf(stderr, "%s\n", s); }
+  void printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+  }
+};
+
+static HostSerial Serial;
+
+#endif // HOST_ARDUINO_H